@@ -0,0 +1,116 @@
+//
+//  MGCEventsLayoutBenchmark.c
+//  CalendarBenchmarks
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+//  Times the layout core on synthetic days of 10 to 10,000 events.
+//  Usage: MGCEventsLayoutBenchmark [max number of events]
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "MGCEventsLayoutCore.h"
+
+
+static const double kHourSlotHeight = 65.;
+
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// events starting on quarter hours, lasting from 15 minutes to 3 hours
+static void SyntheticDay(MGCEventSpan *spans, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        double start = (rand() % (24 * 4)) * kHourSlotHeight / 4.;
+        double duration = (1 + rand() % 12) * kHourSlotHeight / 4.;
+        spans[i] = (MGCEventSpan){ start, start + duration, i };
+    }
+}
+
+// all-day events spanning from 1 to 7 days, in a range of 31 days
+static void SyntheticMonth(MGCDayRange *ranges, size_t count, size_t *eventCounts, size_t numberOfDays)
+{
+    for (size_t day = 0; day < numberOfDays; day++) {
+        eventCounts[day] = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t location = (i * numberOfDays) / count;
+        size_t length = 1 + rand() % 7;
+        if (location + length > numberOfDays) {
+            length = numberOfDays - location;
+        }
+        ranges[i] = (MGCDayRange){ location, length, i };
+        for (size_t day = location; day < location + length; day++) {
+            eventCounts[day]++;
+        }
+    }
+}
+
+static double BenchmarkTimedEvents(size_t count, MGCEventCovering covering, int iterations)
+{
+    MGCEventSpan *spans = malloc(count * sizeof(MGCEventSpan));
+    MGCEventCellLayout *cells = malloc(count * sizeof(MGCEventCellLayout));
+    SyntheticDay(spans, count);
+
+    MGCTimedEventsLayoutParams params = { 0., 140., 15., 2., covering };
+
+    double start = Now();
+    for (int i = 0; i < iterations; i++) {
+        MGCLayoutTimedEvents(spans, count, &params, cells);
+    }
+    double elapsed = (Now() - start) / iterations;
+
+    free(spans);
+    free(cells);
+    return elapsed;
+}
+
+static double BenchmarkAllDayEvents(size_t count, int iterations)
+{
+    const size_t numberOfDays = 31;
+    size_t eventCounts[31], hiddenCounts[31];
+    MGCDayRange *ranges = malloc(count * sizeof(MGCDayRange));
+    size_t *lines = malloc(count * sizeof(size_t));
+    SyntheticMonth(ranges, count, eventCounts, numberOfDays);
+
+    double start = Now();
+    for (int i = 0; i < iterations; i++) {
+        MGCLayoutAllDayEvents(ranges, count, eventCounts, numberOfDays, 5, lines, hiddenCounts);
+    }
+    double elapsed = (Now() - start) / iterations;
+
+    free(ranges);
+    free(lines);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t maxCount = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+
+    srand(42);
+
+    printf("%8s %16s %16s %16s\n", "events", "classic (us)", "complex (us)", "all-day (us)");
+
+    for (size_t count = 10; count <= maxCount; count *= 10) {
+        int iterations = count <= 100 ? 2000 : (count <= 1000 ? 100 : 5);
+
+        double classicTime = BenchmarkTimedEvents(count, MGCEventCoveringClassic, iterations);
+        double complexTime = BenchmarkTimedEvents(count, MGCEventCoveringComplex, iterations);
+        double allDayTime = BenchmarkAllDayEvents(count, iterations);
+
+        printf("%8zu %16.1f %16.1f %16.1f\n", count, classicTime * 1e6, complexTime * 1e6, allDayTime * 1e6);
+    }
+
+    return EXIT_SUCCESS;
+}
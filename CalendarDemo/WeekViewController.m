@@ -124,7 +124,7 @@
     return [self.calendar isDateInWeekend:date] ? 1 : 2;
 }
 
-- (MGCDateRange*)dayPlannerView:(MGCDayPlannerView *)view dimmedTimeRangeAtIndex:(NSUInteger)index date:(NSDate *)date
+- (MGCTimeSpan)dayPlannerView:(MGCDayPlannerView *)view dimmedTimeSpanAtIndex:(NSUInteger)index date:(NSDate *)date
 {
     NSDate *start, *end;
     
@@ -141,7 +141,7 @@
     else {
         end = [self.calendar dateBySettingHour:8 minute:59 second:0 ofDate:date options:0];
     }
-    return [MGCDateRange dateRangeWithStart:start end:end];
+    return MGCTimeSpanMake(start.timeIntervalSinceReferenceDate, end.timeIntervalSinceReferenceDate);
 }
 
 
@@ -31,12 +31,13 @@
 
 #import <Foundation/Foundation.h>
 #import "MGCAlignedGeometry.h"
+#import "MGCEventsLayoutCore.h"
 
 
 CGRect MGCAlignedRect(CGRect rect)
 {
-    CGFloat scale = [UIScreen mainScreen].scale;
-    return CGRectMake(floorf(rect.origin.x * scale) / scale, floorf(rect.origin.y * scale) / scale, ceilf(rect.size.width * scale) / scale, ceilf(rect.size.height * scale) / scale);
+    MGCLayoutRect aligned = MGCLayoutAlignedRect(MGCLayoutRectMake(rect.origin.x, rect.origin.y, rect.size.width, rect.size.height), [UIScreen mainScreen].scale);
+    return CGRectMake(aligned.x, aligned.y, aligned.width, aligned.height);
 }
 
 CGRect MGCAlignedRectMake(CGFloat x, CGFloat y, CGFloat width, CGFloat height)
@@ -47,7 +48,7 @@ CGRect MGCAlignedRectMake(CGFloat x, CGFloat y, CGFloat width, CGFloat height)
 CGSize MGCAlignedSize(CGSize size)
 {
     CGFloat scale = [UIScreen mainScreen].scale;
-    return CGSizeMake(ceilf(size.width * scale) / scale, ceilf(size.height * scale) / scale);
+    return CGSizeMake(MGCLayoutCeilToPixel(size.width, scale), MGCLayoutCeilToPixel(size.height, scale));
 }
 
 CGSize MGCAlignedSizeMake(CGFloat width, CGFloat height)
@@ -58,7 +59,7 @@ CGSize MGCAlignedSizeMake(CGFloat width, CGFloat height)
 CGPoint MGCAlignedPoint(CGPoint point)
 {
     CGFloat scale = [UIScreen mainScreen].scale;
-    return CGPointMake(floorf(point.x * scale) / scale, floorf(point.y * scale) / scale);
+    return CGPointMake(MGCLayoutFloorToPixel(point.x, scale), MGCLayoutFloorToPixel(point.y, scale));
 }
 
 CGPoint MGCAlignedPointMake(CGFloat x, CGFloat y)
@@ -68,7 +69,5 @@ CGPoint MGCAlignedPointMake(CGFloat x, CGFloat y)
 
 CGFloat MGCAlignedFloat(CGFloat f)
 {
-    CGFloat scale = [UIScreen mainScreen].scale;
-    return roundf(f * scale) / scale;
+    return MGCLayoutRoundToPixel(f, [UIScreen mainScreen].scale);
 }
-
@@ -66,4 +66,8 @@ typedef enum : NSUInteger
 
 - (AllDayEventInset)collectionView:(UICollectionView*)view layout:(MGCAllDayEventsViewLayout*)layout insetsForEventAtIndexPath:(NSIndexPath*)indexPath;
 
+// bulk version of collectionView:layout:dayRangeForEventAtIndexPath:, called once per section instead if implemented.
+// ranges has room for all the items in the section, and should be filled in item order.
+- (void)collectionView:(UICollectionView*)view layout:(MGCAllDayEventsViewLayout*)layout getDayRanges:(NSRange*)ranges forEventsInSection:(NSUInteger)section;
+
 @end
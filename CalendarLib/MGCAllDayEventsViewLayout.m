@@ -30,6 +30,7 @@
 
 #import "MGCAllDayEventsViewLayout.h"
 #import "MGCAlignedGeometry.h"
+#import "MGCEventsLayoutCore.h"
 
 
 static const CGFloat kCellSpacing = 2.;		// space around cells
@@ -39,9 +40,11 @@ static const CGFloat kCellInset = 4.;
 @interface MGCAllDayEventsViewLayout ()
 
 @property (nonatomic) NSUInteger maxEventsInSections;
-@property (nonatomic) NSMutableDictionary *eventsCount;	// cache of events count per day [ { day : count }, ... ]
 @property (nonatomic) NSMutableDictionary *hiddenCount; // cache of hidden events count per day
 @property (nonatomic) NSMutableDictionary *layoutInfos;
+@property (nonatomic) NSArray *columnAttributes;		// attributes of cells and more events views, bucketed by the day they start at (relative to layoutDays)
+@property (nonatomic) NSRange layoutDays;				// days laid out in prepareLayout
+@property (nonatomic) NSUInteger maxColumnSpan;			// maximum number of days covered by a cell
 
 @property (nonatomic) NSRange visibleSections;
 
@@ -68,78 +71,64 @@ static const CGFloat kCellInset = 4.;
 	return (self.maxContentHeight + kCellSpacing + 1) / (self.eventCellHeight + kCellSpacing);
 }
 
-// returns the number of event lines displayed for this day range
-- (NSUInteger)maxVisibleLinesForDaysInRange:(NSRange)range
-{
-	NSUInteger count = 0;
-	for (NSUInteger day = range.location; day < NSMaxRange(range); day++) {
-		count = MAX(count, [self numberOfEventsForDayAtIndex:day]);
-	}
-	// if count > max, we have to keep one row to show "x more events"
-	return count > self.maxVisibleLines ? self.maxVisibleLines - 1 : count;
-}
-
-- (NSInteger)numberOfEventsForDayAtIndex:(NSInteger)day
-{
-    NSNumber *count = [self.eventsCount objectForKey:@(day)];
-	
-	if (!count) {
-		count = @([self.collectionView numberOfItemsInSection:day]);
-		if (!self.eventsCount) {
-			self.eventsCount = [NSMutableDictionary dictionaryWithCapacity:self.collectionView.numberOfSections];
-		}
-		
-		[self.eventsCount setObject:count forKey:@(day)];
-	}
-	return [count integerValue];
-}
-
-- (void)addHiddenEventForDayAtIndex:(NSInteger)day
-{
-	if (!self.hiddenCount) {
-		self.hiddenCount = [NSMutableDictionary dictionaryWithCapacity:self.collectionView.numberOfSections];
-	}
-	
-	NSInteger count = [[self.hiddenCount objectForKey:@(day)]integerValue];
-	[self.hiddenCount setObject:@(++count) forKey:@(day)];
-}
-
 - (NSUInteger)numberOfHiddenEventsInSection:(NSInteger)section
 {
 	return [[self.hiddenCount objectForKey:@(section)]unsignedIntegerValue];
 }
 
-// returns a dictionary of (indexpath : range) for all visible events
-- (NSDictionary*)eventRanges
+// returns the index paths of all events visible in given day range, and fills ranges with their day ranges
+// relative to the first day, in the same order
+- (NSArray*)eventsInDayRange:(NSRange)days ranges:(NSMutableData*)ranges eventCounts:(size_t*)eventCounts
 {
-    NSMutableDictionary *eventRanges = [NSMutableDictionary new];
-	
-	NSRange visibleSections = [self visibleDayRangeForBounds:self.collectionView.bounds];
+    NSMutableArray *indexPaths = [NSMutableArray new];
 	
+    BOOL bulkRanges = [self.delegate respondsToSelector:@selector(collectionView:layout:getDayRanges:forEventsInSection:)];
+    NSMutableData *dayRanges = [NSMutableData data];
+    
     BOOL previousDaysWithEvents = NO;
-    for (NSInteger day = visibleSections.location; day < NSMaxRange(visibleSections); day++)
+    for (NSInteger day = days.location; day < NSMaxRange(days); day++)
     {
-        NSInteger eventsCount = [self numberOfEventsForDayAtIndex:day];
+        NSInteger eventsCount = [self.collectionView numberOfItemsInSection:day];
+        eventCounts[day - days.location] = eventsCount;
+        
+        if (bulkRanges && eventsCount > 0) {
+            dayRanges.length = eventsCount * sizeof(NSRange);
+            [self.delegate collectionView:self.collectionView layout:self getDayRanges:dayRanges.mutableBytes forEventsInSection:day];
+        }
+        
         for (NSInteger item = 0; item < eventsCount; item++)
         {
             NSIndexPath *path = [NSIndexPath indexPathForItem:item inSection:day];
-            NSRange eventRange = [self.delegate collectionView:self.collectionView layout:self dayRangeForEventAtIndexPath:path];
+            NSRange eventRange;
+            if (bulkRanges) {
+                eventRange = ((const NSRange*)dayRanges.bytes)[item];
+            }
+            else {
+                eventRange = [self.delegate collectionView:self.collectionView layout:self dayRangeForEventAtIndexPath:path];
+            }
             
             // keep only those events starting at current column,
             // or those started earlier if this is the first day of the row range
-            if (eventRange.location == day || day == visibleSections.location ||
+            if (eventRange.location == day || day == days.location ||
                 // this last case means than the event started earlier but previous days may not have loaded yet, thus returning 0 event.
                 // we keep it to avoid nasty flickering when scrolling backwards
                 !previousDaysWithEvents)
             {
-                eventRange = NSIntersectionRange(eventRange, visibleSections);
-                [eventRanges setObject:[NSValue valueWithRange:eventRange] forKey:path];
+                eventRange = NSIntersectionRange(eventRange, days);
+                
+                MGCDayRange range;
+                range.location = eventRange.length > 0 ? eventRange.location - days.location : 0;
+                range.length = eventRange.length;
+                range.index = indexPaths.count;
+                [ranges appendBytes:&range length:sizeof(MGCDayRange)];
+                
+                [indexPaths addObject:path];
             }
         }
         if (eventsCount > 0) previousDaysWithEvents = YES;
     }
         
-	return eventRanges;
+	return indexPaths;
 }
 
 - (CGRect)rectForCellWithRange:(NSRange)range line:(NSUInteger)line insets:(AllDayEventInset)insets
@@ -166,78 +155,79 @@ static const CGFloat kCellInset = 4.;
 {
 	//NSLog(@"AllDayEvents prepareLayout");
     
-	self.maxEventsInSections = 0;
-	self.eventsCount = nil;
-	self.hiddenCount = nil;
+	self.hiddenCount = [NSMutableDictionary dictionary];
 	self.layoutInfos = [NSMutableDictionary dictionary];
     
 	NSMutableDictionary *cellInfos = [NSMutableDictionary dictionary];
 	NSMutableDictionary *moreInfos = [NSMutableDictionary dictionary];
 
-	NSDictionary *eventRanges = [self eventRanges];
-	NSMutableArray *lines = [NSMutableArray new];
+	NSRange visibleDays = [self visibleDayRangeForBounds:self.collectionView.bounds];
 	
-	for (NSIndexPath *indexPath in [[eventRanges allKeys]sortedArrayUsingSelector:@selector(compare:)])
+	NSMutableArray *columns = [NSMutableArray arrayWithCapacity:visibleDays.length];
+	for (NSUInteger i = 0; i < visibleDays.length; i++) {
+		[columns addObject:[NSMutableArray array]];
+	}
+	NSUInteger maxColumnSpan = 1;
+	
+	size_t *eventCounts = malloc(visibleDays.length * sizeof(size_t));
+	size_t *hiddenCounts = malloc(visibleDays.length * sizeof(size_t));
+	NSMutableData *ranges = [NSMutableData data];
+	
+	NSArray *indexPaths = [self eventsInDayRange:visibleDays ranges:ranges eventCounts:eventCounts];
+	size_t *lines = malloc(indexPaths.count * sizeof(size_t));
+	
+	self.maxEventsInSections = MGCLayoutAllDayEvents(ranges.bytes, indexPaths.count, eventCounts, visibleDays.length, self.maxVisibleLines, lines, hiddenCounts);
+	
+	const MGCDayRange *eventRanges = ranges.bytes;
+	for (NSUInteger i = 0; i < indexPaths.count; i++)
 	{
-		NSRange eventRange = [[eventRanges objectForKey:indexPath]rangeValue];
+		if (lines[i] == MGCLayoutHiddenLine) continue;
 		
-		NSUInteger numLine = 0;	// index of the line where to insert the event
+		NSIndexPath *indexPath = [indexPaths objectAtIndex:i];
+		UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
 		
-		for (NSMutableIndexSet *indexes in lines) {
-			if (![indexes intersectsIndexesInRange:eventRange]) {
-				// we found the right line
-				[indexes addIndexesInRange:eventRange];
-				break;
-			}
-			numLine++;
-		}
-
-		if (numLine == lines.count)  {
-			// this means no line was yet created, or the event does not fit any
-			[lines addObject:[NSMutableIndexSet indexSetWithIndexesInRange:eventRange]];
+		AllDayEventInset insets = AllDayEventInsetNone;
+		if ([self.delegate respondsToSelector:@selector(collectionView:layout:insetsForEventAtIndexPath:)]) {
+			insets = [self.delegate collectionView:self.collectionView layout:self insetsForEventAtIndexPath:indexPath];
 		}
 		
-		NSUInteger maxVisibleEvents = [self maxVisibleLinesForDaysInRange:eventRange];
-		if (numLine < maxVisibleEvents) {
-			
-			UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
-			
-			AllDayEventInset insets = AllDayEventInsetNone;
-			if ([self.delegate respondsToSelector:@selector(collectionView:layout:insetsForEventAtIndexPath:)]) {
-				insets = [self.delegate collectionView:self.collectionView layout:self insetsForEventAtIndexPath:indexPath];
-			}
-			
-			CGRect frame = [self rectForCellWithRange:eventRange line:numLine insets:insets];
-			attribs.frame = frame;
-			
-			[cellInfos setObject:attribs forKey:indexPath];
-			
-			self.maxEventsInSections = MAX(self.maxEventsInSections, numLine+1);
-		}
-		else {
-			for (NSUInteger day = eventRange.location; day < NSMaxRange(eventRange); day++) {
-				[self addHiddenEventForDayAtIndex:day];
-				self.maxEventsInSections = maxVisibleEvents + 1;
-			}
+		NSRange eventRange = NSMakeRange(visibleDays.location + eventRanges[i].location, eventRanges[i].length);
+		attribs.frame = [self rectForCellWithRange:eventRange line:lines[i] insets:insets];
+		
+		[cellInfos setObject:attribs forKey:indexPath];
+		
+		if (eventRanges[i].location < visibleDays.length) {
+			[[columns objectAtIndex:eventRanges[i].location] addObject:attribs];
+			maxColumnSpan = MAX(maxColumnSpan, eventRanges[i].length);
 		}
 	}
 	
-	NSInteger numSections = self.collectionView.numberOfSections;
-	for (int day = 0; day < numSections; day++)
+	for (NSUInteger i = 0; i < visibleDays.length; i++)
 	{
-		NSUInteger hiddenCount = [self numberOfHiddenEventsInSection:day];
-		if (hiddenCount) {
+		NSUInteger day = visibleDays.location + i;
+		if (hiddenCounts[i]) {
+			[self.hiddenCount setObject:@(hiddenCounts[i]) forKey:@(day)];
+			
 			NSIndexPath *path = [NSIndexPath indexPathForItem:0 inSection:day];
 			UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:MoreEventsViewKind withIndexPath:path];
 			CGRect frame = [self rectForCellWithRange:NSMakeRange(day, 1) line:self.maxVisibleLines - 1 insets:AllDayEventInsetNone];
 			attribs.frame = frame;
 
 			[moreInfos setObject:attribs forKey:path];
+			[[columns objectAtIndex:i] addObject:attribs];
 		}
 	}
 	
+	free(eventCounts);
+	free(hiddenCounts);
+	free(lines);
+	
 	[self.layoutInfos setObject:cellInfos forKey:@"cellInfos"];
 	[self.layoutInfos setObject:moreInfos forKey:@"moreInfos"];
+	
+	self.columnAttributes = columns;
+	self.layoutDays = visibleDays;
+	self.maxColumnSpan = maxColumnSpan;
 }
 
 - (CGSize)collectionViewContentSize
@@ -251,12 +241,18 @@ static const CGFloat kCellInset = 4.;
 {
 	NSMutableArray *allAttribs = [NSMutableArray array];
 	
-	for (NSString *key in self.layoutInfos)
+	// columns where cells intersecting rect can start: those under rect,
+	// and on the left as many as a cell can span, for events started earlier
+	NSInteger first = 0, last = (NSInteger)self.columnAttributes.count - 1;
+	if (self.dayColumnWidth > 0) {
+		first = MAX(first, (NSInteger)floor(CGRectGetMinX(rect) / self.dayColumnWidth) - (NSInteger)self.layoutDays.location - (NSInteger)self.maxColumnSpan);
+		last = MIN(last, (NSInteger)floor(CGRectGetMaxX(rect) / self.dayColumnWidth) - (NSInteger)self.layoutDays.location);
+	}
+	
+	for (NSInteger col = first; col <= last; col++)
 	{
-		NSDictionary *attributesDict = [self.layoutInfos objectForKey:key];
-		for (NSIndexPath *indexPath in attributesDict)
+		for (UICollectionViewLayoutAttributes *attributes in [self.columnAttributes objectAtIndex:col])
 		{
-			UICollectionViewLayoutAttributes *attributes = [attributesDict objectForKey:indexPath];
 			if (CGRectIntersectsRect(rect, attributes.frame) && !attributes.hidden) {
 				[allAttribs addObject:attributes];
 			}
@@ -31,13 +31,65 @@
 #import <Foundation/Foundation.h>
 
 
+// Value type for a range of absolute times (seconds since the reference date), to be used instead
+// of MGCDateRange where creating objects would be too expensive, e.g. when laying out events.
+typedef struct {
+	CFAbsoluteTime start;	// start of the span
+	CFAbsoluteTime end;		// end of the span (excluding)
+} MGCTimeSpan;
+
+NS_INLINE MGCTimeSpan MGCTimeSpanMake(CFAbsoluteTime start, CFAbsoluteTime end)
+{
+	MGCTimeSpan span = { start, end };
+	return span;
+}
+
+// span is empty if end is not later than start
+NS_INLINE BOOL MGCTimeSpanIsEmpty(MGCTimeSpan span)
+{
+	return span.end <= span.start;
+}
+
+NS_INLINE BOOL MGCTimeSpanEqualToTimeSpan(MGCTimeSpan span1, MGCTimeSpan span2)
+{
+	return span1.start == span2.start && span1.end == span2.end;
+}
+
+NS_INLINE BOOL MGCTimeSpanContainsTime(MGCTimeSpan span, CFAbsoluteTime time)
+{
+	return time >= span.start && time < span.end;
+}
+
+NS_INLINE BOOL MGCTimeSpanIntersectsTimeSpan(MGCTimeSpan span1, MGCTimeSpan span2)
+{
+	return span2.end > span1.start && span1.end > span2.start;
+}
+
+// same as -[MGCDateRange intersectDateRange:] : returns an empty span at span1.start if spans do not intersect
+NS_INLINE MGCTimeSpan MGCTimeSpanIntersection(MGCTimeSpan span1, MGCTimeSpan span2)
+{
+	if (!MGCTimeSpanIntersectsTimeSpan(span1, span2)) {
+		return MGCTimeSpanMake(span1.start, span1.start);
+	}
+	return MGCTimeSpanMake(fmax(span1.start, span2.start), fmin(span1.end, span2.end));
+}
+
+NS_INLINE MGCTimeSpan MGCTimeSpanUnion(MGCTimeSpan span1, MGCTimeSpan span2)
+{
+	return MGCTimeSpanMake(fmin(span1.start, span2.start), fmax(span1.end, span2.end));
+}
+
+
 @interface MGCDateRange : NSObject<NSCopying>
 
 @property (nonatomic, copy) NSDate *start;      // start of the range
 @property (nonatomic, copy) NSDate *end;        // end of the range (excluding)
 @property (nonatomic, readonly) BOOL isEmpty;   // range is empty is start is equal to end
 
+@property (nonatomic, readonly) MGCTimeSpan timeSpan;	// same range as a value
+
 + (instancetype)dateRangeWithStart:(NSDate*)start end:(NSDate*)end;
++ (instancetype)dateRangeWithTimeSpan:(MGCTimeSpan)span;
 - (instancetype)initWithStart:(NSDate*)start end:(NSDate*)end;
 
 - (BOOL)isEqualToDateRange:(MGCDateRange*)range;
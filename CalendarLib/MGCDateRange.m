@@ -56,6 +56,11 @@ static NSDateFormatter *dateFormatter;
 	return [[self alloc] initWithStart:start end:end];
 }
 
++ (instancetype)dateRangeWithTimeSpan:(MGCTimeSpan)span
+{
+	return [[self alloc] initWithStart:[NSDate dateWithTimeIntervalSinceReferenceDate:span.start] end:[NSDate dateWithTimeIntervalSinceReferenceDate:span.end]];
+}
+
 - (instancetype)initWithStart:(NSDate*)start end:(NSDate*)end
 {
 	if (self = [super init]) {
@@ -79,6 +84,11 @@ static NSDateFormatter *dateFormatter;
 	return dateFormatter;
 }
 
+- (MGCTimeSpan)timeSpan
+{
+	return MGCTimeSpanMake(self.start.timeIntervalSinceReferenceDate, self.end.timeIntervalSinceReferenceDate);
+}
+
 - (NSDateComponents*)components:(NSCalendarUnit)unitFlags forCalendar:(NSCalendar*)calendar
 {
 	[self checkIfValid];
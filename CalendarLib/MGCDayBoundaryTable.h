@@ -0,0 +1,74 @@
+//
+//  MGCDayBoundaryTable.h
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+
+// Table of the day boundaries for a range of consecutive days, built once with a calendar.
+// It answers the day and time-of-day questions the day planner view asks for every event cell,
+// dimming view and column on each layout pass, with a lookup instead of calendar calculations.
+// Days with a daylight saving time transition are handled like the calendar would.
+// Dates outside of the table are handed to the calendar, so results never depend on the range it covers.
+@interface MGCDayBoundaryTable : NSObject
+
+@property (nonatomic, readonly) NSCalendar *calendar;		// calendar used to build the table
+@property (nonatomic, readonly) NSDate *startDate;			// start of the first day in the table
+@property (nonatomic, readonly) NSUInteger numberOfDays;	// number of days in the table
+
++ (instancetype)tableWithCalendar:(NSCalendar*)calendar startDate:(NSDate*)startDate numberOfDays:(NSUInteger)numberOfDays;
+- (instancetype)initWithCalendar:(NSCalendar*)calendar startDate:(NSDate*)startDate numberOfDays:(NSUInteger)numberOfDays;
+
+// start of the day at given offset from startDate
+// (same as adding dayOffset days to startDate with the calendar)
+- (NSDate*)dateForDayOffset:(NSInteger)dayOffset;
+
+// number of days between startDate and date
+// (same as the day component of the difference between the two dates)
+- (NSInteger)dayOffsetForDate:(NSDate*)date;
+
+// start of the day containing date
+// (same as mgc_startOfDayForDate: from NSCalendar+MGCAdditions)
+- (NSDate*)startOfDayForDate:(NSDate*)date;
+
+// wall clock time of date, in seconds since midnight
+// (same as the hour, minute and second components of the date)
+- (NSTimeInterval)timeOfDayForDate:(NSDate*)date;
+
+// date for given wall clock time on the day containing date
+// (same as setting the hour, minute and second of date with the calendar)
+- (NSDate*)dateBySettingTimeOfDay:(NSTimeInterval)time ofDate:(NSDate*)date;
+
+// same as above, with absolute times instead of dates, to avoid creating NSDate objects in layout loops
+- (CFAbsoluteTime)absoluteTimeForDayOffset:(NSInteger)dayOffset;
+- (NSInteger)dayOffsetForAbsoluteTime:(CFAbsoluteTime)time;
+- (NSTimeInterval)timeOfDayForAbsoluteTime:(CFAbsoluteTime)time;
+- (CFAbsoluteTime)absoluteTimeBySettingTimeOfDay:(NSTimeInterval)timeOfDay ofAbsoluteTime:(CFAbsoluteTime)time;
+
+@end
@@ -0,0 +1,240 @@
+//
+//  MGCDayBoundaryTable.m
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import "MGCDayBoundaryTable.h"
+#import "NSCalendar+MGCAdditions.h"
+
+
+static const NSTimeInterval kSecondsPerDay = 24 * 3600;
+
+
+typedef struct {
+	CFAbsoluteTime start;			// start of the day
+	NSTimeInterval offset;			// seconds from GMT at start of the day
+	CFAbsoluteTime transition;		// daylight saving time transition during the day, or start of next day if none
+	NSTimeInterval nextOffset;		// seconds from GMT after transition
+} MGCDayBoundary;
+
+
+@interface MGCDayBoundaryTable ()
+
+@property (nonatomic) NSData *data;		// numberOfDays + 1 boundaries, the last one being the end of the table
+
+@end
+
+
+@implementation MGCDayBoundaryTable
+
++ (instancetype)tableWithCalendar:(NSCalendar*)calendar startDate:(NSDate*)startDate numberOfDays:(NSUInteger)numberOfDays
+{
+	return [[self alloc] initWithCalendar:calendar startDate:startDate numberOfDays:numberOfDays];
+}
+
+- (instancetype)initWithCalendar:(NSCalendar*)calendar startDate:(NSDate*)startDate numberOfDays:(NSUInteger)numberOfDays
+{
+	NSParameterAssert(calendar && startDate);
+	
+	if (self = [super init]) {
+		_calendar = calendar;
+		_startDate = [startDate copy];
+		_numberOfDays = numberOfDays;
+		
+		NSTimeZone *timeZone = calendar.timeZone;
+		NSMutableData *data = [NSMutableData dataWithLength:(numberOfDays + 1) * sizeof(MGCDayBoundary)];
+		MGCDayBoundary *days = data.mutableBytes;
+		
+		NSDateComponents *comps = [NSDateComponents new];
+		for (NSUInteger i = 0; i <= numberOfDays; i++) {
+			comps.day = i;
+			NSDate *date = [calendar dateByAddingComponents:comps toDate:startDate options:0];
+			days[i].start = date.timeIntervalSinceReferenceDate;
+			days[i].offset = [timeZone secondsFromGMTForDate:date];
+		}
+		
+		// there's at most one transition per day in every time zone we know of
+		NSDate *transition = [timeZone nextDaylightSavingTimeTransitionAfterDate:startDate];
+		for (NSUInteger i = 0; i < numberOfDays; i++) {
+			days[i].transition = days[i + 1].start;
+			days[i].nextOffset = days[i].offset;
+			
+			while (transition && transition.timeIntervalSinceReferenceDate < days[i].start) {
+				transition = [timeZone nextDaylightSavingTimeTransitionAfterDate:transition];
+			}
+			if (transition && transition.timeIntervalSinceReferenceDate < days[i + 1].start) {
+				days[i].transition = transition.timeIntervalSinceReferenceDate;
+				days[i].nextOffset = [timeZone secondsFromGMTForDate:transition];
+			}
+		}
+		days[numberOfDays].transition = days[numberOfDays].start;
+		days[numberOfDays].nextOffset = days[numberOfDays].offset;
+		
+		_data = data;
+	}
+	return self;
+}
+
+// index of the day containing given time, or NSNotFound if it's outside of the table
+- (NSUInteger)indexOfDayForTime:(CFAbsoluteTime)time
+{
+	const MGCDayBoundary *days = self.data.bytes;
+	
+	if (time < days[0].start || time >= days[self.numberOfDays].start) {
+		return NSNotFound;
+	}
+	
+	// binary search for the last day starting at or before time
+	NSUInteger lo = 0, hi = self.numberOfDays;
+	while (hi - lo > 1) {
+		NSUInteger mid = (lo + hi) / 2;
+		if (days[mid].start <= time) {
+			lo = mid;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+- (CFAbsoluteTime)absoluteTimeForDayOffset:(NSInteger)dayOffset
+{
+	if (dayOffset >= 0 && (NSUInteger)dayOffset <= self.numberOfDays) {
+		const MGCDayBoundary *days = self.data.bytes;
+		return days[dayOffset].start;
+	}
+	
+	NSDateComponents *comps = [NSDateComponents new];
+	comps.day = dayOffset;
+	return [self.calendar dateByAddingComponents:comps toDate:self.startDate options:0].timeIntervalSinceReferenceDate;
+}
+
+- (NSDate*)dateForDayOffset:(NSInteger)dayOffset
+{
+	return [NSDate dateWithTimeIntervalSinceReferenceDate:[self absoluteTimeForDayOffset:dayOffset]];
+}
+
+- (NSInteger)dayOffsetForAbsoluteTime:(CFAbsoluteTime)time
+{
+	if (time == ((const MGCDayBoundary*)self.data.bytes)[self.numberOfDays].start) {
+		return self.numberOfDays;
+	}
+	
+	NSUInteger index = [self indexOfDayForTime:time];
+	if (index != NSNotFound) {
+		return index;
+	}
+	
+	NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:time];
+	NSDateComponents *comps = [self.calendar components:NSCalendarUnitDay fromDate:self.startDate toDate:date options:0];
+	return comps.day;
+}
+
+- (NSInteger)dayOffsetForDate:(NSDate*)date
+{
+	NSAssert(date, @"dayOffsetForDate: was passed nil date");
+	
+	return [self dayOffsetForAbsoluteTime:date.timeIntervalSinceReferenceDate];
+}
+
+- (NSDate*)startOfDayForDate:(NSDate*)date
+{
+	NSUInteger index = [self indexOfDayForTime:date.timeIntervalSinceReferenceDate];
+	if (index != NSNotFound) {
+		const MGCDayBoundary *days = self.data.bytes;
+		return [NSDate dateWithTimeIntervalSinceReferenceDate:days[index].start];
+	}
+	return [self.calendar mgc_startOfDayForDate:date];
+}
+
+- (NSTimeInterval)timeOfDayForAbsoluteTime:(CFAbsoluteTime)time
+{
+	NSTimeInterval offset;
+	
+	NSUInteger index = [self indexOfDayForTime:time];
+	if (index != NSNotFound) {
+		const MGCDayBoundary *day = (const MGCDayBoundary*)self.data.bytes + index;
+		offset = time < day->transition ? day->offset : day->nextOffset;
+	}
+	else {
+		offset = [self.calendar.timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:time]];
+	}
+	
+	// the reference date is a midnight in GMT, so local midnights are multiples of a day in local time
+	NSTimeInterval timeOfDay = fmod(time + offset, kSecondsPerDay);
+	return timeOfDay < 0 ? timeOfDay + kSecondsPerDay : timeOfDay;
+}
+
+- (NSTimeInterval)timeOfDayForDate:(NSDate*)date
+{
+	return [self timeOfDayForAbsoluteTime:date.timeIntervalSinceReferenceDate];
+}
+
+- (CFAbsoluteTime)absoluteTimeBySettingTimeOfDay:(NSTimeInterval)timeOfDay ofAbsoluteTime:(CFAbsoluteTime)time
+{
+	NSUInteger index = [self indexOfDayForTime:time];
+	if (index == NSNotFound) {
+		NSInteger hour = timeOfDay / 3600, minute = fmod(timeOfDay, 3600) / 60, second = fmod(timeOfDay, 60);
+		NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:time];
+		return [self.calendar dateBySettingHour:hour minute:minute second:second ofDate:date options:0].timeIntervalSinceReferenceDate;
+	}
+	
+	const MGCDayBoundary *day = (const MGCDayBoundary*)self.data.bytes + index;
+	
+	// local time of the midnight starting the day (which might not exist, e.g. when clocks are set forward at midnight)
+	CFAbsoluteTime localStart = day->start + day->offset;
+	CFAbsoluteTime localMidnight = localStart - fmod(localStart, kSecondsPerDay);
+	if (localMidnight > localStart) {
+		localMidnight -= kSecondsPerDay;
+	}
+	
+	CFAbsoluteTime localTime = localMidnight + timeOfDay;
+	CFAbsoluteTime result = localTime - day->offset;
+	
+	// times repeated when clocks are set back resolve to their first occurrence,
+	// and times skipped when clocks are set forward are moved forward by the length of the gap
+	if (result >= day->transition && localTime - day->nextOffset >= day->transition) {
+		result = localTime - day->nextOffset;
+	}
+	return result;
+}
+
+- (NSDate*)dateBySettingTimeOfDay:(NSTimeInterval)time ofDate:(NSDate*)date
+{
+	return [NSDate dateWithTimeIntervalSinceReferenceDate:[self absoluteTimeBySettingTimeOfDay:time ofAbsoluteTime:date.timeIntervalSinceReferenceDate]];
+}
+
+#pragma mark - NSObject
+
+- (NSString*)description
+{
+	return [NSString stringWithFormat:@"<%@: %p> %lu days from %@", NSStringFromClass(self.class), self, (unsigned long)self.numberOfDays, self.startDate];
+}
+
+@end
@@ -31,6 +31,7 @@
 #import <EventKit/EventKit.h>
 #import <EventKitUI/EventKitUI.h>
 #import "MGCDayPlannerViewController.h"
+#import "MGCEventSource.h"
 
 
 @protocol MGCDayPlannerEKViewControllerDelegate;
@@ -41,6 +42,7 @@
 @property (nonatomic) NSCalendar *calendar;
 @property (nonatomic) NSSet *visibleCalendars;
 @property (nonatomic, readonly) EKEventStore *eventStore;
+@property (nonatomic) id<MGCEventSource> eventSource;		// where events are fetched from - defaults to an MGCEventKitSupport object wrapping eventStore
 @property (nonatomic, weak) id<MGCDayPlannerEKViewControllerDelegate> delegate;
 
 /** designated initializer */
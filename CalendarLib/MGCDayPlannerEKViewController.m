@@ -34,27 +34,94 @@
 #import "MGCStandardEventView.h"
 #import "NSCalendar+MGCAdditions.h"
 #import "MGCDateRange.h"
+#import "MGCEventDescriptorArray.h"
 #import "OSCache.h"
 #import "MGCEventKitSupport.h"
 
 
-typedef enum {
-    TimedEventType = 1,
-    AllDayEventType = 2,
-    AnyEventType = TimedEventType|AllDayEventType
-} EventType;
-
-
 static const NSUInteger cacheSize = 400;	// size of the cache (in days)
 static NSString* const EventCellReuseIdentifier = @"EventCellReuseIdentifier";
 
 
+// Immutable snapshot of the events of one day, filtered by calendars and split by type
+@interface MGCDayEventsSnapshot : NSObject
+
+@property (nonatomic, readonly) NSArray *events;						// all events of the day, as returned by the event store
+@property (nonatomic, readonly) NSSet *calendars;						// calendars of the events kept in the snapshot
+@property (nonatomic, readonly) NSArray *allDayEvents;
+@property (nonatomic, readonly) NSArray *timedEvents;
+@property (nonatomic, readonly) MGCEventDescriptorArray *descriptors;	// all-day events, then timed events
+
+- (instancetype)initWithEvents:(NSArray*)events calendars:(NSSet*)calendars calendar:(NSCalendar*)calendar;
+- (NSArray*)eventsOfType:(MGCEventType)type;
+
+@end
+
+
+// identifier of an event occurrence, which does not change when the event is fetched again:
+// occurrences of a recurring event share the event identifier, but not their original start date
+static NSUInteger MGCEventDescriptorIdentifier(EKEvent *ev)
+{
+    NSDate *occurrence = ev.occurrenceDate ?: ev.startDate;
+    uint64_t seconds = (uint64_t)llround(occurrence.timeIntervalSinceReferenceDate);
+    return ev.eventIdentifier.hash * 31 + (NSUInteger)(seconds ^ (seconds >> 32));
+}
+
+
+@implementation MGCDayEventsSnapshot
+
+- (instancetype)initWithEvents:(NSArray*)events calendars:(NSSet*)calendars calendar:(NSCalendar*)calendar
+{
+    if (self = [super init]) {
+        _events = [events copy];
+        _calendars = [calendars copy];
+        
+        NSMutableArray *allDayEvents = [NSMutableArray array];
+        NSMutableArray *timedEvents = [NSMutableArray array];
+        for (EKEvent *ev in events) {
+            if ([calendars containsObject:ev.calendar]) {
+                [(ev.isAllDay ? allDayEvents : timedEvents) addObject:ev];
+            }
+        }
+        _allDayEvents = [allDayEvents copy];
+        _timedEvents = [timedEvents copy];
+        
+        NSMutableData *data = [NSMutableData dataWithLength:(allDayEvents.count + timedEvents.count) * sizeof(MGCEventDescriptor)];
+        MGCEventDescriptor *descriptors = data.mutableBytes;
+        
+        NSUInteger i = 0;
+        for (EKEvent *ev in [allDayEvents arrayByAddingObjectsFromArray:timedEvents]) {
+            MGCEventType type = ev.isAllDay ? MGCAllDayEventType : MGCTimedEventType;
+            
+            // same as dayPlannerView:dateRangeForEventOfType:atIndex:date:
+            NSDate *end = ev.endDate;
+            if (type == MGCAllDayEventType) {
+                end = [calendar mgc_nextStartOfDayForDate:end];
+            }
+            
+            descriptors[i++] = MGCEventDescriptorMake(type, ev.startDate, end, MGCEventDescriptorIdentifier(ev));
+        }
+        _descriptors = [MGCEventDescriptorArray arrayWithDescriptors:descriptors count:i];
+    }
+    return self;
+}
+
+- (NSArray*)eventsOfType:(MGCEventType)type
+{
+    return type == MGCAllDayEventType ? self.allDayEvents : self.timedEvents;
+}
+
+@end
+
+
 @interface MGCDayPlannerEKViewController () <UINavigationControllerDelegate, EKEventEditViewDelegate, EKEventViewDelegate>
 
 @property (nonatomic) MGCEventKitSupport *eventKitSupport;
 @property (nonatomic) dispatch_queue_t bgQueue;			// dispatch queue for loading events
-@property (nonatomic) NSMutableOrderedSet *daysToLoad;	// dates for months of which we want to load events
-@property (nonatomic) NSCache *eventsCache;
+@property (nonatomic) NSMutableOrderedSet *daysToLoad;	// dates for days of which we want to load events
+@property (nonatomic) BOOL loadingScheduled;			// YES if bg_loadDays is pending on bgQueue
+@property (nonatomic) MGCDateRange *prefetchedDays;		// days that the day planner view expects to display soon
+@property (nonatomic) OSCache *eventsCache;				// cache of MGCDayEventsSnapshot objects (indexed by day)
 @property (nonatomic) NSUInteger createdEventType;
 @property (nonatomic, copy) NSDate *createdEventDate;
 
@@ -69,6 +136,7 @@ static NSString* const EventCellReuseIdentifier = @"EventCellReuseIdentifier";
 {
     if (self = [super initWithNibName:nil bundle:nil]) {
         _eventKitSupport = [[MGCEventKitSupport alloc]initWithEventStore:eventStore];
+        _eventSource = _eventKitSupport;
     }
     return self;
 }
@@ -207,118 +275,206 @@ static NSString* const EventCellReuseIdentifier = @"EventCellReuseIdentifier";
 
 - (void)setVisibleCalendars:(NSSet*)visibleCalendars
 {
-    _visibleCalendars = visibleCalendars;
-    [self.dayPlannerView reloadAllEvents];
+    _visibleCalendars = [visibleCalendars copy];
+    
+    if (!self.bgQueue) {
+        [self.dayPlannerView reloadAllEvents];
+        return;
+    }
+    
+    [self refilterCachedDays];
+}
+
+// refilters the cached days with the visible calendars in the background, without going back to the event store.
+// new snapshots are published on the main queue, right before the view is reloaded, so
+// that event indexes don't change under its feet
+- (void)refilterCachedDays
+{
+    NSSet *calendars = self.visibleCalendars;
+    dispatch_async(self.bgQueue, ^{
+        // the cache is locked while it is enumerated: only collect the stale snapshots, and build
+        // the new ones afterwards, so that the main thread is not blocked reading the cache
+        NSMutableDictionary *staleSnapshots = [NSMutableDictionary dictionary];
+        [self.eventsCache enumerateKeysAndObjectsUsingBlock:^(NSDate *date, MGCDayEventsSnapshot *snapshot, BOOL *stop) {
+            if (![snapshot.calendars isEqualToSet:calendars]) {
+                staleSnapshots[date] = snapshot;
+            }
+        }];
+        
+        NSMutableDictionary *snapshots = [NSMutableDictionary dictionaryWithCapacity:staleSnapshots.count];
+        [staleSnapshots enumerateKeysAndObjectsUsingBlock:^(NSDate *date, MGCDayEventsSnapshot *snapshot, BOOL *stop) {
+            snapshots[date] = [[MGCDayEventsSnapshot alloc]initWithEvents:snapshot.events calendars:calendars calendar:self.calendar];
+        }];
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (calendars != self.visibleCalendars) return;  // calendars changed again in the meantime
+            
+            [snapshots enumerateKeysAndObjectsUsingBlock:^(NSDate *date, MGCDayEventsSnapshot *snapshot, BOOL *stop) {
+                [self.eventsCache setObject:snapshot forKey:date];
+            }];
+            [self.dayPlannerView reloadAllEvents];
+        });
+    });
 }
 
 #pragma mark - Loading events
 
-- (void)fetchEventsInDateRange:(MGCDateRange*)range
+// fetches the events in range with a single query, and returns them bucketed by day
+- (NSDictionary*)eventsPerDayInDateRange:(MGCDateRange*)range
 {
-    range.start = [self.calendar mgc_startOfDayForDate:range.start];
-    range.end = [self.calendar mgc_nextStartOfDayForDate:range.end];
+    NSArray *events = [self.eventSource eventsFrom:range.start to:range.end calendars:nil];
+    
+    NSUInteger numDaysInRange = [range components:NSCalendarUnitDay forCalendar:self.calendar].day;
+    NSMutableDictionary *eventsPerDay = [NSMutableDictionary dictionaryWithCapacity:numDaysInRange];
     
+    for (EKEvent *ev in events)
+    {
+        NSDate *start = [self.calendar mgc_startOfDayForDate:ev.startDate];
+        MGCDateRange *eventRange = [MGCDateRange dateRangeWithStart:start end:ev.endDate];
+        [eventRange intersectDateRange:range];
+        
+        [eventRange enumerateDaysWithCalendar:self.calendar usingBlock:^(NSDate *date, BOOL *stop){
+            NSMutableArray *events = [eventsPerDay objectForKey:date];
+            if (!events) {
+                events = [NSMutableArray array];
+                [eventsPerDay setObject:events forKey:date];
+            }
+            
+            [events addObject:ev];
+        }];
+    }
+    
+    return eventsPerDay;
+}
+
+// returns snapshots for all days in range, filtered with given calendars
+- (NSDictionary*)snapshotsForDaysInDateRange:(MGCDateRange*)range calendars:(NSSet*)calendars
+{
+    NSDictionary *eventsPerDay = [self eventsPerDayInDateRange:range];
+    
+    NSMutableDictionary *snapshots = [NSMutableDictionary dictionary];
     [range enumerateDaysWithCalendar:self.calendar usingBlock:^(NSDate *date, BOOL *stop) {
-        NSDate *dayEnd = [self.calendar mgc_nextStartOfDayForDate:date];
-        NSArray *events = [self fetchEventsFrom:date to:dayEnd calendars:nil];
-        [self.eventsCache setObject:events forKey:date];
+        NSArray *events = [eventsPerDay objectForKey:date] ?: [NSArray array];
+        snapshots[date] = [[MGCDayEventsSnapshot alloc]initWithEvents:events calendars:calendars calendar:self.calendar];
     }];
+    return snapshots;
 }
 
-- (NSArray*)fetchEventsFrom:(NSDate*)startDate to:(NSDate*)endDate calendars:(NSArray*)calendars
+- (void)fetchEventsInDateRange:(MGCDateRange*)range
 {
-    NSPredicate *predicate = [self.eventStore predicateForEventsWithStartDate:startDate endDate:endDate calendars:calendars];
-    
-    if (self.eventKitSupport.accessGranted) {
-        NSArray *events = [self.eventStore eventsMatchingPredicate:predicate];
-        if (events) {
-            return [events sortedArrayUsingSelector:@selector(compareStartDateWithEvent:)];
-        }
-    }
+    range.start = [self.calendar mgc_startOfDayForDate:range.start];
+    range.end = [self.calendar mgc_nextStartOfDayForDate:range.end];
     
-    return [NSArray array];
+    NSDictionary *snapshots = [self snapshotsForDaysInDateRange:range calendars:self.visibleCalendars];
+    [snapshots enumerateKeysAndObjectsUsingBlock:^(NSDate *date, MGCDayEventsSnapshot *snapshot, BOOL *stop) {
+        [self.eventsCache setObject:snapshot forKey:date];
+    }];
 }
 
-// returns the events dictionary for given date
+// returns the events snapshot for given date
 // try to load it from the cache, or create it if needed
-- (NSArray*)eventsForDay:(NSDate*)date
+- (MGCDayEventsSnapshot*)snapshotForDay:(NSDate*)date
 {
     NSDate *dayStart = [self.calendar mgc_startOfDayForDate:date];
     
-    NSArray *events = [self.eventsCache objectForKey:dayStart];
+    MGCDayEventsSnapshot *snapshot = [self.eventsCache objectForKey:dayStart];
     
-    if (!events) {  // cache miss: create dictionary...
+    if (!snapshot) {  // cache miss: create snapshot...
         NSDate *dayEnd = [self.calendar mgc_nextStartOfDayForDate:dayStart];
-        events = [self fetchEventsFrom:dayStart to:dayEnd calendars:nil];
-        [self.eventsCache setObject:events forKey:dayStart];
+        NSArray *events = [self.eventSource eventsFrom:dayStart to:dayEnd calendars:nil];
+        snapshot = [[MGCDayEventsSnapshot alloc]initWithEvents:events calendars:self.visibleCalendars calendar:self.calendar];
+        [self.eventsCache setObject:snapshot forKey:dayStart];
     }
     
-    return events;
+    return snapshot;
 }
 
-- (NSArray*)eventsOfType:(EventType)type forDay:(NSDate*)date
+- (EKEvent*)eventOfType:(MGCEventType)type atIndex:(NSUInteger)index date:(NSDate*)date
 {
-    NSArray *events = [self eventsForDay:date];
-    
-    NSMutableArray *filteredEvents = [NSMutableArray new];
-    [events enumerateObjectsUsingBlock:^(EKEvent *ev, NSUInteger idx, BOOL *stop) {
-        
-        if ([self.visibleCalendars containsObject:ev.calendar]) {
-            if (type & AllDayEventType && ev.isAllDay)
-                [filteredEvents addObject:ev];
-            else if (type & TimedEventType && !ev.isAllDay)
-                [filteredEvents addObject:ev];
-        }
-    }];
-    
-    return filteredEvents;
+    return [[[self snapshotForDay:date] eventsOfType:type] objectAtIndex:index];
 }
 
-- (EKEvent*)eventOfType:(MGCEventType)type atIndex:(NSUInteger)index date:(NSDate*)date
+// sorts given days and coalesces them into ranges of contiguous days
+- (NSArray*)dayRangesForDates:(NSArray*)dates
 {
-    NSArray *events = nil;
+    NSMutableArray *ranges = [NSMutableArray array];
+    MGCDateRange *range = nil;
     
-    if (type == MGCAllDayEventType) {
-        events = [self eventsOfType:AllDayEventType forDay:date];
-    }
-    else if (type == MGCTimedEventType) {
-        events = [self eventsOfType:TimedEventType forDay:date];
+    for (NSDate *date in [dates sortedArrayUsingSelector:@selector(compare:)]) {
+        if (range && [date compare:range.end] != NSOrderedDescending) {
+            range.end = [self.calendar mgc_nextStartOfDayForDate:date];
+        }
+        else {
+            range = [MGCDateRange dateRangeWithStart:date end:[self.calendar mgc_nextStartOfDayForDate:date]];
+            [ranges addObject:range];
+        }
     }
-    
-    return [events objectAtIndex:index];
+    return ranges;
 }
 
-- (void)bg_loadEventsAtDate:(NSDate*)date
+- (void)bg_loadDays
 {
-    //NSLog(@"bg_loadEventsAtDate: %@", date);
+    __block NSArray *ranges;
+    __block NSSet *calendars;
     
-    NSDate *dayStart = [self.calendar mgc_startOfDayForDate:date];
+    dispatch_sync(dispatch_get_main_queue(), ^{
+        self.loadingScheduled = NO;
+        calendars = self.visibleCalendars;
+        
+        // we only load days that are still visible, or about to be
+        MGCDateRange *visibleDays = self.dayPlannerView.visibleDays;
+        NSMutableArray *dates = [NSMutableArray arrayWithCapacity:self.daysToLoad.count];
+        for (NSDate *date in self.daysToLoad) {
+            if ([visibleDays containsDate:date] || [self.prefetchedDays containsDate:date]) {
+                [dates addObject:date];
+            }
+        }
+        [self.daysToLoad removeAllObjects];
+        
+        ranges = [self dayRangesForDates:dates];
+    });
     
-    [self eventsOfType:AnyEventType forDay:dayStart];
+    if (ranges.count == 0) return;
     
-    dispatch_async(dispatch_get_main_queue(), ^{
-        [self.dayPlannerView reloadEventsAtDate:date];
-        [self.dayPlannerView setActivityIndicatorVisible:NO forDate:dayStart];
-    });
-}
-
-- (void)bg_loadOneDay
-{
-    __block NSDate *date;
+    //NSLog(@"bg_loadDays: %@", ranges);
     
-    dispatch_sync(dispatch_get_main_queue(), ^{
-        if ((date = [self.daysToLoad firstObject])) {
-            [self.daysToLoad removeObject:date];
+    NSMutableDictionary *snapshots = [NSMutableDictionary dictionary];
+    for (MGCDateRange *range in ranges) {
+        [snapshots addEntriesFromDictionary:[self snapshotsForDaysInDateRange:range calendars:calendars]];
+    }
+    
+    // if calendars changed while we were loading, snapshots are filtered again here rather than on the main queue
+    for (;;) {
+        __block NSSet *visibleCalendars;
+        dispatch_sync(dispatch_get_main_queue(), ^{
+            visibleCalendars = self.visibleCalendars;
+        });
+        if (visibleCalendars == calendars) break;
+        
+        calendars = visibleCalendars;
+        for (NSDate *date in snapshots.allKeys) {
+            MGCDayEventsSnapshot *snapshot = snapshots[date];
+            snapshots[date] = [[MGCDayEventsSnapshot alloc]initWithEvents:snapshot.events calendars:calendars calendar:self.calendar];
         }
+    }
+    
+    MGCDateRange *loadedRange = [MGCDateRange dateRangeWithStart:[ranges.firstObject start] end:[ranges.lastObject end]];
+    
+    // publish all loaded days at once
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [snapshots enumerateKeysAndObjectsUsingBlock:^(NSDate *date, MGCDayEventsSnapshot *snapshot, BOOL *stop) {
+            [self.eventsCache setObject:snapshot forKey:date];
+            [self.dayPlannerView setActivityIndicatorVisible:NO forDate:date];
+        }];
         
-        if (![self.dayPlannerView.visibleDays containsDate:date]) {
-            date = nil;
+        // calendars changed again since the last check: the refiltering scheduled by setVisibleCalendars:
+        // might have missed these days, so schedule another one
+        if (calendars != self.visibleCalendars) {
+            [self refilterCachedDays];
         }
+        
+        [self.dayPlannerView reloadEventsInRange:loadedRange];
     });
-    
-    if (date) {
-        [self bg_loadEventsAtDate:date];
-    }
 }
 
 - (BOOL)loadEventsAtDate:(NSDate*)date
@@ -334,7 +490,11 @@ static NSString* const EventCellReuseIdentifier = @"EventCellReuseIdentifier";
         
         [self.daysToLoad addObject:dayStart];
         
-        dispatch_async(self.bgQueue, ^{	[self bg_loadOneDay]; });
+        // days requested before the background queue gets to it are loaded in the same batch
+        if (!self.loadingScheduled) {
+            self.loadingScheduled = YES;
+            dispatch_async(self.bgQueue, ^{	[self bg_loadDays]; });
+        }
         
         return YES;
     }
@@ -348,16 +508,18 @@ static NSString* const EventCellReuseIdentifier = @"EventCellReuseIdentifier";
     NSInteger count = 0;
     
     if (![self loadEventsAtDate:date]) {
-        if (type == MGCAllDayEventType) {
-            count = [[self eventsOfType:AllDayEventType forDay:date]count];
-        }
-        else {
-            count = [[self eventsOfType:TimedEventType forDay:date]count];
-        }
+        count = [[[self snapshotForDay:date] eventsOfType:type] count];
     }
     return count;
 }
 
+- (MGCEventDescriptorArray*)dayPlannerView:(MGCDayPlannerView*)view eventDescriptorsForDate:(NSDate*)date
+{
+    if ([self loadEventsAtDate:date]) return nil;
+    
+    return [self snapshotForDay:date].descriptors;
+}
+
 - (MGCEventView*)dayPlannerView:(MGCDayPlannerView*)view viewForEventOfType:(MGCEventType)type atIndex:(NSUInteger)index date:(NSDate*)date
 {
     EKEvent *ev = [self eventOfType:type atIndex:index date:date];
@@ -458,6 +620,12 @@ static NSString* const EventCellReuseIdentifier = @"EventCellReuseIdentifier";
 - (void)dayPlannerView:(MGCDayPlannerView*)view willDisplayDate:(NSDate*)date
 {
     //NSLog(@"will display %@", date);
+    
+    // the view landed on the prefetched page: days outside of it do not need to be kept around anymore
+    if ([self.prefetchedDays includesDateRange:view.visibleDays]) {
+        self.prefetchedDays = nil;
+    }
+    
     BOOL loading = [self loadEventsAtDate:date];
     if (!loading) {
         [self.dayPlannerView setActivityIndicatorVisible:NO forDate:date];
@@ -467,7 +635,36 @@ static NSString* const EventCellReuseIdentifier = @"EventCellReuseIdentifier";
 - (void)dayPlannerView:(MGCDayPlannerView*)view didEndDisplayingDate:(NSDate*)date
 {
     //NSLog(@"did end displaying %@", date);
-    [self.daysToLoad removeObject:date];
+    if (![self.prefetchedDays containsDate:date]) {
+        [self.daysToLoad removeObject:date];
+    }
+}
+
+- (void)dayPlannerView:(MGCDayPlannerView*)view prefetchEventsInRange:(MGCDateRange*)range
+{
+    //NSLog(@"prefetch %@", range);
+    self.prefetchedDays = range;
+    
+    // days already in the cache are skipped, the others are loaded in the next batch
+    [range enumerateDaysWithCalendar:self.calendar usingBlock:^(NSDate *date, BOOL *stop) {
+        [self loadEventsAtDate:date];
+    }];
+}
+
+- (void)dayPlannerView:(MGCDayPlannerView*)view cancelPrefetchingEventsInRange:(MGCDateRange*)range
+{
+    //NSLog(@"cancel prefetching %@", range);
+    // the view only prefetches one range at a time, so whatever we recorded is stale now,
+    // even if it does not match the cancelled range exactly
+    self.prefetchedDays = nil;
+    
+    // only keep days that are still on screen - the others will be requested again if they show up
+    MGCDateRange *visibleDays = view.visibleDays;
+    [range enumerateDaysWithCalendar:self.calendar usingBlock:^(NSDate *date, BOOL *stop) {
+        if (![visibleDays containsDate:date]) {
+            [self.daysToLoad removeObject:date];
+        }
+    }];
 }
 
 #pragma mark - EKEventEditViewDelegate
@@ -29,9 +29,10 @@
 //
 
 #import <UIKit/UIKit.h>
+#import "MGCDateRange.h"
 
 @class MGCEventView;
-@class MGCDateRange;
+@class MGCEventDescriptorArray;
 
 @protocol MGCDayPlannerViewDataSource;
 @protocol MGCDayPlannerViewDelegate;
@@ -463,6 +464,14 @@ typedef NS_ENUM(NSUInteger, MGCDayPlannerCoveringType) {
  */
 - (void)reloadEventsAtDate:(NSDate*)date;
 
+/*!
+	@abstract	Reloads all events in given date range.
+	@param		range		The range of days to reload.
+	@discussion The view discards any currently displayed visible event views in the range and redisplays them.
+				Reloading several days at once is cheaper than calling reloadEventsAtDate: for each of them.
+ */
+- (void)reloadEventsInRange:(MGCDateRange*)range;
+
 // TODO: this has to be tested
 - (void)insertEventOfType:(MGCEventType)type withDateRange:(MGCDateRange*)range;
 
@@ -514,6 +523,28 @@ typedef NS_ENUM(NSUInteger, MGCDayPlannerCoveringType) {
 
 @optional
 
+/*!
+	@abstract	Asks the data source for the descriptors of all events at specified date.
+	@param		view		The day planner view object making the request.
+	@param		date		The starting day of the events (time portion should be ignored).
+	@return		An immutable array of descriptors giving the type, start, end and stable identifier of each event, or nil if events for the day are not available yet.
+	@discussion	If this method is implemented, the view uses it instead of dayPlannerView:numberOfEventsOfType:atDate: and
+				dayPlannerView:dateRangeForEventOfType:atIndex:date:, asking for the events of a whole day only once until it is reloaded.
+				The index of an event of a given type is its position among the descriptors of that type.
+				If nil is returned, the day is shown with no events and the data source is asked again when the day is reloaded.
+	@see		MGCEventDescriptorArray
+ */
+- (MGCEventDescriptorArray*)dayPlannerView:(MGCDayPlannerView*)view eventDescriptorsForDate:(NSDate*)date;
+
+/*!
+	@abstract	Asks the data source for the time span of the specified event in the day planner view.
+	@discussion	If this method is implemented, the view uses it instead of dayPlannerView:dateRangeForEventOfType:atIndex:date:,
+				which saves creating a date range every time the event is laid out.
+				It is not called if the data source provides event descriptors.
+	@see		MGCTimeSpan
+ */
+- (MGCTimeSpan)dayPlannerView:(MGCDayPlannerView*)view timeSpanForEventOfType:(MGCEventType)type atIndex:(NSUInteger)index date:(NSDate*)date;
+
 /*!
 	@abstract	Asks the data source if the specified event can be moved around. If the method returns YES, the 
 				event view can be dragged and dropped to a different date / time.
@@ -600,6 +631,13 @@ typedef NS_ENUM(NSUInteger, MGCDayPlannerCoveringType) {
  */
 - (MGCDateRange*)dayPlannerView:(MGCDayPlannerView*)view dimmedTimeRangeAtIndex:(NSUInteger)index date:(NSDate*)date;
 
+/*!
+	@abstract   Asks the delegate for the dimmed time span at given date and index.
+	@discussion	If this method is implemented, the view uses it instead of dayPlannerView:dimmedTimeRangeAtIndex:date:.
+	@see		MGCTimeSpan
+ */
+- (MGCTimeSpan)dayPlannerView:(MGCDayPlannerView*)view dimmedTimeSpanAtIndex:(NSUInteger)index date:(NSDate*)date;
+
 
 /*!
 	@group Responding to scrolling
@@ -639,6 +677,29 @@ typedef NS_ENUM(NSUInteger, MGCDayPlannerCoveringType) {
  */
 - (void)dayPlannerView:(MGCDayPlannerView*)view didEndDisplayingDate:(NSDate*)date;
 
+/*!
+	@abstract	Tells the delegate that the specified days are likely to be displayed soon in the day planner view.
+	@param		view		The day planner view object notifying about the display change.
+	@param		range		The range of days where the view is expected to land.
+	@discussion The method is called when a horizontal drag ends and the view is about to decelerate, or when
+				the view starts scrolling to a date programmatically. It gives the delegate a chance to start
+				loading the events of the landing page before it is actually displayed.
+				For fast swipes, the range also includes the next page in the direction of the movement.
+	@see		dayPlannerView:cancelPrefetchingEventsInRange:
+ */
+- (void)dayPlannerView:(MGCDayPlannerView*)view prefetchEventsInRange:(MGCDateRange*)range;
+
+/*!
+	@abstract	Tells the delegate that a range of days previously passed to dayPlannerView:prefetchEventsInRange:
+				is not needed anymore.
+	@param		view		The day planner view object notifying about the display change.
+	@param		range		The range of days previously prefetched.
+	@discussion This happens when the scroll target changes before the view stopped scrolling, for instance
+				if the user swipes again in the other direction. Days which are displayed anyway will still be
+				announced with dayPlannerView:willDisplayDate:.
+ */
+- (void)dayPlannerView:(MGCDayPlannerView*)view cancelPrefetchingEventsInRange:(MGCDateRange*)range;
+
 /*!
 	@abstract	Tells the delegate that the day planner view was zoomed in or out, increasing or decreasing the hour slot height.
 	@param		view		The day planner view object notifying about the display change.
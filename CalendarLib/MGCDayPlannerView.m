@@ -31,6 +31,8 @@
 #import "MGCDayPlannerView.h"
 #import "NSCalendar+MGCAdditions.h"
 #import "MGCDateRange.h"
+#import "MGCDayBoundaryTable.h"
+#import "MGCEventDescriptorArray.h"
 #import "MGCReusableObjectQueue.h"
 #import "MGCTimedEventsViewLayout.h"
 #import "MGCAllDayEventsViewLayout.h"
@@ -69,6 +71,10 @@ static NSString* const MoreEventsViewReuseIdentifier = @"MoreEventsViewReuseIden
 // this value can be tweaked for performance or smoother scrolling (between 2 and 4 seems reasonable)
 static const NSUInteger kDaysLoadingStep = 2;
 
+// horizontal velocity (in points per millisecond) above which we also prefetch events for the page
+// following the landing page of a swipe
+static const CGFloat kPrefetchLookAheadVelocity = 2.;
+
 // minimum and maximum height of a one-hour time slot
 static const CGFloat kMinHourSlotHeight = 20.;
 static const CGFloat kMaxHourSlotHeight = 150.;
@@ -118,6 +124,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 @property (nonatomic, readonly) NSDate *maxStartDate;			// maximum date for the start of a loaded page of the collection view - set with dateRange, nil for infinite scrolling
 @property (nonatomic, readonly) NSUInteger numberOfLoadedDays;	// number of days loaded at once in the collection views
 @property (nonatomic, readonly) MGCDateRange* loadedDaysRange;	// date range of all days currently loaded in the collection views
+@property (nonatomic, readonly) MGCDayBoundaryTable *dayBoundaries;	// boundaries of the loaded days, used for day and time calculations - rebuilt when startDate changes
 @property (nonatomic) MGCDateRange* previousVisibleDays;		// used by updateVisibleDaysRange to inform delegate about appearing / disappearing days
 
 @property (nonatomic) NSMutableOrderedSet *loadingDays;			// set of dates with running activity indicator
@@ -131,6 +138,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 @property (nonatomic) CGPoint scrollStartOffset;				// content offset in the controllingScrollView where scrolling started - used to lock scrolling in one direction
 @property (nonatomic) ScrollDirection scrollDirection;			// direction or axis of the scroll movement
 @property (nonatomic) NSDate *scrollTargetDate;                 // target date after scrolling (initiated programmatically or following pan or swipe gesture)
+@property (nonatomic) MGCDateRange *prefetchedDays;				// range of days the delegate was last asked to prefetch, until scrolling ends
 
 @property (nonatomic) MGCInteractiveEventView *interactiveCell;	// view used when dragging event around
 @property (nonatomic) CGPoint interactiveCellTouchPoint;		// point where touch occured in interactiveCell coordinates
@@ -152,7 +160,8 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 @property (nonatomic) CGFloat hourSlotHeightForGesture;
 @property (copy, nonatomic) dispatch_block_t scrollViewAnimationCompletionBlock;
 
-@property (nonatomic) OSCache *dimmedTimeRangesCache;          // cache for dimmed time ranges (indexed by date)
+@property (nonatomic) OSCache *dimmedTimeRangesCache;          // cache for dimmed time spans, packed in NSData objects (indexed by date)
+@property (nonatomic) NSMutableDictionary *eventDescriptorsCache;	// cache for event descriptors provided by the data source (indexed by date), NSNull if there are none
 
 @end
 
@@ -169,6 +178,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 @synthesize timedEventsViewLayout = _timedEventsViewLayout;
 @synthesize allDayEventsViewLayout = _allDayEventsViewLayout;
 @synthesize startDate = _startDate;
+@synthesize dayBoundaries = _dayBoundaries;
 
 #pragma mark - Initialization
 
@@ -200,6 +210,8 @@ static const CGFloat kMaxHourSlotHeight = 150.;
     _dimmedTimeRangesCache = [[OSCache alloc]init];
     _dimmedTimeRangesCache.countLimit = 200;
     
+    _eventDescriptorsCache = [NSMutableDictionary dictionary];
+    
     _durationForNewTimedEvent = 60 * 60;
     
 	self.backgroundColor = [UIColor whiteColor];
@@ -259,6 +271,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 		NSDate* date = self.visibleDays.start;
         
         _numberOfVisibleDays = numberOfVisibleDays;
+        _dayBoundaries = nil;
         
         if (self.dateRange && [self.dateRange components:NSCalendarUnitDay forCalendar:self.calendar].day < numberOfVisibleDays)
             return;
@@ -328,6 +341,13 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	return _calendar;
 }
 
+// public
+- (void)setCalendar:(NSCalendar*)calendar
+{
+	_calendar = calendar;
+	_dayBoundaries = nil;
+}
+
 // public
 - (void)setDateRange:(MGCDateRange*)dateRange
 {
@@ -335,6 +355,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 		NSDate *firstDate = self.visibleDays.start;
 		
 		_dateRange = nil;
+		_dayBoundaries = nil;
 	
 		if (dateRange) {
 			
@@ -411,7 +432,13 @@ static const CGFloat kMaxHourSlotHeight = 150.;
     [self.dimmedTimeRangesCache removeAllObjects];
     
     self.timedEventsViewLayout.dayColumnSize = self.dayColumnSize;
-    [self.timedEventsViewLayout invalidateLayout];
+    
+    // events move even if the height of the columns does not change
+    MGCTimedEventsViewLayoutInvalidationContext *context = [MGCTimedEventsViewLayoutInvalidationContext new];
+    context.invalidatedSections = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, self.numberOfLoadedDays)];
+    context.invalidateEventCells = YES;
+    context.invalidateDimmingViews = YES;
+    [self.timedEventsViewLayout invalidateLayoutWithContext:context];
 
     self.timeRowsView.hourRange = hourRange;
     self.timeScrollView.contentSize = CGSizeMake(self.bounds.size.width, self.dayColumnSize.height);
@@ -502,6 +529,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	NSAssert([startDate compare:self.maxStartDate] != NSOrderedDescending, @"start date not in the scrollable date range");
 
 	_startDate = startDate;
+	_dayBoundaries = nil;
 	
 	//NSLog(@"Loaded days range: %@", self.loadedDaysRange);
 }
@@ -540,6 +568,14 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	return [MGCDateRange dateRangeWithStart:self.startDate end:endDate];
 }
 
+- (MGCDayBoundaryTable*)dayBoundaries
+{
+	if (_dayBoundaries == nil) {
+		_dayBoundaries = [MGCDayBoundaryTable tableWithCalendar:self.calendar startDate:self.startDate numberOfDays:self.numberOfLoadedDays];
+	}
+	return _dayBoundaries;
+}
+
 // first fully visible day (!= visibleDays.start)
 - (NSDate*)firstVisibleDate
 {
@@ -559,9 +595,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 // dayOffset is the offset from the first loaded day in the view (ie startDate)
 - (NSDate*)dateFromDayOffset:(NSInteger)dayOffset
 {
-	NSDateComponents *comp = [NSDateComponents new];
-	comp.day = dayOffset;
-	return [self.calendar dateByAddingComponents:comp toDate:self.startDate options:0];
+	return [self.dayBoundaries dateForDayOffset:dayOffset];
 }
 
 // returns the day offset from the first loaded day in the view (ie startDate)
@@ -569,8 +603,7 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 {
 	NSAssert(date, @"dayOffsetFromDate: was passed nil date");
 	
-	NSDateComponents *comps = [self.calendar components:NSCalendarUnitDay fromDate:self.startDate toDate:date options:0];
-	return comps.day;
+	return [self.dayBoundaries dayOffsetForDate:date];
 }
 
 // returns the time interval corresponding to a vertical offset in the timedEventsView coordinates,
@@ -595,10 +628,12 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	return MGCAlignedFloat(hour * self.hourSlotHeight + self.eventsViewInnerMargin);
 }
 
-- (CGFloat)offsetFromDate:(NSDate*)date
+// returns the vertical offset in the timedEventsView coordinates corresponding to given absolute time
+- (CGFloat)offsetFromAbsoluteTime:(CFAbsoluteTime)time
 {
-    NSDateComponents *comp = [self.calendar components:(NSCalendarUnitHour|NSCalendarUnitMinute) fromDate:date];
-    CGFloat y = roundf((comp.hour + comp.minute / 60. - self.hourRange.location) * self.hourSlotHeight + self.eventsViewInnerMargin);
+    // time of day is truncated to the minute
+    NSTimeInterval ti = floor([self.dayBoundaries timeOfDayForAbsoluteTime:time] / 60.) * 60.;
+    CGFloat y = roundf((ti / 3600. - self.hourRange.location) * self.hourSlotHeight + self.eventsViewInnerMargin);
     // when the following line is commented, event cells and dimming views are not constrained to the visible hour range
     // (ie cells can show past the edge of content)
     //y = fmax(self.eventsViewInnerMargin, fmin(self.dayColumnSize.height - self.eventsViewInnerMargin, y));
@@ -614,19 +649,20 @@ static const CGFloat kMaxHourSlotHeight = 150.;
         return [self convertPoint:pt fromView:self.allDayEventsView];
     }
     else {
-        NSTimeInterval ti = [date timeIntervalSinceDate:[self.calendar mgc_startOfDayForDate:date]];
+        NSTimeInterval ti = [date timeIntervalSinceDate:[self.dayBoundaries startOfDayForDate:date]];
         CGFloat y = [self offsetFromTime:ti rounding:1];
         CGPoint pt = CGPointMake(x, y);
         return [self convertPoint:pt fromView:self.timedEventsView];
     }
 }
 
-// returns the scrollable time range for the day at date, depending on hourRange
-- (MGCDateRange*)scrollableTimeRangeForDate:(NSDate*)date
+// returns the scrollable time span for the day at date, depending on hourRange
+- (MGCTimeSpan)scrollableTimeSpanForDate:(NSDate*)date
 {
-    NSDate *dayRangeStart = [self.calendar dateBySettingHour:self.hourRange.location minute:0 second:0 ofDate:date options:0];
-    NSDate *dayRangeEnd = [self.calendar dateBySettingHour:NSMaxRange(self.hourRange) - 1 minute:59 second:0 ofDate:date options:0];
-    return [MGCDateRange dateRangeWithStart:dayRangeStart end:dayRangeEnd];
+    CFAbsoluteTime time = date.timeIntervalSinceReferenceDate;
+    CFAbsoluteTime dayRangeStart = [self.dayBoundaries absoluteTimeBySettingTimeOfDay:self.hourRange.location * 3600 ofAbsoluteTime:time];
+    CFAbsoluteTime dayRangeEnd = [self.dayBoundaries absoluteTimeBySettingTimeOfDay:NSMaxRange(self.hourRange) * 3600 - 60 ofAbsoluteTime:time];
+    return MGCTimeSpanMake(dayRangeStart, dayRangeEnd);
 }
 
 #pragma mark - Locating days and events
@@ -735,6 +771,10 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 		}
 	};
 	
+	if (animated && options != MGCDayPlannerScrollTime) {
+		[self prefetchEventsForContentOffset:x velocity:0];
+	}
+	
 	if (options == MGCDayPlannerScrollTime) {
 		self.userInteractionEnabled = NO;
 		offset.y = y;
@@ -1011,6 +1051,9 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	
 	if (gesture.state == UIGestureRecognizerStateBegan) {
 		self.hourSlotHeightForGesture = self.hourSlotHeight;
+		
+		// event cells are only stretched during the gesture, and laid out again when it ends
+		[self.timedEventsViewLayout beginZoomingWithVerticalInset:self.eventsViewInnerMargin];
 	}
 	else if (gesture.state == UIGestureRecognizerStateChanged) {
 		if (gesture.numberOfTouches > 1) {
@@ -1025,6 +1068,9 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 			}
 		}
 	}
+	else {  // ended, cancelled or failed
+		[self.timedEventsViewLayout endZooming];
+	}
 }
 
 #pragma mark - Selection
@@ -1499,6 +1545,14 @@ static const CGFloat kMaxHourSlotHeight = 150.;
     self.allDayEventsViewLayout.dayColumnWidth = dayColumnSize.width;
     self.allDayEventsViewLayout.eventCellHeight = self.allDayEventCellHeight;
     
+    // keep the event descriptors of days which are still loaded
+    MGCDateRange *loadedDaysRange = self.loadedDaysRange;
+    for (NSDate *date in self.eventDescriptorsCache.allKeys) {
+        if (![loadedDaysRange containsDate:date]) {
+            [self.eventDescriptorsCache removeObjectForKey:date];
+        }
+    }
+    
     [self.dayColumnsView reloadData];
 	[self.timedEventsView reloadData];
     [self.allDayEventsView reloadData];
@@ -1515,6 +1569,8 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	
 	[self deselectEventWithDelegate:YES];
 	
+	[self.eventDescriptorsCache removeAllObjects];
+	
 	[self.allDayEventsView reloadData];
 	[self.timedEventsView reloadData];
 	
@@ -1548,10 +1604,28 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 {
 	//NSLog(@"reloadEventsAtDate %@", date);
 
+	NSDate *dayStart = [self.calendar mgc_startOfDayForDate:date];
+	[self reloadEventsInRange:[MGCDateRange dateRangeWithStart:dayStart end:[self.calendar mgc_nextStartOfDayForDate:dayStart]]];
+}
+
+// public
+- (void)reloadEventsInRange:(MGCDateRange*)range
+{
+	//NSLog(@"reloadEventsInRange %@", range);
+	
 	[self deselectEventWithDelegate:YES];
 	
-	if ([self.loadedDaysRange containsDate:date]) {
+	MGCDateRange *days = [MGCDateRange dateRangeWithStart:[self.calendar mgc_startOfDayForDate:range.start] end:range.end];
+	[days intersectDateRange:self.loadedDaysRange];
 	
+	if (!days.isEmpty) {
+		
+		NSMutableIndexSet *sections = [NSMutableIndexSet indexSet];
+		[days enumerateDaysWithCalendar:self.calendar usingBlock:^(NSDate *date, BOOL *stop) {
+			[self.eventDescriptorsCache removeObjectForKey:date];
+			[sections addIndex:[self dayOffsetFromDate:date]];
+		}];
+		
         // we have to reload everything for the all-day events view because some events might span several days
 		[self.allDayEventsView reloadData];
         
@@ -1559,17 +1633,18 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 			// only if we're not scrolling
 			[self setupSubviews];
 		}
-        NSInteger section = [self dayOffsetFromDate:date];
         
         // for some reason, reloadSections: does not work properly. See comment for ignoreNextInvalidation
         self.timedEventsViewLayout.ignoreNextInvalidation = YES; 
         [self.timedEventsView reloadData];
 		
         MGCTimedEventsViewLayoutInvalidationContext *context = [MGCTimedEventsViewLayoutInvalidationContext new];
-        context.invalidatedSections = [NSIndexSet indexSetWithIndex:section];
+        context.invalidatedSections = sections;
         [self.timedEventsView.collectionViewLayout invalidateLayoutWithContext:context];
 
-		[self refreshEventMarkForColumnAtDate:date];
+		[days enumerateDaysWithCalendar:self.calendar usingBlock:^(NSDate *date, BOOL *stop) {
+			[self refreshEventMarkForColumnAtDate:date];
+		}];
 	}
 }
 
@@ -1594,7 +1669,9 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	NSMutableArray *indexPaths = [NSMutableArray array];
 	for (NSInteger section = start; section <= end; section++) {
 		NSDate *date = [self dateFromDayOffset:section];
-		NSInteger num = [self.dataSource dayPlannerView:self numberOfEventsOfType:type atDate:date];
+		[self.eventDescriptorsCache removeObjectForKey:date];
+		
+		NSInteger num = [self numberOfEventsOfType:type atDate:date];
 		NSIndexPath *path = [NSIndexPath indexPathForItem:num inSection:section];
 		
 		[indexPaths addObject:path];
@@ -1797,16 +1874,55 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	return cell;
 }
 
+// returns the descriptors of events at date, asking the data source if they're not cached,
+// or nil if the data source does not provide them
+- (MGCEventDescriptorArray*)eventDescriptorsAtDate:(NSDate*)date
+{
+	if (![self.dataSource respondsToSelector:@selector(dayPlannerView:eventDescriptorsForDate:)]) return nil;
+	
+	id descriptors = [self.eventDescriptorsCache objectForKey:date];
+	if (!descriptors) {
+		descriptors = [self.dataSource dayPlannerView:self eventDescriptorsForDate:date];
+		// a nil result is cached too, so that the data source is not asked again until the day is reloaded
+		[self.eventDescriptorsCache setObject:descriptors ?: [NSNull null] forKey:date];
+	}
+	return descriptors == [NSNull null] ? nil : descriptors;
+}
+
+- (NSInteger)numberOfEventsOfType:(MGCEventType)type atDate:(NSDate*)date
+{
+	if ([self.dataSource respondsToSelector:@selector(dayPlannerView:eventDescriptorsForDate:)]) {
+		return [[self eventDescriptorsAtDate:date] numberOfEventsOfType:type];
+	}
+	return [self.dataSource dayPlannerView:self numberOfEventsOfType:type atDate:date];
+}
+
+- (MGCTimeSpan)timeSpanForEventOfType:(MGCEventType)type atIndex:(NSUInteger)index date:(NSDate*)date
+{
+	MGCEventDescriptorArray *descriptors = [self eventDescriptorsAtDate:date];
+	if (descriptors) {
+		MGCEventDescriptor event = [descriptors descriptorOfType:type atIndex:index];
+		return MGCTimeSpanMake(event.start, event.end);
+	}
+	if ([self.dataSource respondsToSelector:@selector(dayPlannerView:timeSpanForEventOfType:atIndex:date:)]) {
+		return [self.dataSource dayPlannerView:self timeSpanForEventOfType:type atIndex:index date:date];
+	}
+	
+	MGCDateRange *range = [self.dataSource dayPlannerView:self dateRangeForEventOfType:type atIndex:index date:date];
+	NSAssert(range, @"[MGCDayPlannerViewDataSource dayPlannerView:dateRangeForEventOfType:atIndex:date:] cannot return nil!");
+	return range.timeSpan;
+}
+
 - (NSInteger)collectionView:(UICollectionView*)collectionView numberOfItemsInSection:(NSInteger)section
 {
 	if (collectionView == self.timedEventsView) {
 		NSDate *date = [self dateFromDayOffset:section];
-		return [self.dataSource dayPlannerView:self numberOfEventsOfType:MGCTimedEventType atDate:date];
+		return [self numberOfEventsOfType:MGCTimedEventType atDate:date];
 	}
 	else if (collectionView == self.allDayEventsView) {
         if (!self.showsAllDayEvents) return 0;
 		NSDate *date = [self dateFromDayOffset:section];
-		return [self.dataSource dayPlannerView:self numberOfEventsOfType:MGCAllDayEventType atDate:date];
+		return [self numberOfEventsOfType:MGCAllDayEventType atDate:date];
 	}
 	return 1; // for dayColumnView
 }
@@ -1941,65 +2057,113 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 {
     NSDate *date = [self dateFromDayOffset:indexPath.section];
     
-    MGCDateRange *dayRange = [self scrollableTimeRangeForDate:date];
+    MGCTimeSpan daySpan = [self scrollableTimeSpanForDate:date];
+    MGCTimeSpan eventSpan = [self timeSpanForEventOfType:MGCTimedEventType atIndex:indexPath.item date:date];
     
-    MGCDateRange* eventRange = [self.dataSource dayPlannerView:self dateRangeForEventOfType:MGCTimedEventType atIndex:indexPath.item date:date];
-    NSAssert(eventRange, @"[AllDayEventsViewLayoutDelegate dayPlannerView:dateRangeForEventOfType:atIndex:date:] cannot return nil!");
+    eventSpan = MGCTimeSpanIntersection(eventSpan, daySpan);
     
-    [eventRange intersectDateRange:dayRange];
-    
-    if (!eventRange.isEmpty) {
-        CGFloat y1 = [self offsetFromDate:eventRange.start];
-        CGFloat y2 = [self offsetFromDate:eventRange.end];
+    if (!MGCTimeSpanIsEmpty(eventSpan)) {
+        CGFloat y1 = [self offsetFromAbsoluteTime:eventSpan.start];
+        CGFloat y2 = [self offsetFromAbsoluteTime:eventSpan.end];
         
         return CGRectMake(0, y1, 0, y2 - y1);
     }
     return CGRectNull;
 }
 
-- (NSArray*)dimmedTimeRangesAtDate:(NSDate*)date
+- (NSUInteger)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout getEventSpans:(MGCEventSpan*)spans inSection:(NSUInteger)section
 {
-    NSMutableArray *ranges = [NSMutableArray array];
+    NSDate *date = [self dateFromDayOffset:section];
+    NSInteger numItems = [collectionView numberOfItemsInSection:section];
+    NSUInteger count = 0;
+    
+    MGCEventDescriptorArray *descriptors = [self eventDescriptorsAtDate:date];
+    if (descriptors) {
+        MGCTimeSpan daySpan = [self scrollableTimeSpanForDate:date];
+        
+        const MGCEventDescriptor *events = [descriptors descriptorsOfType:MGCTimedEventType];
+        NSUInteger numEvents = MIN(numItems, [descriptors numberOfEventsOfType:MGCTimedEventType]);
+        
+        for (NSUInteger item = 0; item < numEvents; item++) {
+            // same as in collectionView:layout:rectForEventAtIndexPath:
+            MGCTimeSpan eventSpan = MGCTimeSpanIntersection(MGCTimeSpanMake(events[item].start, events[item].end), daySpan);
+            
+            if (!MGCTimeSpanIsEmpty(eventSpan)) {
+                CGFloat y1 = [self offsetFromAbsoluteTime:eventSpan.start];
+                CGFloat y2 = [self offsetFromAbsoluteTime:eventSpan.end];
+                spans[count++] = (MGCEventSpan){ y1, y2, item };
+            }
+        }
+    }
+    else {
+        for (NSInteger item = 0; item < numItems; item++) {
+            NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
+            CGRect rect = [self collectionView:collectionView layout:layout rectForEventAtIndexPath:indexPath];
+            if (!CGRectIsNull(rect)) {
+                spans[count++] = (MGCEventSpan){ rect.origin.y, rect.origin.y + rect.size.height, item };
+            }
+        }
+    }
+    return count;
+}
+
+- (NSDate*)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout dateForSection:(NSUInteger)section
+{
+    return [self dateFromDayOffset:section];
+}
+
+// returns the non-empty dimmed time spans at date, packed in a NSData object
+- (NSData*)dimmedTimeSpansAtDate:(NSDate*)date
+{
+    NSMutableData *spans = [NSMutableData data];
         
     if ([self.delegate respondsToSelector:@selector(dayPlannerView:numberOfDimmedTimeRangesAtDate:)]) {
         NSInteger count = [self.delegate dayPlannerView:self numberOfDimmedTimeRangesAtDate:date];
         
-        if (count > 0 && [self.delegate respondsToSelector:@selector(dayPlannerView:dimmedTimeRangeAtIndex:date:)]) {
-            MGCDateRange *dayRange = [self scrollableTimeRangeForDate:date];
+        BOOL providesSpans = [self.delegate respondsToSelector:@selector(dayPlannerView:dimmedTimeSpanAtIndex:date:)];
+        if (count > 0 && (providesSpans || [self.delegate respondsToSelector:@selector(dayPlannerView:dimmedTimeRangeAtIndex:date:)])) {
+            MGCTimeSpan daySpan = [self scrollableTimeSpanForDate:date];
 
             for (NSUInteger i = 0; i < count; i++) {
-                MGCDateRange *range = [self.delegate dayPlannerView:self dimmedTimeRangeAtIndex:i date:date];
+                MGCTimeSpan span;
+                if (providesSpans) {
+                    span = [self.delegate dayPlannerView:self dimmedTimeSpanAtIndex:i date:date];
+                }
+                else {
+                    span = [self.delegate dayPlannerView:self dimmedTimeRangeAtIndex:i date:date].timeSpan;
+                }
                 
-                [range intersectDateRange:dayRange];
+                span = MGCTimeSpanIntersection(span, daySpan);
                     
-                if (!range.isEmpty) {
-                    [ranges addObject:range];
+                if (!MGCTimeSpanIsEmpty(span)) {
+                    [spans appendBytes:&span length:sizeof(MGCTimeSpan)];
                 }
             }
         }
     }
-    return ranges;
+    return spans;
 }
 
 - (NSArray*)collectionView:(UICollectionView *)collectionView layout:(MGCTimedEventsViewLayout *)layout dimmingRectsForSection:(NSUInteger)section
 {
     NSDate *date = [self dateFromDayOffset:section];
 
-    NSArray *ranges = [self.dimmedTimeRangesCache objectForKey:date];
-    if (!ranges) {
-        ranges = [self dimmedTimeRangesAtDate:date];
-        [self.dimmedTimeRangesCache setObject:ranges forKey:date];
+    NSData *spans = [self.dimmedTimeRangesCache objectForKey:date];
+    if (!spans) {
+        spans = [self dimmedTimeSpansAtDate:date];
+        [self.dimmedTimeRangesCache setObject:spans forKey:date];
     }
-     
-    NSMutableArray *rects = [NSMutableArray arrayWithCapacity:ranges.count];
+    
+    const MGCTimeSpan *dimmedSpans = spans.bytes;
+    NSUInteger count = spans.length / sizeof(MGCTimeSpan);
+    
+    NSMutableArray *rects = [NSMutableArray arrayWithCapacity:count];
 
-    for (MGCDateRange *range in ranges) {
-        if (!range.isEmpty) {
-            CGFloat y1 = [self offsetFromDate:range.start];
-            CGFloat y2 = [self offsetFromDate:range.end];
-            
-            [rects addObject:[NSValue valueWithCGRect:CGRectMake(0, y1, 0, y2 - y1)]];
-        }
+    for (NSUInteger i = 0; i < count; i++) {
+        CGFloat y1 = [self offsetFromAbsoluteTime:dimmedSpans[i].start];
+        CGFloat y2 = [self offsetFromAbsoluteTime:dimmedSpans[i].end];
+        
+        [rects addObject:[NSValue valueWithCGRect:CGRectMake(0, y1, 0, y2 - y1)]];
     }
     return rects;
 }
@@ -2007,21 +2171,62 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 
 #pragma mark - MGCAllDayEventsViewLayoutDelegate
 
-- (NSRange)collectionView:(UICollectionView*)view layout:(MGCAllDayEventsViewLayout*)layout dayRangeForEventAtIndexPath:(NSIndexPath*)indexPath
+// returns the range of sections covered by an all-day event with given time span
+- (NSRange)dayRangeForEventWithTimeSpan:(MGCTimeSpan)span
 {
-	NSDate *date = [self dateFromDayOffset:indexPath.section];
-	MGCDateRange *dateRange = [self.dataSource dayPlannerView:self dateRangeForEventOfType:MGCAllDayEventType atIndex:indexPath.item date:date];
-	NSAssert(dateRange, @"[AllDayEventsViewLayoutDelegate dayPlannerView:dateRangeForEventOfType:atIndex:date:] cannot return nil!");
+	CFAbsoluteTime start = fmax(span.start, self.startDate.timeIntervalSinceReferenceDate);
 	
-	if ([dateRange.start compare:self.startDate] == NSOrderedAscending)
-		dateRange.start = self.startDate;
+	NSInteger startSection = [self.dayBoundaries dayOffsetForAbsoluteTime:start];
+	NSInteger length;
 	
-	NSUInteger startSection = [self dayOffsetFromDate:dateRange.start];
-	NSUInteger length = [dateRange components:NSCalendarUnitDay forCalendar:self.calendar].day;
+	if (start == [self.dayBoundaries absoluteTimeForDayOffset:startSection]) {
+		// number of whole days from the start of a day is the difference of day offsets
+		length = [self.dayBoundaries dayOffsetForAbsoluteTime:span.end] - startSection;
+	}
+	else {
+		NSDate *startDate = [NSDate dateWithTimeIntervalSinceReferenceDate:start];
+		NSDate *endDate = [NSDate dateWithTimeIntervalSinceReferenceDate:span.end];
+		length = [self.calendar components:NSCalendarUnitDay fromDate:startDate toDate:endDate options:0].day;
+	}
 	
 	return NSMakeRange(startSection, length);
 }
 
+- (NSRange)collectionView:(UICollectionView*)view layout:(MGCAllDayEventsViewLayout*)layout dayRangeForEventAtIndexPath:(NSIndexPath*)indexPath
+{
+	NSDate *date = [self dateFromDayOffset:indexPath.section];
+	MGCTimeSpan span = [self timeSpanForEventOfType:MGCAllDayEventType atIndex:indexPath.item date:date];
+	
+	return [self dayRangeForEventWithTimeSpan:span];
+}
+
+- (void)collectionView:(UICollectionView*)view layout:(MGCAllDayEventsViewLayout*)layout getDayRanges:(NSRange*)ranges forEventsInSection:(NSUInteger)section
+{
+	NSDate *date = [self dateFromDayOffset:section];
+	NSInteger numItems = [view numberOfItemsInSection:section];
+	
+	MGCEventDescriptorArray *descriptors = [self eventDescriptorsAtDate:date];
+	if (descriptors) {
+		const MGCEventDescriptor *events = [descriptors descriptorsOfType:MGCAllDayEventType];
+		NSUInteger numEvents = [descriptors numberOfEventsOfType:MGCAllDayEventType];
+		
+		for (NSInteger item = 0; item < numItems; item++) {
+			if (item < numEvents) {
+				ranges[item] = [self dayRangeForEventWithTimeSpan:MGCTimeSpanMake(events[item].start, events[item].end)];
+			}
+			else {
+				ranges[item] = NSMakeRange(section, 0);
+			}
+		}
+	}
+	else {
+		for (NSInteger item = 0; item < numItems; item++) {
+			NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
+			ranges[item] = [self collectionView:view layout:layout dayRangeForEventAtIndexPath:indexPath];
+		}
+	}
+}
+
 // TODO: implement
 - (AllDayEventInset)collectionView:(UICollectionView*)view layout:(MGCAllDayEventsViewLayout*)layout insetsForEventAtIndexPath:(NSIndexPath*)indexPath
 {
@@ -2166,8 +2371,16 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 		
 		if (diff != 0) {
 			self.startDate = newStart;
+			
+			// days which are still loaded just moved by diff sections, so we keep their layout.
+			// see comment for ignoreNextInvalidation
+			self.timedEventsViewLayout.ignoreNextInvalidation = YES;
 			[self reloadCollectionViews];
 			
+			MGCTimedEventsViewLayoutInvalidationContext *context = [MGCTimedEventsViewLayoutInvalidationContext new];
+			context.invalidateSectionDates = YES;
+			[self.timedEventsView.collectionViewLayout invalidateLayoutWithContext:context];
+			
 			CGFloat newXOffset = -diff * self.dayColumnSize.width + self.controllingScrollView.contentOffset.x;
 			[self.controllingScrollView setContentOffset:CGPointMake(newXOffset, self.controllingScrollView.contentOffset.y)];
 			return YES;
@@ -2215,6 +2428,9 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 		self.allDayEventsView.scrollEnabled = YES;
 		self.controllingScrollView = nil;
 		
+		// the landing page is displayed now, or about to be
+		self.prefetchedDays = nil;
+		
 		if (self.scrollViewAnimationCompletionBlock) {
 			dispatch_async(dispatch_get_main_queue(), self.scrollViewAnimationCompletionBlock);
 			self.scrollViewAnimationCompletionBlock =  nil;
@@ -2254,6 +2470,52 @@ static const CGFloat kMaxHourSlotHeight = 150.;
 	}
 }
 
+// asks the delegate to prefetch events for the page that will be displayed when the timed events view
+// stops scrolling at given horizontal offset.
+// fast swipes are often followed by another one, so in that case we also prefetch the next page
+// in the direction of the movement.
+- (void)prefetchEventsForContentOffset:(CGFloat)xOffset velocity:(CGFloat)velocity
+{
+	NSInteger section = roundf(xOffset / self.dayColumnSize.width);
+	NSDate *start = [self dateFromDayOffset:section];
+	
+	NSDateComponents *comps = [NSDateComponents new];
+	comps.day = self.numberOfVisibleDays;
+	NSDate *end = [self.calendar dateByAddingComponents:comps toDate:start options:0];
+	
+	MGCDateRange *range = [MGCDateRange dateRangeWithStart:start end:end];
+	
+	if (velocity >= kPrefetchLookAheadVelocity) {
+		range.end = [self.calendar dateByAddingComponents:comps toDate:end options:0];
+	}
+	else if (velocity <= -kPrefetchLookAheadVelocity) {
+		comps.day = -self.numberOfVisibleDays;
+		range.start = [self.calendar dateByAddingComponents:comps toDate:start options:0];
+	}
+	
+	if (self.dateRange) {
+		[range intersectDateRange:self.dateRange];
+	}
+	
+	[self prefetchEventsInRange:range];
+}
+
+// tells the delegate about the new range of days to prefetch, after cancelling the previous one if it changed
+- (void)prefetchEventsInRange:(MGCDateRange*)range
+{
+	if ([range isEqual:self.prefetchedDays]) return;
+	
+	if (self.prefetchedDays && [self.delegate respondsToSelector:@selector(dayPlannerView:cancelPrefetchingEventsInRange:)]) {
+		[self.delegate dayPlannerView:self cancelPrefetchingEventsInRange:self.prefetchedDays];
+	}
+	self.prefetchedDays = nil;
+	
+	if (!range.isEmpty && [self.delegate respondsToSelector:@selector(dayPlannerView:prefetchEventsInRange:)]) {
+		self.prefetchedDays = range;
+		[self.delegate dayPlannerView:self prefetchEventsInRange:range];
+	}
+}
+
 - (void)updateVisibleDaysRange
 {
 	MGCDateRange *oldRange = self.previousVisibleDays;
@@ -2360,6 +2622,9 @@ static const CGFloat kMaxHourSlotHeight = 150.;
         
     xOffset = fminf(fmax(xOffset, 0), scrollView.contentSize.width - scrollView.bounds.size.width);
     targetContentOffset->x = xOffset;
+    
+    // give the delegate a chance to load the landing page while decelerating
+    [self prefetchEventsForContentOffset:xOffset velocity:velocity.x];
 }
 
 
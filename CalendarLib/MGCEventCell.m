@@ -52,6 +52,9 @@
 		
 		_eventView = eventView;
 		_eventView.visibleHeight = self.visibleHeight;
+		
+		// layout attributes were already applied, so the size of the content is known
+		[_eventView renderContentInBackgroundWithSize:self.bounds.size];
 	}
 }
 
@@ -0,0 +1,67 @@
+//
+//  MGCEventDescriptorArray.h
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import "MGCDayPlannerView.h"
+
+
+// Compact description of an event, as provided in bulk by the data source of a day planner view.
+typedef struct {
+	MGCEventType type;			// all-day or timed event
+	NSTimeInterval start;		// start of the event, in seconds since the reference date
+	NSTimeInterval end;			// end of the event (excluding), in seconds since the reference date
+	NSUInteger identifier;		// identifier of the event supplied by the data source, stable across reloads: the same event
+								// (or occurrence of a recurring event) must get the same identifier each time its day is reloaded
+} MGCEventDescriptor;
+
+NS_INLINE MGCEventDescriptor MGCEventDescriptorMake(MGCEventType type, NSDate *start, NSDate *end, NSUInteger identifier)
+{
+	MGCEventDescriptor descriptor = { type, start.timeIntervalSinceReferenceDate, end.timeIntervalSinceReferenceDate, identifier };
+	return descriptor;
+}
+
+
+// Immutable, packed array of event descriptors for one day.
+// Descriptors are grouped by type on creation, keeping their relative order, so that
+// the index of an event of a given type is the one used by the rest of the data source protocol.
+@interface MGCEventDescriptorArray : NSObject<NSCopying>
+
+@property (nonatomic, readonly) NSUInteger count;	// total number of events
+
++ (instancetype)arrayWithDescriptors:(const MGCEventDescriptor*)descriptors count:(NSUInteger)count;
+- (instancetype)initWithDescriptors:(const MGCEventDescriptor*)descriptors count:(NSUInteger)count;
+
+- (NSUInteger)numberOfEventsOfType:(MGCEventType)type;
+
+// returns a pointer to the contiguous descriptors of events of given type, valid as long as the array is alive
+- (const MGCEventDescriptor*)descriptorsOfType:(MGCEventType)type;
+- (MGCEventDescriptor)descriptorOfType:(MGCEventType)type atIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,105 @@
+//
+//  MGCEventDescriptorArray.m
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import "MGCEventDescriptorArray.h"
+
+
+@interface MGCEventDescriptorArray ()
+
+@property (nonatomic) NSData *data;				// all-day events descriptors, followed by timed events descriptors
+@property (nonatomic) NSUInteger allDayCount;	// number of all-day events
+
+@end
+
+
+@implementation MGCEventDescriptorArray
+
++ (instancetype)arrayWithDescriptors:(const MGCEventDescriptor*)descriptors count:(NSUInteger)count
+{
+	return [[self alloc] initWithDescriptors:descriptors count:count];
+}
+
+- (instancetype)initWithDescriptors:(const MGCEventDescriptor*)descriptors count:(NSUInteger)count
+{
+	if (self = [super init]) {
+		for (NSUInteger i = 0; i < count; i++) {
+			if (descriptors[i].type == MGCAllDayEventType) _allDayCount++;
+		}
+		
+		// stable partition: all-day events first, then timed events
+		NSMutableData *data = [NSMutableData dataWithLength:count * sizeof(MGCEventDescriptor)];
+		MGCEventDescriptor *packed = data.mutableBytes;
+		NSUInteger allDay = 0, timed = _allDayCount;
+		for (NSUInteger i = 0; i < count; i++) {
+			if (descriptors[i].type == MGCAllDayEventType) {
+				packed[allDay++] = descriptors[i];
+			}
+			else {
+				packed[timed++] = descriptors[i];
+			}
+		}
+		
+		_data = data;
+		_count = count;
+	}
+	return self;
+}
+
+- (NSUInteger)numberOfEventsOfType:(MGCEventType)type
+{
+	return type == MGCAllDayEventType ? self.allDayCount : self.count - self.allDayCount;
+}
+
+- (const MGCEventDescriptor*)descriptorsOfType:(MGCEventType)type
+{
+	const MGCEventDescriptor *descriptors = self.data.bytes;
+	return type == MGCAllDayEventType ? descriptors : descriptors + self.allDayCount;
+}
+
+- (MGCEventDescriptor)descriptorOfType:(MGCEventType)type atIndex:(NSUInteger)index
+{
+	NSAssert(index < [self numberOfEventsOfType:type], @"descriptorOfType:atIndex: index %lu out of bounds", (unsigned long)index);
+	
+	return [self descriptorsOfType:type][index];
+}
+
+#pragma mark - NSObject
+
+- (id)copyWithZone:(NSZone*)zone
+{
+	return self;	// immutable
+}
+
+- (NSString*)description
+{
+	return [NSString stringWithFormat:@"<%@: %p> %lu all-day events, %lu timed events", NSStringFromClass(self.class), self, (unsigned long)self.allDayCount, (unsigned long)(self.count - self.allDayCount)];
+}
+
+@end
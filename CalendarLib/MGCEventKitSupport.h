@@ -30,12 +30,13 @@
 
 
 #import <EventKitUI/EventKitUI.h>
+#import "MGCEventSource.h"
 
 
 typedef void(^EventSaveCompletionBlockType)(BOOL);
 
 
-@interface MGCEventKitSupport : NSObject
+@interface MGCEventKitSupport : NSObject<MGCEventSource>
 
 @property (nonatomic, readonly) EKEventStore *eventStore;
 @property (nonatomic, readonly) BOOL accessGranted;
@@ -138,6 +138,21 @@
     }
 }
 
+#pragma mark - MGCEventSource
+
+- (NSArray*)eventsFrom:(NSDate*)startDate to:(NSDate*)endDate calendars:(NSArray*)calendars
+{
+    if (self.accessGranted) {
+        NSPredicate *predicate = [self.eventStore predicateForEventsWithStartDate:startDate endDate:endDate calendars:calendars];
+        NSArray *events = [self.eventStore eventsMatchingPredicate:predicate];
+        if (events) {
+            return [events sortedArrayUsingSelector:@selector(compareStartDateWithEvent:)];
+        }
+    }
+    
+    return [NSArray array];
+}
+
 #pragma mark - UIAlertViewDelegate
 
 // Called when a button is clicked. The view will be automatically dismissed after this call returns
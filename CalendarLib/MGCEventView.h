@@ -71,4 +71,39 @@
  */
 - (void)didTransitionToEventType:(MGCEventType)toType;
 
+/*! @brief		Whether the content of the view can be rendered on a background queue.
+ *	@discussion	When set, the day planner view asks the view to render its content as soon as the size
+ *				of its cell is known, and the bitmap is drawn instead of the content once it is ready.
+ *				Until then, the view draws synchronously as usual.
+ *				This only has an effect for subclasses which implement contentForBackgroundRenderingWithSize:
+ *				and drawBackgroundRenderingContent:inRect:, and call drawRenderedContentInRect: in drawRect:.
+ *				The default value is NO.
+ */
+@property (nonatomic) BOOL rendersInBackground;
+
+/*! @brief		Returns an immutable object describing everything drawn by the view for given size,
+ *				or nil if the content can't be rendered in background.
+ *	@discussion	The object is used as a key in a bitmap cache shared by all event views, so it must
+ *				implement isEqual: and hash.
+ *				The default implementation returns nil.
+ */
+- (id)contentForBackgroundRenderingWithSize:(CGSize)size;
+
+/*! @brief		Draws content returned by contentForBackgroundRenderingWithSize: in the current graphics context.
+ *	@discussion	This is called on a background queue, and must not access any view.
+ *				The default implementation does nothing.
+ */
++ (void)drawBackgroundRenderingContent:(id)content inRect:(CGRect)rect;
+
+/*! @brief		Starts rendering the content of the view for given size on a background queue, unless it is
+ *				already cached or being rendered. Does nothing if rendersInBackground is NO.
+ */
+- (void)renderContentInBackgroundWithSize:(CGSize)size;
+
+/*! @brief		Draws the bitmap rendered in background for the current content and bounds of the view, if it is ready.
+ *	@discussion	Subclasses supporting background rendering call this at the start of drawRect:, and draw
+ *				their content synchronously only when it returns NO.
+ */
+- (BOOL)drawRenderedContentInRect:(CGRect)rect;
+
 @end
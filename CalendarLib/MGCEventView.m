@@ -31,8 +31,76 @@
 #import "MGCEventView.h"
 
 
+static const NSUInteger kRenderedContentCacheSize = 24 * 1024 * 1024;	// maximum size in bytes of the bitmaps rendered in background
+
+
+// key of a rendered bitmap
+@interface MGCRenderedContentKey : NSObject
+
+@property (nonatomic) Class viewClass;
+@property (nonatomic) id content;
+@property (nonatomic) CGSize size;
+
+@end
+
+
+@implementation MGCRenderedContentKey
+
+- (BOOL)isEqual:(id)object
+{
+	if (self == object) return YES;
+	if (![object isKindOfClass:[MGCRenderedContentKey class]]) return NO;
+	
+	MGCRenderedContentKey *key = object;
+	return self.viewClass == key.viewClass && CGSizeEqualToSize(self.size, key.size) && [self.content isEqual:key.content];
+}
+
+- (NSUInteger)hash
+{
+	return [self.content hash] ^ ((NSUInteger)self.size.width << 16) ^ (NSUInteger)self.size.height;
+}
+
+@end
+
+
 @implementation MGCEventView
 
+// bitmaps rendered in background, shared by all event views
++ (NSCache*)renderedContentCache
+{
+	static NSCache *cache;
+	static dispatch_once_t onceToken;
+	
+	dispatch_once(&onceToken, ^{
+		cache = [NSCache new];
+		cache.totalCostLimit = kRenderedContentCacheSize;
+	});
+	return cache;
+}
+
+// keys of the bitmaps being rendered - only accessed on the main thread
++ (NSMutableSet*)pendingRenderingKeys
+{
+	static NSMutableSet *keys;
+	static dispatch_once_t onceToken;
+	
+	dispatch_once(&onceToken, ^{
+		keys = [NSMutableSet set];
+	});
+	return keys;
+}
+
++ (dispatch_queue_t)renderingQueue
+{
+	static dispatch_queue_t queue;
+	static dispatch_once_t onceToken;
+	
+	dispatch_once(&onceToken, ^{
+		queue = dispatch_queue_create("com.mgc.eventview.rendering", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0));
+	});
+	return queue;
+}
+
 - (instancetype)initWithFrame:(CGRect)frame
 {
     if (self = [super initWithFrame:frame]) {
@@ -53,6 +121,78 @@
 {
 }
 
+#pragma mark - Background rendering
+
+// if needed, implement in subclasses
+- (id)contentForBackgroundRenderingWithSize:(CGSize)size
+{
+	return nil;
+}
+
+// if needed, implement in subclasses
++ (void)drawBackgroundRenderingContent:(id)content inRect:(CGRect)rect
+{
+}
+
+- (MGCRenderedContentKey*)renderedContentKeyForSize:(CGSize)size
+{
+	id content = [self contentForBackgroundRenderingWithSize:size];
+	if (!content || size.width <= 0 || size.height <= 0) return nil;
+	
+	MGCRenderedContentKey *key = [MGCRenderedContentKey new];
+	key.viewClass = [self class];
+	key.content = content;
+	key.size = size;
+	return key;
+}
+
+- (void)renderContentInBackgroundWithSize:(CGSize)size
+{
+	if (!self.rendersInBackground) return;
+	
+	MGCRenderedContentKey *key = [self renderedContentKeyForSize:size];
+	if (!key) return;
+	
+	NSCache *cache = [MGCEventView renderedContentCache];
+	NSMutableSet *pendingKeys = [MGCEventView pendingRenderingKeys];
+	if ([cache objectForKey:key] || [pendingKeys containsObject:key]) return;
+	
+	[pendingKeys addObject:key];
+	
+	CGFloat scale = self.window.screen.scale ?: [UIScreen mainScreen].scale;
+	
+	dispatch_async([MGCEventView renderingQueue], ^{
+		UIGraphicsBeginImageContextWithOptions(size, NO, scale);
+		[key.viewClass drawBackgroundRenderingContent:key.content inRect:CGRectMake(0, 0, size.width, size.height)];
+		UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+		UIGraphicsEndImageContext();
+		
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[pendingKeys removeObject:key];
+			// no need to redraw a view which was not drawn yet, or was drawn synchronously with the same content
+			if (image) {
+				[cache setObject:image forKey:key cost:size.width * size.height * scale * scale * 4];
+			}
+		});
+	});
+}
+
+- (BOOL)drawRenderedContentInRect:(CGRect)rect
+{
+	if (!self.rendersInBackground) return NO;
+	
+	MGCRenderedContentKey *key = [self renderedContentKeyForSize:self.bounds.size];
+	UIImage *image = key ? [[MGCEventView renderedContentCache] objectForKey:key] : nil;
+	if (!image) {
+		// render it for the next time this content is displayed
+		[self renderContentInBackgroundWithSize:self.bounds.size];
+		return NO;
+	}
+	
+	[image drawInRect:self.bounds];
+	return YES;
+}
+
 #pragma mark - NSCopying protocol
 
 - (id)copyWithZone:(NSZone*)zone
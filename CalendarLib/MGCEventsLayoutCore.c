@@ -0,0 +1,672 @@
+//
+//  MGCEventsLayoutCore.c
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#include "MGCEventsLayoutCore.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+
+static const MGCLayoutFloat kOverlapOffset = 4.;  // horizontal shift of a cell covering another one (classic covering)
+
+
+// MARK: - Geometry
+
+static MGCLayoutRect MGCLayoutStandardizedRect(MGCLayoutRect rect)
+{
+    if (rect.width < 0) {
+        rect.x += rect.width;
+        rect.width = -rect.width;
+    }
+    if (rect.height < 0) {
+        rect.y += rect.height;
+        rect.height = -rect.height;
+    }
+    return rect;
+}
+
+bool MGCLayoutRectIntersectsRect(MGCLayoutRect rect1, MGCLayoutRect rect2)
+{
+    rect1 = MGCLayoutStandardizedRect(rect1);
+    rect2 = MGCLayoutStandardizedRect(rect2);
+    
+    return rect1.x < rect2.x + rect2.width && rect2.x < rect1.x + rect1.width &&
+           rect1.y < rect2.y + rect2.height && rect2.y < rect1.y + rect1.height;
+}
+
+MGCLayoutFloat MGCLayoutFloorToPixel(MGCLayoutFloat f, MGCLayoutFloat scale)
+{
+    return floorf(f * scale) / scale;
+}
+
+MGCLayoutFloat MGCLayoutCeilToPixel(MGCLayoutFloat f, MGCLayoutFloat scale)
+{
+    return ceilf(f * scale) / scale;
+}
+
+MGCLayoutFloat MGCLayoutRoundToPixel(MGCLayoutFloat f, MGCLayoutFloat scale)
+{
+    return roundf(f * scale) / scale;
+}
+
+MGCLayoutRect MGCLayoutAlignedRect(MGCLayoutRect rect, MGCLayoutFloat scale)
+{
+    return MGCLayoutRectMake(MGCLayoutFloorToPixel(rect.x, scale), MGCLayoutFloorToPixel(rect.y, scale), MGCLayoutCeilToPixel(rect.width, scale), MGCLayoutCeilToPixel(rect.height, scale));
+}
+
+static MGCLayoutRect MGCLayoutAlignedRectMake(MGCLayoutFloat x, MGCLayoutFloat y, MGCLayoutFloat width, MGCLayoutFloat height, MGCLayoutFloat scale)
+{
+    return MGCLayoutAlignedRect(MGCLayoutRectMake(x, y, width, height), scale);
+}
+
+
+// MARK: - Heaps
+
+// Column occupied by an event until the given end position
+typedef struct {
+    MGCLayoutFloat end;
+    size_t column;
+} MGCActiveColumn;
+
+static void MGCActiveColumnsPush(MGCActiveColumn *heap, size_t *count, MGCActiveColumn value)
+{
+    size_t i = (*count)++;
+    while (i > 0 && heap[(i - 1) / 2].end > value.end) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = value;
+}
+
+static MGCActiveColumn MGCActiveColumnsPop(MGCActiveColumn *heap, size_t *count)
+{
+    MGCActiveColumn top = heap[0];
+    MGCActiveColumn last = heap[--(*count)];
+    size_t i = 0;
+    while (2 * i + 1 < *count) {
+        size_t child = 2 * i + 1;
+        if (child + 1 < *count && heap[child + 1].end < heap[child].end) {
+            child++;
+        }
+        if (heap[child].end >= last.end) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*count > 0) {
+        heap[i] = last;
+    }
+    return top;
+}
+
+static void MGCFreeColumnsPush(size_t *heap, size_t *count, size_t column)
+{
+    size_t i = (*count)++;
+    while (i > 0 && heap[(i - 1) / 2] > column) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = column;
+}
+
+static size_t MGCFreeColumnsPop(size_t *heap, size_t *count)
+{
+    size_t top = heap[0];
+    size_t last = heap[--(*count)];
+    size_t i = 0;
+    while (2 * i + 1 < *count) {
+        size_t child = 2 * i + 1;
+        if (child + 1 < *count && heap[child + 1] < heap[child]) {
+            child++;
+        }
+        if (heap[child] >= last) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*count > 0) {
+        heap[i] = last;
+    }
+    return top;
+}
+
+
+// MARK: - Timed events
+
+// stable sort of cells by y-position
+static void MGCSortCellsByPosition(MGCEventCellLayout *cells, MGCEventCellLayout *buffer, size_t count)
+{
+    if (count < 2) return;
+    
+    size_t half = count / 2;
+    MGCSortCellsByPosition(cells, buffer, half);
+    MGCSortCellsByPosition(cells + half, buffer, count - half);
+    
+    if (cells[half - 1].frame.y <= cells[half].frame.y) return;
+    
+    memcpy(buffer, cells, half * sizeof(MGCEventCellLayout));
+    size_t i = 0, j = half, k = 0;
+    while (i < half && j < count) {
+        cells[k++] = (cells[j].frame.y < buffer[i].frame.y) ? cells[j++] : buffer[i++];
+    }
+    while (i < half) {
+        cells[k++] = buffer[i++];
+    }
+}
+
+bool MGCLayoutAssignColumns(const MGCEventSpan *spans, size_t count, size_t *columns, size_t *columnCounts)
+{
+    if (count == 0) return true;
+    
+    // a min-heap keeps the end positions of busy columns, and another one the indexes of the columns
+    // freed since the cluster started, so that this runs in O(n log n)
+    MGCActiveColumn *active = malloc(count * sizeof(MGCActiveColumn));
+    size_t *freeColumns = malloc(count * sizeof(size_t));
+    if (!active || !freeColumns) {
+        free(active);
+        free(freeColumns);
+        return false;
+    }
+    size_t activeCount = 0, freeCount = 0, numColumns = 0;
+    size_t clusterStart = 0;
+    MGCLayoutFloat clusterEnd = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        const MGCEventSpan span = spans[i];
+        
+        if (i > 0 && span.start >= clusterEnd) {
+            // no event of the current cluster overlaps this one: close the cluster
+            for (size_t j = clusterStart; j < i; j++) {
+                columnCounts[j] = numColumns;
+            }
+            clusterStart = i;
+            activeCount = freeCount = numColumns = 0;
+        }
+        
+        while (activeCount > 0 && active[0].end <= span.start) {
+            MGCFreeColumnsPush(freeColumns, &freeCount, MGCActiveColumnsPop(active, &activeCount).column);
+        }
+        
+        size_t column = freeCount > 0 ? MGCFreeColumnsPop(freeColumns, &freeCount) : numColumns++;
+        MGCActiveColumnsPush(active, &activeCount, (MGCActiveColumn){ span.end, column });
+        columns[i] = column;
+        
+        clusterEnd = (i == clusterStart) ? span.end : fmax(clusterEnd, span.end);
+    }
+    
+    for (size_t j = clusterStart; j < count; j++) {
+        columnCounts[j] = numColumns;
+    }
+    
+    free(active);
+    free(freeColumns);
+    return true;
+}
+
+// Complex covering: overlapping events are split evenly into columns
+static bool MGCLayoutComplexCovering(MGCEventCellLayout *cells, MGCEventCellPlacement *placements, size_t count, const MGCTimedEventsLayoutParams *params)
+{
+    if (count == 0) return true;
+    
+    MGCEventSpan *spans = malloc(count * sizeof(MGCEventSpan));
+    size_t *columns = malloc(count * sizeof(size_t));
+    size_t *columnCounts = malloc(count * sizeof(size_t));
+    if (!spans || !columns || !columnCounts) {
+        free(spans);
+        free(columns);
+        free(columnCounts);
+        return false;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        MGCLayoutRect frame = MGCLayoutStandardizedRect(cells[i].frame);
+        spans[i] = (MGCEventSpan){ frame.y, frame.y + frame.height, i };
+    }
+    
+    bool success = MGCLayoutAssignColumns(spans, count, columns, columnCounts);
+    
+    MGCLayoutFloat totalWidth = params->columnWidth - 2.f;
+    
+    for (size_t i = 0; i < count && success; i++) {
+        MGCLayoutRect frame = cells[i].frame;
+        MGCLayoutFloat colWidth = totalWidth / columnCounts[i];
+        cells[i].frame = MGCLayoutAlignedRectMake(frame.x + columns[i] * colWidth, frame.y, colWidth, frame.height, params->scale);
+        
+        placements[i].offset = 0;
+        placements[i].slot = columns[i];
+        placements[i].slotCount = columnCounts[i];
+    }
+    
+    free(spans);
+    free(columns);
+    free(columnCounts);
+    return success;
+}
+
+// Classic covering: an event starting more than minimumVisibleHeight below an overlapping one covers it,
+// and is shifted right to the first kOverlapOffset slot not used by the cells it covers. Events starting
+// closer than that share the remaining width.
+// Only the events still running at the start of the current one are kept in the active set, so the cost
+// is O(n.k) where k is the maximum number of simultaneous events, instead of O(n^2).
+static bool MGCLayoutClassicCovering(MGCEventCellLayout *cells, MGCEventCellPlacement *placements, size_t count, const MGCTimedEventsLayoutParams *params)
+{
+    if (count == 0) return true;
+    
+    size_t *active = malloc(count * sizeof(size_t));    // running events, in ascending order
+    size_t *group = malloc(count * sizeof(size_t));     // events sharing the width with the current one
+    uint64_t *slots = malloc((count / 64 + 1) * sizeof(uint64_t));   // bitmap of slots used by covered events
+    if (!active || !group || !slots) {
+        free(active);
+        free(group);
+        free(slots);
+        return false;
+    }
+    size_t activeCount = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        const MGCLayoutRect frame = cells[i].frame;
+        
+        // events ending above this one cannot overlap any of the next ones either
+        size_t keptCount = 0;
+        for (size_t k = 0; k < activeCount; k++) {
+            MGCLayoutRect activeFrame = MGCLayoutStandardizedRect(cells[active[k]].frame);
+            if (activeFrame.y + activeFrame.height >= frame.y) {
+                active[keptCount++] = active[k];
+            }
+        }
+        activeCount = keptCount;
+        
+        // a covered event can only use one slot, so the first free slot is at most activeCount
+        memset(slots, 0, (activeCount / 64 + 1) * sizeof(uint64_t));
+        size_t groupCount = 0, coveredCount = 0;
+        
+        // iterate previous frames (i.e with highest or equal y-pos)
+        for (size_t k = activeCount; k-- > 0;) {
+            MGCEventCellLayout *covered = &cells[active[k]];
+            
+            if (MGCLayoutRectIntersectsRect(frame, covered->frame)) {
+                MGCLayoutFloat visibleHeight = fabs(frame.y - covered->frame.y);
+                
+                if (visibleHeight > params->minimumVisibleHeight) {
+                    covered->visibleHeight = visibleHeight;
+                    cells[i].zIndex = covered->zIndex + 1;
+                    coveredCount++;
+                    
+                    MGCLayoutFloat offset = covered->frame.x - params->columnX;
+                    if (offset >= 0 && offset <= activeCount * kOverlapOffset) {
+                        size_t slot = offset / kOverlapOffset;
+                        if (slot * kOverlapOffset == offset) {
+                            slots[slot / 64] |= 1ULL << (slot % 64);
+                        }
+                    }
+                }
+                else {
+                    group[groupCount++] = active[k];
+                }
+            }
+        }
+        
+        // now, distribute elements in layout group
+        MGCLayoutFloat groupOffset = 0;
+        if (coveredCount > 0) {
+            size_t word = 0;
+            while (slots[word] == UINT64_MAX) {
+                word++;
+            }
+            size_t slotNumber = word * 64;
+            for (uint64_t bits = slots[word]; bits & 1; bits >>= 1) {
+                slotNumber++;
+            }
+            groupOffset = slotNumber * kOverlapOffset;
+        }
+        
+        MGCLayoutFloat totalWidth = (params->columnWidth - 1.) - groupOffset;
+        MGCLayoutFloat colWidth = totalWidth / (groupCount + 1);
+        
+        MGCLayoutFloat x = params->columnX + groupOffset;
+        
+        for (size_t k = groupCount; k-- > 0;) {
+            MGCLayoutRect groupFrame = cells[group[k]].frame;
+            cells[group[k]].frame = MGCLayoutAlignedRectMake(x, groupFrame.y, colWidth, groupFrame.height, params->scale);
+            x += colWidth;
+            
+            placements[group[k]].offset = groupOffset;
+            placements[group[k]].slot = groupCount - 1 - k;
+            placements[group[k]].slotCount = groupCount + 1;
+        }
+        cells[i].frame = MGCLayoutAlignedRectMake(x, frame.y, colWidth, frame.height, params->scale);
+        
+        placements[i].offset = groupOffset;
+        placements[i].slot = groupCount;
+        placements[i].slotCount = groupCount + 1;
+        
+        active[activeCount++] = i;
+    }
+    
+    free(active);
+    free(group);
+    free(slots);
+    return true;
+}
+
+// lays out the events in cells, and records the horizontal placement decided by the covering in placements
+static bool MGCLayoutTimedEventsWithPlacements(const MGCEventSpan *spans, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellLayout *cells, MGCEventCellPlacement *placements)
+{
+    MGCEventCellLayout *buffer = malloc((count / 2 + 1) * sizeof(MGCEventCellLayout));
+    if (!buffer) return false;
+    
+    for (size_t i = 0; i < count; i++) {
+        MGCLayoutFloat height = fmax(params->minimumVisibleHeight, spans[i].end - spans[i].start);
+        
+        // cells are inset by 1 point vertically
+        MGCLayoutRect frame = MGCLayoutAlignedRectMake(params->columnX, spans[i].start + 1, params->columnWidth, height - 2, params->scale);
+        cells[i] = (MGCEventCellLayout){ frame, frame.height, 1, spans[i].index };
+    }
+    
+    MGCSortCellsByPosition(cells, buffer, count);
+    free(buffer);
+    
+    bool success;
+    if (params->covering == MGCEventCoveringClassic) {
+        success = MGCLayoutClassicCovering(cells, placements, count, params);
+    }
+    else {
+        success = MGCLayoutComplexCovering(cells, placements, count, params);
+    }
+    if (!success) return false;
+    
+    for (size_t i = 0; i < count; i++) {
+        placements[i].y = cells[i].frame.y;
+        placements[i].height = cells[i].frame.height;
+        placements[i].visibleHeight = cells[i].visibleHeight;
+        placements[i].zIndex = cells[i].zIndex;
+        placements[i].index = cells[i].index;
+    }
+    return true;
+}
+
+bool MGCLayoutTimedEvents(const MGCEventSpan *spans, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellLayout *cells)
+{
+    if (count == 0) return true;
+    
+    MGCEventCellPlacement *placements = malloc(count * sizeof(MGCEventCellPlacement));
+    if (!placements) return false;
+    
+    bool success = MGCLayoutTimedEventsWithPlacements(spans, count, params, cells, placements);
+    free(placements);
+    return success;
+}
+
+bool MGCLayoutPlaceTimedEvents(const MGCEventSpan *spans, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellPlacement *placements)
+{
+    if (count == 0) return true;
+    
+    MGCEventCellLayout *cells = malloc(count * sizeof(MGCEventCellLayout));
+    if (!cells) return false;
+    
+    bool success = MGCLayoutTimedEventsWithPlacements(spans, count, params, cells, placements);
+    free(cells);
+    return success;
+}
+
+void MGCLayoutFrameTimedEvents(const MGCEventCellPlacement *placements, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellLayout *cells)
+{
+    if (count == 0) return;
+    
+    for (size_t i = 0; i < count; i++) {
+        const MGCEventCellPlacement placement = placements[i];
+        MGCLayoutFloat x, colWidth;
+        
+        // computed exactly as in the covering functions, so that frames are the same
+        if (params->covering == MGCEventCoveringClassic) {
+            MGCLayoutFloat totalWidth = (params->columnWidth - 1.) - placement.offset;
+            colWidth = totalWidth / placement.slotCount;
+            x = params->columnX + placement.offset;
+            for (size_t slot = 0; slot < placement.slot; slot++) {
+                x += colWidth;
+            }
+        }
+        else {
+            MGCLayoutFloat totalWidth = params->columnWidth - 2.f;
+            colWidth = totalWidth / placement.slotCount;
+            x = MGCLayoutFloorToPixel(params->columnX, params->scale) + placement.slot * colWidth;
+        }
+        
+        MGCLayoutRect frame = MGCLayoutAlignedRectMake(x, placement.y, colWidth, placement.height, params->scale);
+        cells[i] = (MGCEventCellLayout){ frame, placement.visibleHeight, placement.zIndex, placement.index };
+    }
+}
+
+bool MGCLayoutCanReusePlacements(const MGCTimedEventsLayoutParams *placedParams, const MGCTimedEventsLayoutParams *params)
+{
+    if (placedParams->covering != params->covering || placedParams->minimumVisibleHeight != params->minimumVisibleHeight || placedParams->scale != params->scale) {
+        return false;
+    }
+    if (params->covering == MGCEventCoveringClassic) {
+        return placedParams->columnX == params->columnX && placedParams->columnWidth == params->columnWidth;
+    }
+    return true;
+}
+
+
+// MARK: - All-day events
+
+// Sparse table answering the maximum of an array over any range in constant time,
+// after an O(n log n) build: row k holds the maxima over the ranges of 2^k values.
+typedef struct {
+    size_t *rows;
+    size_t count;
+} MGCRangeMaxTable;
+
+static size_t MGCLog2(size_t n)
+{
+    size_t log = 0;
+    while (n >>= 1) log++;
+    return log;
+}
+
+static bool MGCRangeMaxTableInit(MGCRangeMaxTable *table, const size_t *values, size_t count)
+{
+    size_t numRows = count > 0 ? MGCLog2(count) + 1 : 1;
+    table->rows = malloc(numRows * (count > 0 ? count : 1) * sizeof(size_t));
+    table->count = count;
+    if (!table->rows) return false;
+    
+    memcpy(table->rows, values, count * sizeof(size_t));
+    for (size_t k = 1; k < numRows; k++) {
+        const size_t *prev = table->rows + (k - 1) * count;
+        size_t *row = table->rows + k * count;
+        size_t half = (size_t)1 << (k - 1);
+        for (size_t i = 0; i + 2 * half <= count; i++) {
+            row[i] = prev[i] > prev[i + half] ? prev[i] : prev[i + half];
+        }
+    }
+    return true;
+}
+
+// maximum of the values in [location, location + length[, or 0 if length is 0
+static size_t MGCRangeMaxTableQuery(const MGCRangeMaxTable *table, size_t location, size_t length)
+{
+    if (length == 0) return 0;
+    
+    size_t k = MGCLog2(length);
+    const size_t *row = table->rows + k * table->count;
+    size_t a = row[location], b = row[location + length - ((size_t)1 << k)];
+    return a > b ? a : b;
+}
+
+// Lines of the layout when ranges come sorted by first day: as a range can only collide with the last one
+// placed on a line, a line is fully described by its first free day. These are kept in a min segment tree,
+// so that the first line where a range fits is found in log time. Lines that are not used yet are free from day 0.
+typedef struct {
+    size_t *tree;       // tree[1] is the root, leaves start at tree[size]
+    size_t size;        // number of leaves, a power of 2
+} MGCLineTable;
+
+static bool MGCLineTableInit(MGCLineTable *table, size_t maxNumberOfLines)
+{
+    table->size = 1;
+    while (table->size < maxNumberOfLines) table->size <<= 1;
+    table->tree = calloc(2 * table->size, sizeof(size_t));
+    return table->tree != NULL;
+}
+
+static size_t MGCLineTableInsert(MGCLineTable *table, MGCDayRange range)
+{
+    if (range.length == 0) return 0;
+    
+    // leftmost leaf whose first free day is not after the start of range
+    size_t node = 1;
+    while (node < table->size) {
+        node = table->tree[2 * node] <= range.location ? 2 * node : 2 * node + 1;
+    }
+    size_t line = node - table->size;
+    
+    table->tree[node] = range.location + range.length;
+    for (node /= 2; node > 0; node /= 2) {
+        size_t left = table->tree[2 * node], right = table->tree[2 * node + 1];
+        table->tree[node] = left < right ? left : right;
+    }
+    return line;
+}
+
+// Lines of the layout for ranges in any order: a grid of occupied days, searched line by line.
+typedef struct {
+    bool *occupied;     // numLines rows of numberOfDays flags
+    size_t numLines;
+    size_t numberOfDays;
+} MGCLineGrid;
+
+// returns MGCLayoutHiddenLine if a new line is needed and cannot be allocated
+static size_t MGCLineGridInsert(MGCLineGrid *grid, MGCDayRange range)
+{
+    size_t numLine = 0;
+    for (; numLine < grid->numLines; numLine++) {
+        const bool *row = grid->occupied + numLine * grid->numberOfDays;
+        bool fits = true;
+        for (size_t day = range.location; day < range.location + range.length && fits; day++) {
+            fits = !row[day];
+        }
+        if (fits) break;
+    }
+    
+    if (numLine == grid->numLines) {
+        // this means no line was yet created, or the event does not fit any
+        bool *occupied = realloc(grid->occupied, (grid->numLines + 1) * grid->numberOfDays * sizeof(bool));
+        if (!occupied) return MGCLayoutHiddenLine;
+        
+        grid->occupied = occupied;
+        grid->numLines++;
+        memset(grid->occupied + numLine * grid->numberOfDays, 0, grid->numberOfDays * sizeof(bool));
+    }
+    for (size_t day = range.location; day < range.location + range.length; day++) {
+        grid->occupied[numLine * grid->numberOfDays + day] = true;
+    }
+    return numLine;
+}
+
+static bool MGCDayRangesAreSorted(const MGCDayRange *ranges, size_t count)
+{
+    size_t location = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ranges[i].length == 0) continue;    // empty ranges always go on the first line
+        if (ranges[i].location < location) return false;
+        location = ranges[i].location;
+    }
+    return true;
+}
+
+size_t MGCLayoutAllDayEvents(const MGCDayRange *ranges, size_t count, const size_t *eventCounts, size_t numberOfDays, size_t maxVisibleLines, size_t *lines, size_t *hiddenCounts)
+{
+    size_t maxLines = 0;
+    
+    // ranges are sorted by first day, except in rare cases where the caller keeps events started on earlier days
+    bool sorted = MGCDayRangesAreSorted(ranges, count);
+    MGCLineTable lineTable = { NULL, 0 };
+    MGCLineGrid lineGrid = { NULL, 0, numberOfDays };
+    bool success = !sorted || MGCLineTableInit(&lineTable, count);
+    
+    MGCRangeMaxTable maxEventCounts;
+    success = MGCRangeMaxTableInit(&maxEventCounts, eventCounts, numberOfDays) && success;
+    
+    // hidden events are counted at their first day, and uncounted after their last one
+    ptrdiff_t *hiddenDeltas = calloc(numberOfDays + 1, sizeof(ptrdiff_t));
+    
+    if (!success || !hiddenDeltas) {
+        // out of memory: all events are hidden behind the indicators
+        for (size_t i = 0; i < count; i++) {
+            lines[i] = MGCLayoutHiddenLine;
+        }
+        memcpy(hiddenCounts, eventCounts, numberOfDays * sizeof(size_t));
+        maxLines = count > 0 ? 1 : 0;
+        
+        free(hiddenDeltas);
+        free(maxEventCounts.rows);
+        free(lineTable.tree);
+        return maxLines;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        const MGCDayRange range = ranges[i];
+        
+        // index of the line where to insert the event
+        size_t numLine = sorted ? MGCLineTableInsert(&lineTable, range) : MGCLineGridInsert(&lineGrid, range);
+        
+        // number of event lines displayed for this day range -
+        // if count > max, we have to keep one row to show "x more events"
+        size_t maxVisibleEvents = MGCRangeMaxTableQuery(&maxEventCounts, range.location, range.length);
+        maxVisibleEvents = maxVisibleEvents > maxVisibleLines ? maxVisibleLines - 1 : maxVisibleEvents;
+        
+        if (numLine < maxVisibleEvents) {
+            lines[i] = numLine;
+            maxLines = numLine + 1 > maxLines ? numLine + 1 : maxLines;
+        }
+        else {
+            lines[i] = MGCLayoutHiddenLine;
+            if (range.length > 0) {
+                hiddenDeltas[range.location]++;
+                hiddenDeltas[range.location + range.length]--;
+                maxLines = maxVisibleEvents + 1;
+            }
+        }
+    }
+    
+    ptrdiff_t hidden = 0;
+    for (size_t day = 0; day < numberOfDays; day++) {
+        hidden += hiddenDeltas[day];
+        hiddenCounts[day] = hidden;
+    }
+    
+    free(hiddenDeltas);
+    free(maxEventCounts.rows);
+    free(lineTable.tree);
+    free(lineGrid.occupied);
+    return maxLines;
+}
@@ -0,0 +1,175 @@
+//
+//  MGCEventsLayoutCore.h
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+// Layout algorithms for the day planner event views, written in plain C so that they
+// do not depend on UIKit and can be tested and profiled on any platform.
+// The collection view layouts (MGCTimedEventsViewLayout, MGCAllDayEventsViewLayout)
+// are thin adapters over these functions.
+
+#ifndef MGCEventsLayoutCore_h
+#define MGCEventsLayoutCore_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __APPLE__
+#include <CoreGraphics/CGBase.h>
+typedef CGFloat MGCLayoutFloat;
+#else
+typedef double MGCLayoutFloat;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// MARK: - Geometry
+
+typedef struct {
+    MGCLayoutFloat x;
+    MGCLayoutFloat y;
+    MGCLayoutFloat width;
+    MGCLayoutFloat height;
+} MGCLayoutRect;
+
+static inline MGCLayoutRect MGCLayoutRectMake(MGCLayoutFloat x, MGCLayoutFloat y, MGCLayoutFloat width, MGCLayoutFloat height)
+{
+    MGCLayoutRect rect = { x, y, width, height };
+    return rect;
+}
+
+// same as CGRectIntersectsRect: rects which only share an edge do not intersect
+bool MGCLayoutRectIntersectsRect(MGCLayoutRect rect1, MGCLayoutRect rect2);
+
+// functions to align coordinates on pixel boundaries for the given screen scale
+MGCLayoutFloat MGCLayoutFloorToPixel(MGCLayoutFloat f, MGCLayoutFloat scale);
+MGCLayoutFloat MGCLayoutCeilToPixel(MGCLayoutFloat f, MGCLayoutFloat scale);
+MGCLayoutFloat MGCLayoutRoundToPixel(MGCLayoutFloat f, MGCLayoutFloat scale);
+MGCLayoutRect MGCLayoutAlignedRect(MGCLayoutRect rect, MGCLayoutFloat scale);
+
+
+// MARK: - Timed events
+
+typedef enum {
+    MGCEventCoveringClassic = 0,    // events starting close together share the width, others cover previous ones with an offset
+    MGCEventCoveringComplex = 1     // overlapping events are split into columns
+} MGCEventCovering;
+
+// Vertical extent of a timed event
+typedef struct {
+    MGCLayoutFloat start;   // y-offset of the start of the event
+    MGCLayoutFloat end;     // y-offset of the end of the event
+    size_t index;           // item index of the event
+} MGCEventSpan;
+
+typedef struct {
+    MGCLayoutFloat columnX;                 // x-origin of the day column
+    MGCLayoutFloat columnWidth;             // width of the day column
+    MGCLayoutFloat minimumVisibleHeight;    // minimum height of a cell, and of the uncovered part of a covered cell
+    MGCLayoutFloat scale;                   // screen scale used to align frames on pixels
+    MGCEventCovering covering;
+} MGCTimedEventsLayoutParams;
+
+typedef struct {
+    MGCLayoutRect frame;
+    MGCLayoutFloat visibleHeight;   // height of the visible portion of the cell
+    long zIndex;
+    size_t index;                   // item index of the event
+} MGCEventCellLayout;
+
+// Position of a cell in its day column, independent of the origin and width of the column.
+// This is what the covering algorithms decide: frames are derived from it, so that the layout of a day
+// can be kept when columns are moved or resized (see MGCLayoutCanReusePlacements).
+typedef struct {
+    MGCLayoutFloat y;               // vertical position of the cell
+    MGCLayoutFloat height;          // height of the cell
+    MGCLayoutFloat visibleHeight;   // height of the visible portion of the cell
+    MGCLayoutFloat offset;          // horizontal shift from the column origin (classic covering)
+    size_t slot;                    // position of the cell among the ones sharing the column width
+    size_t slotCount;               // number of cells sharing the column width
+    long zIndex;
+    size_t index;                   // item index of the event
+} MGCEventCellPlacement;
+
+// Computes the frames of the events of a day column.
+// On return, cells holds count layouts sorted by y-position.
+// Returns false if memory could not be allocated, in which case the content of cells is undefined.
+bool MGCLayoutTimedEvents(const MGCEventSpan *spans, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellLayout *cells);
+
+// Same as MGCLayoutTimedEvents, but returns the placements of the cells (sorted by y-position) instead of their frames.
+// Returns false if memory could not be allocated.
+bool MGCLayoutPlaceTimedEvents(const MGCEventSpan *spans, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellPlacement *placements);
+
+// Computes the frames of placed cells, for the column origin and width given in params (the covering
+// must be the one the placements were computed with, minimumVisibleHeight is not used).
+// With the same params, frames are identical to those returned by MGCLayoutTimedEvents. With another column
+// width, the covering decisions made for the original width are kept.
+void MGCLayoutFrameTimedEvents(const MGCEventCellPlacement *placements, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellLayout *cells);
+
+// Returns true if placements computed with placedParams can be framed with params, giving the same frames
+// as a new layout. Complex covering only depends on the vertical extent of the events. Classic covering also
+// depends on the pixel-aligned positions of the cells in the column, hence on the column origin and width.
+bool MGCLayoutCanReusePlacements(const MGCTimedEventsLayoutParams *placedParams, const MGCTimedEventsLayoutParams *params);
+
+// Splits spans (sorted by start) into clusters of overlapping events, and places each one in the leftmost
+// column of its cluster where it does not overlap the last span placed.
+// On return, columns[i] is the column of spans[i] and columnCounts[i] the number of columns of its cluster.
+// Returns false if memory could not be allocated.
+bool MGCLayoutAssignColumns(const MGCEventSpan *spans, size_t count, size_t *columns, size_t *columnCounts);
+
+
+// MARK: - All-day events
+
+#define MGCLayoutHiddenLine ((size_t)-1)
+
+// Range of days covered by an all-day event
+typedef struct {
+    size_t location;    // first day, relative to the first laid out day
+    size_t length;      // number of days
+    size_t index;       // position of the event in the caller's list
+} MGCDayRange;
+
+// Stacks the ranges in the given order: each one goes on the first line where it does not overlap
+// a previous range. Ranges on lines that do not fit in maxVisibleLines are hidden.
+// eventCounts holds the number of events of each of the numberOfDays days.
+// On return, lines[i] is the line of ranges[i] or MGCLayoutHiddenLine, and hiddenCounts[day] the number
+// of hidden events for each day.
+// Returns the number of lines of the layout, including the line for hidden events indicators.
+// Runs in O(n log n) when ranges are sorted by first day (empty ranges excepted), and in O(n * lines * days) otherwise.
+// If memory cannot be allocated, the ranges that could not be placed are hidden.
+size_t MGCLayoutAllDayEvents(const MGCDayRange *ranges, size_t count, const size_t *eventCounts, size_t numberOfDays, size_t maxVisibleLines, size_t *lines, size_t *hiddenCounts);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MGCEventsLayoutCore_h */
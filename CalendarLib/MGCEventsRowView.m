@@ -37,6 +37,10 @@ static const CGFloat kCellSpacing = 2.;		// space around cells
 @property (nonatomic) NSMutableDictionary *cells;		// dictionary of event cells [ { indexPath (day, item) : cell }, ... ]
 @property (nonatomic) NSMutableArray *labels;			// array of "more events" UILabels
 @property (nonatomic) NSMutableDictionary *eventsCount;	// cache of events count per day [ { day : count }, ... ]
+@property (nonatomic) NSMutableDictionary *cellRanges;	// days range of the cells in the row [ { indexPath : range }, ... ]
+@property (nonatomic) NSMutableDictionary *cellLines;	// line of the cells [ { indexPath : line }, ... ]
+@property (nonatomic) NSUInteger loadedLines;			// number of visible lines when the row was last reloaded
+@property (nonatomic) CGSize layoutSize;				// size of the row when the cells were last laid out
 
 @end
 
@@ -50,6 +54,8 @@ static const CGFloat kCellSpacing = 2.;		// space around cells
     if (self = [super initWithFrame:frame])
 	{
         _cells = [[NSMutableDictionary alloc]initWithCapacity:25];
+        _cellRanges = [[NSMutableDictionary alloc]initWithCapacity:25];
+        _cellLines = [[NSMutableDictionary alloc]initWithCapacity:25];
 		_itemHeight = 18;
 		_labels = [NSMutableArray array];
 		_dayWidth = 100;
@@ -70,9 +76,34 @@ static const CGFloat kCellSpacing = 2.;		// space around cells
 - (void)layoutSubviews
 {
 	[super layoutSubviews];
-    [self reload];
-    // possible optimization: we shouldn't have to reload everything but only to recompute the frames of the cells
-    
+	
+	// events have to be arranged again only if the number of lines changed,
+	// otherwise we keep the cells on their lines and recompute their frames
+	if (self.maxVisibleLines != self.loadedLines) {
+		[self reload];
+	}
+	else if (!CGSizeEqualToSize(self.bounds.size, self.layoutSize)) {
+		[self layoutCells];
+	}
+}
+
+// recomputes the frames of the cells and "more events" labels, without querying the delegate for events
+- (void)layoutCells
+{
+	for (NSIndexPath *path in self.cells)
+	{
+		MGCEventView *cell = [self.cells objectForKey:path];
+		NSRange range = [[self.cellRanges objectForKey:path]rangeValue];
+		NSUInteger line = [[self.cellLines objectForKey:path]unsignedIntegerValue];
+		cell.frame = [self rectForCellWithRange:range line:line];
+	}
+	
+	for (UILabel *label in self.labels)
+	{
+		label.frame = [self rectForCellWithRange:NSMakeRange(label.tag, 1) line:self.loadedLines - 1];
+	}
+	
+	self.layoutSize = self.bounds.size;
 }
 
 - (NSUInteger)maxVisibleLinesForDaysInRange:(NSRange)range
@@ -144,6 +175,8 @@ static const CGFloat kCellSpacing = 2.;		// space around cells
 	
 	[self recycleEventsCells];
 	self.eventsCount = nil;
+	self.loadedLines = self.maxVisibleLines;
+	self.layoutSize = self.bounds.size;
 	
 	NSDictionary *eventRanges = [self eventRanges];
 	// dictionary of "more events" labels [ { day : count of hidden events }, ... ]
@@ -191,6 +224,8 @@ static const CGFloat kCellSpacing = 2.;		// space around cells
 			[cell setNeedsDisplay];
 			
 			[self.cells setObject:cell forKey:indexPath];
+			[self.cellRanges setObject:[NSValue valueWithRange:eventRange] forKey:indexPath];
+			[self.cellLines setObject:@(numLine) forKey:indexPath];
 		}
 		else
 		{
@@ -214,6 +249,7 @@ static const CGFloat kCellSpacing = 2.;		// space around cells
 			label.textAlignment = NSTextAlignmentRight;
 			label.font = [UIFont systemFontOfSize:11];
 			label.frame = [self rectForCellWithRange:NSMakeRange(day, 1) line:self.maxVisibleLines - 1];
+			label.tag = day;
 			
 			[self addSubview:label];
 			[self.labels addObject:label];
@@ -270,6 +306,8 @@ static const CGFloat kCellSpacing = 2.;		// space around cells
 		}
 	}
 	[self.cells removeAllObjects];
+	[self.cellRanges removeAllObjects];
+	[self.cellLines removeAllObjects];
 	
 	for (UILabel *label in self.labels) {
 		[label removeFromSuperview];
@@ -0,0 +1,69 @@
+//
+//  MGCMonthHeightIndex.h
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import <UIKit/UIKit.h>
+
+
+// Index of the heights of consecutive months, as laid out by the month planner view:
+// a month is as high as its number of week rows times rowHeight, plus monthSpacing.
+// Months are identified by their offset from the month containing referenceDate.
+// The number of rows of each month is computed once from its first weekday and number of days,
+// and kept in a prefix-sum table that grows as needed, so that vertical offsets of months
+// and months at given offsets are found in O(log n).
+@interface MGCMonthHeightIndex : NSObject
+
+@property (nonatomic, readonly) NSCalendar *calendar;		// calendar used to compute the months
+@property (nonatomic, readonly) NSDate *referenceDate;		// start of the month at offset 0
+@property (nonatomic) CGFloat rowHeight;					// height of a week row
+@property (nonatomic) CGFloat monthSpacing;					// vertical space added to each month (header and insets)
+
++ (instancetype)indexWithCalendar:(NSCalendar*)calendar referenceDate:(NSDate*)date;
+- (instancetype)initWithCalendar:(NSCalendar*)calendar referenceDate:(NSDate*)date;
+
+// number of months between referenceDate and the month containing date
+- (NSInteger)monthOffsetForDate:(NSDate*)date;
+
+// start of the month at given offset
+- (NSDate*)dateForMonthOffset:(NSInteger)monthOffset;
+
+// number of week rows of the month at given offset
+- (NSUInteger)numberOfRowsForMonthOffset:(NSInteger)monthOffset;
+
+// height of the month at given offset
+- (CGFloat)heightForMonthOffset:(NSInteger)monthOffset;
+
+// vertical offset of the month at given offset, relative to the month at offset 0
+- (CGFloat)yOffsetForMonthOffset:(NSInteger)monthOffset;
+
+// offset of the month containing the vertical offset y (relative to the month at offset 0),
+// i.e. of the last month whose vertical offset is not greater than y
+- (NSInteger)monthOffsetForYOffset:(CGFloat)y;
+
+@end
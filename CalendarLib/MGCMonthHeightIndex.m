@@ -0,0 +1,199 @@
+//
+//  MGCMonthHeightIndex.m
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import "MGCMonthHeightIndex.h"
+#import "NSCalendar+MGCAdditions.h"
+
+
+static const NSUInteger kMinimumGrowth = 24;	// minimum number of months added to the table when it grows
+
+
+@interface MGCMonthHeightIndex ()
+
+@property (nonatomic) NSInteger firstMonth;			// offset of the first month in the table
+@property (nonatomic) NSUInteger numberOfMonths;	// number of months in the table
+@property (nonatomic) NSUInteger firstColumn;		// column of the first day of firstMonth (0 is the first day of the week)
+@property (nonatomic) NSUInteger endColumn;			// column of the first day of the month following the table
+@property (nonatomic) NSData *rows;					// numberOfMonths + 1 NSInteger values: rows[i] is the number of rows of months firstMonth to firstMonth + i excluded
+
+@end
+
+
+@implementation MGCMonthHeightIndex
+
++ (instancetype)indexWithCalendar:(NSCalendar*)calendar referenceDate:(NSDate*)date
+{
+	return [[self alloc] initWithCalendar:calendar referenceDate:date];
+}
+
+- (instancetype)initWithCalendar:(NSCalendar*)calendar referenceDate:(NSDate*)date
+{
+	NSParameterAssert(calendar && date);
+	
+	if (self = [super init]) {
+		_calendar = calendar;
+		_referenceDate = [calendar mgc_startOfMonthForDate:date];
+		
+		NSUInteger weekday = [calendar components:NSCalendarUnitWeekday fromDate:_referenceDate].weekday;
+		_firstColumn = _endColumn = (weekday + 7 - calendar.firstWeekday) % 7;
+		_rows = [NSMutableData dataWithLength:sizeof(NSInteger)];
+	}
+	return self;
+}
+
+- (NSInteger)monthOffsetForDate:(NSDate*)date
+{
+	NSDate *startOfMonth = [self.calendar mgc_startOfMonthForDate:date];
+	return [self.calendar components:NSCalendarUnitMonth fromDate:self.referenceDate toDate:startOfMonth options:0].month;
+}
+
+- (NSDate*)dateForMonthOffset:(NSInteger)monthOffset
+{
+	NSDateComponents *comps = [NSDateComponents new];
+	comps.month = monthOffset;
+	return [self.calendar dateByAddingComponents:comps toDate:self.referenceDate options:0];
+}
+
+- (NSUInteger)numberOfDaysForMonthOffset:(NSInteger)monthOffset
+{
+	NSDate *date = [self dateForMonthOffset:monthOffset];
+	return [self.calendar rangeOfUnit:NSCalendarUnitDay inUnit:NSCalendarUnitMonth forDate:date].length;
+}
+
+// grows the table so that it includes months from first to last
+- (void)growToIncludeMonthsFrom:(NSInteger)first to:(NSInteger)last
+{
+	NSInteger oldFirst = self.firstMonth, oldLast = self.firstMonth + (NSInteger)self.numberOfMonths - 1;
+	if (first >= oldFirst && last <= oldLast) return;
+	
+	// grow at least geometrically, so that walking away one month at a time stays linear
+	NSInteger growth = MAX(self.numberOfMonths, kMinimumGrowth);
+	NSInteger newFirst = first < oldFirst ? MIN(first, oldFirst - growth) : oldFirst;
+	NSInteger newLast = last > oldLast ? MAX(last, oldLast + growth) : oldLast;
+	NSUInteger count = newLast - newFirst + 1;
+	NSUInteger shift = oldFirst - newFirst;
+	
+	NSMutableData *data = [NSMutableData dataWithLength:(count + 1) * sizeof(NSInteger)];
+	NSInteger *rows = data.mutableBytes;
+	const NSInteger *oldRows = self.rows.bytes;
+	
+	// rows of each month are first stored in rows[i + 1], then summed up
+	
+	// months before the old table, walking back from its first month
+	NSUInteger column = self.firstColumn;
+	for (NSUInteger i = shift; i > 0; i--) {
+		NSUInteger numDays = [self numberOfDaysForMonthOffset:newFirst + (NSInteger)i - 1];
+		column = (column + 7 - numDays % 7) % 7;
+		rows[i] = (column + numDays + 6) / 7;
+	}
+	self.firstColumn = column;
+	
+	// months of the old table
+	for (NSUInteger i = 0; i < self.numberOfMonths; i++) {
+		rows[shift + i + 1] = oldRows[i + 1] - oldRows[i];
+	}
+	
+	// months after the old table, walking forward from its last month
+	column = self.endColumn;
+	for (NSUInteger i = shift + self.numberOfMonths; i < count; i++) {
+		NSUInteger numDays = [self numberOfDaysForMonthOffset:newFirst + (NSInteger)i];
+		rows[i + 1] = (column + numDays + 6) / 7;
+		column = (column + numDays) % 7;
+	}
+	self.endColumn = column;
+	
+	for (NSUInteger i = 0; i < count; i++) {
+		rows[i + 1] += rows[i];
+	}
+	
+	self.firstMonth = newFirst;
+	self.numberOfMonths = count;
+	self.rows = data;
+}
+
+- (NSUInteger)numberOfRowsForMonthOffset:(NSInteger)monthOffset
+{
+	[self growToIncludeMonthsFrom:monthOffset to:monthOffset];
+	
+	const NSInteger *rows = self.rows.bytes;
+	NSUInteger i = monthOffset - self.firstMonth;
+	return rows[i + 1] - rows[i];
+}
+
+- (CGFloat)heightForMonthOffset:(NSInteger)monthOffset
+{
+	return [self numberOfRowsForMonthOffset:monthOffset] * self.rowHeight + self.monthSpacing;
+}
+
+// vertical offset of the month at index i in the table, relative to the month at offset 0
+- (CGFloat)yOffsetForMonthAtIndex:(NSUInteger)i
+{
+	const NSInteger *rows = self.rows.bytes;
+	NSInteger origin = -self.firstMonth;		// index of the month at offset 0
+	return (rows[i] - rows[origin]) * self.rowHeight + ((NSInteger)i - origin) * self.monthSpacing;
+}
+
+- (CGFloat)yOffsetForMonthOffset:(NSInteger)monthOffset
+{
+	[self growToIncludeMonthsFrom:MIN(monthOffset, 0) to:MAX(monthOffset, 0)];
+	
+	return [self yOffsetForMonthAtIndex:monthOffset - self.firstMonth];
+}
+
+- (NSInteger)monthOffsetForYOffset:(CGFloat)y
+{
+	if (self.rowHeight <= 0 && self.monthSpacing <= 0) return 0;
+	
+	[self growToIncludeMonthsFrom:0 to:0];
+	
+	// grow the table until it includes y
+	while ([self yOffsetForMonthAtIndex:0] > y) {
+		[self growToIncludeMonthsFrom:self.firstMonth - 1 to:self.firstMonth];
+	}
+	while ([self yOffsetForMonthAtIndex:self.numberOfMonths] <= y) {
+		NSInteger last = self.firstMonth + self.numberOfMonths;
+		[self growToIncludeMonthsFrom:last to:last];
+	}
+	
+	// binary search for the last month starting at or before y
+	NSUInteger lo = 0, hi = self.numberOfMonths;
+	while (hi - lo > 1) {
+		NSUInteger mid = (lo + hi) / 2;
+		if ([self yOffsetForMonthAtIndex:mid] <= y) {
+			lo = mid;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return self.firstMonth + (NSInteger)lo;
+}
+
+@end
@@ -52,6 +52,15 @@
 // according to the maximum number of weeks per month in a year.
 - (CGSize)preferredSizeYearWise:(BOOL)yearWise;
 
+// returns an immutable snapshot of everything drawn by the view, including the background colors
+// returned by the delegate. It implements isEqual: and hash, so it can be used as a cache key.
+// Must be called on the main thread.
+- (id<NSCopying>)contentForBackgroundRendering;
+
+// draws content returned by contentForBackgroundRendering in the current graphics context.
+// This does not access any view, so it can be called from a background queue.
++ (void)drawBackgroundRenderingContent:(id)content inRect:(CGRect)rect;
+
 @end
 
 
@@ -41,10 +41,218 @@ static const CGFloat kDefaultDayFontSizeiPhone = 7;
 static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
 
 
+// Process-wide cache of pre-rendered strings (day ordinals and week day symbols)
+// for a given font, color and screen scale, so that drawing a month only blits images.
+@interface MGCMiniCalendarGlyphAtlas : NSObject
+
+@property (nonatomic, readonly) UIFont *font;
+@property (nonatomic, readonly) UIColor *color;
+@property (nonatomic, readonly) CGFloat scale;
+@property (nonatomic, readonly) CGSize cellSize;		// size of the string @"00" with the atlas font
+
++ (instancetype)atlasWithFont:(UIFont*)font color:(UIColor*)color scale:(CGFloat)scale;
++ (UIFont*)boldFontWithFont:(UIFont*)font;
+- (void)drawString:(NSString*)string inRect:(CGRect)rect;	// draws string horizontally centered at the top of rect
+
+@end
+
+
+@interface MGCMiniCalendarGlyphAtlas ()
+
+@property (nonatomic) NSMutableDictionary *images;		// rendered strings, indexed by string
+
+@end
+
+
+@implementation MGCMiniCalendarGlyphAtlas
+
++ (NSCache*)sharedAtlases
+{
+    static NSCache *atlases = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        atlases = [NSCache new];
+        atlases.countLimit = 16;
+    });
+    return atlases;
+}
+
++ (instancetype)atlasWithFont:(UIFont*)font color:(UIColor*)color scale:(CGFloat)scale
+{
+    NSArray *key = @[ font.fontName, @(font.pointSize), color, @(scale) ];
+    
+    MGCMiniCalendarGlyphAtlas *atlas = [[self sharedAtlases] objectForKey:key];
+    if (!atlas) {
+        atlas = [[MGCMiniCalendarGlyphAtlas alloc]initWithFont:font color:color scale:scale];
+        [[self sharedAtlases] setObject:atlas forKey:key];
+    }
+    return atlas;
+}
+
++ (UIFont*)boldFontWithFont:(UIFont*)font
+{
+    static NSCache *boldFonts = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        boldFonts = [NSCache new];
+    });
+    
+    UIFont *boldFont = [boldFonts objectForKey:font];
+    if (!boldFont) {
+        boldFont = [UIFont fontWithDescriptor:[[font fontDescriptor] fontDescriptorWithSymbolicTraits:UIFontDescriptorTraitBold] size:font.pointSize];
+        [boldFonts setObject:boldFont forKey:font];
+    }
+    return boldFont;
+}
+
+- (instancetype)initWithFont:(UIFont*)font color:(UIColor*)color scale:(CGFloat)scale
+{
+    if (self = [super init]) {
+        _font = font;
+        _color = color;
+        _scale = scale;
+        _cellSize = [@"00" sizeWithAttributes:@{ NSFontAttributeName: font }];
+        _images = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+// months can be drawn off the main thread, hence the lock
+- (UIImage*)imageForString:(NSString*)string
+{
+    @synchronized(self) {
+        UIImage *image = [self.images objectForKey:string];
+        if (!image) {
+            NSDictionary *attributes = @{ NSFontAttributeName: self.font, NSForegroundColorAttributeName: self.color };
+            CGSize size = [string sizeWithAttributes:attributes];
+            size = CGSizeMake(ceil(size.width), ceil(size.height));
+            if (size.width == 0 || size.height == 0) {
+                return nil;
+            }
+            
+            UIGraphicsBeginImageContextWithOptions(size, NO, self.scale);
+            [string drawAtPoint:CGPointZero withAttributes:attributes];
+            image = UIGraphicsGetImageFromCurrentImageContext();
+            UIGraphicsEndImageContext();
+            
+            [self.images setObject:image forKey:string];
+        }
+        return image;
+    }
+}
+
+- (void)drawString:(NSString*)string inRect:(CGRect)rect
+{
+    UIImage *image = [self imageForString:string];
+    CGFloat x = CGRectGetMidX(rect) - image.size.width / 2.;
+    [image drawAtPoint:CGPointMake(x, rect.origin.y)];
+}
+
+@end
+
+
 @interface MGCMonthMiniCalendarView ()
 
 @property (nonatomic) NSDateFormatter *dateFormatter;	// date formatter used to format month names
 @property (nonatomic, readonly) NSArray *dayLabels;		// strings for the week days symbols (M, T, W...)
+@property (nonatomic, readonly) NSUInteger firstDayColumn;	// zero-based column of the first day of the month
+
+@end
+
+
+// MGCMonthMiniCalendarContent: immutable snapshot of everything drawn by a month view, taken on the main thread.
+// It is drawn without accessing the view, so that months can be rendered on a background queue.
+@interface MGCMonthMiniCalendarContent : NSObject<NSCopying>
+
+@property (nonatomic, readonly) NSDate *date;					// first day of the month
+@property (nonatomic, readonly) NSUInteger numberOfDays;
+@property (nonatomic, readonly) NSUInteger numberOfColumns;		// number of days in a week
+@property (nonatomic, readonly) NSUInteger firstDayColumn;
+@property (nonatomic, readonly) NSArray *dayLabels;				// nil if the week day header is hidden
+@property (nonatomic, readonly) NSAttributedString *headerText;	// nil if the month header is hidden
+@property (nonatomic, readonly) UIFont *daysFont;
+@property (nonatomic, readonly) NSIndexSet *highlightedDays;
+@property (nonatomic, readonly) UIColor *highlightColor;
+@property (nonatomic, readonly) NSDictionary *dayColors;		// { day index : background color }
+@property (nonatomic, readonly) CGFloat margin;
+@property (nonatomic, readonly) CGFloat scale;
+
+- (instancetype)initWithMonthView:(MGCMonthMiniCalendarView*)view;
+
+@end
+
+
+@implementation MGCMonthMiniCalendarContent
+
+// must be called on the main thread
+- (instancetype)initWithMonthView:(MGCMonthMiniCalendarView*)view
+{
+    if (self = [super init]) {
+        _date = [view.calendar mgc_startOfMonthForDate:view.date];
+        _numberOfDays = [view.calendar rangeOfUnit:NSCalendarUnitDay inUnit:NSCalendarUnitMonth forDate:_date].length;
+        _numberOfColumns = view.dayLabels.count;
+        _firstDayColumn = view.firstDayColumn;
+        _dayLabels = view.showsDayHeader ? [view.dayLabels copy] : nil;
+        _headerText = view.showsMonthHeader ? [view.headerText copy] : nil;
+        _daysFont = view.daysFont;
+        _highlightedDays = view.highlightedDays.count ? [view.highlightedDays copy] : nil;
+        _highlightColor = _highlightedDays ? view.highlightColor : nil;
+        _margin = isiPad ? kMonthMargin : kMonthMarginiPhone;
+        _scale = [UIScreen mainScreen].scale;
+        
+        if ([view.delegate respondsToSelector:@selector(monthMiniCalendarView:backgroundColorForDayAtIndex:)]) {
+            NSMutableDictionary *colors = [NSMutableDictionary dictionary];
+            for (NSUInteger i = 1; i <= _numberOfDays; i++) {
+                UIColor *color = [view.delegate monthMiniCalendarView:view backgroundColorForDayAtIndex:i];
+                if (color) {
+                    [colors setObject:color forKey:@(i)];
+                }
+            }
+            _dayColors = colors;
+        }
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone*)zone
+{
+    return self;    // immutable
+}
+
+- (BOOL)isEqual:(id)object
+{
+    if (self == object) return YES;
+    if (![object isKindOfClass:[MGCMonthMiniCalendarContent class]]) return NO;
+    
+    MGCMonthMiniCalendarContent *content = object;
+    return [self.date isEqualToDate:content.date] && self.numberOfDays == content.numberOfDays &&
+        self.numberOfColumns == content.numberOfColumns && self.firstDayColumn == content.firstDayColumn &&
+        self.margin == content.margin && self.scale == content.scale &&
+        [self.daysFont isEqual:content.daysFont] &&
+        (self.dayLabels == content.dayLabels || [self.dayLabels isEqualToArray:content.dayLabels]) &&
+        (self.headerText == content.headerText || [self.headerText isEqualToAttributedString:content.headerText]) &&
+        (self.highlightedDays == content.highlightedDays || [self.highlightedDays isEqualToIndexSet:content.highlightedDays]) &&
+        (self.highlightColor == content.highlightColor || [self.highlightColor isEqual:content.highlightColor]) &&
+        (self.dayColors == content.dayColors || [self.dayColors isEqualToDictionary:content.dayColors]);
+}
+
+- (NSUInteger)hash
+{
+    return self.date.hash ^ (self.highlightedDays.hash * 31) ^ (self.dayColors.count << 16);
+}
+
+// atlas used to draw week day symbols and days that are neither highlighted nor colored
+- (MGCMiniCalendarGlyphAtlas*)regularAtlas
+{
+    return [MGCMiniCalendarGlyphAtlas atlasWithFont:self.daysFont color:[UIColor blackColor] scale:self.scale];
+}
+
+// atlas used to draw highlighted or colored days
+- (MGCMiniCalendarGlyphAtlas*)highlightedAtlas
+{
+    UIFont *font = [MGCMiniCalendarGlyphAtlas boldFontWithFont:self.daysFont];
+    return [MGCMiniCalendarGlyphAtlas atlasWithFont:font color:[UIColor colorWithWhite:1 alpha:.9] scale:self.scale];
+}
 
 @end
 
@@ -53,6 +261,20 @@ static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
 
 @synthesize dayLabels = _dayLabels;
 
++ (NSArray*)dayOrdinals
+{
+    static NSArray *ordinals = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableArray *strings = [NSMutableArray arrayWithCapacity:32];
+        for (NSUInteger i = 0; i <= 31; i++) {
+            [strings addObject:[NSString stringWithFormat:@"%lu", (unsigned long)i]];
+        }
+        ordinals = strings;
+    });
+    return ordinals;
+}
+
 - (id)initWithFrame:(CGRect)frame
 {
     self = [super initWithFrame:frame];
@@ -106,6 +328,7 @@ static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
 {
     _calendar = [calendar copy];
     self.dateFormatter.calendar = calendar;
+    _dayLabels = nil;	// first week day may have changed
 }
 
 - (NSAttributedString*)headerText
@@ -145,7 +368,7 @@ static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
 
 - (CGSize)preferredSizeYearWise:(BOOL)yearWise
 {
-	CGSize daySize = [@"00" sizeWithAttributes:@{ NSFontAttributeName:self.daysFont }];
+	CGSize daySize = self.regularAtlas.cellSize;
 	CGFloat dayCellSize = MAX(daySize.width, daySize.height);
 	CGFloat space = dayCellSize / 2.;
 	
@@ -177,53 +400,34 @@ static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
     return viewSize;
 }
 
-- (NSMutableAttributedString*)textForDayAtIndex:(NSUInteger)index cellColor:(UIColor*)cellColor
+// atlas used to measure day cells
+- (MGCMiniCalendarGlyphAtlas*)regularAtlas
 {
-    NSString *s = [NSString stringWithFormat:@"%lu", (unsigned long)index];
-    UIColor *color = [UIColor blackColor];
-    UIFont *font = self.daysFont;
-    
-    if ([self.highlightedDays containsIndex:index] || cellColor != nil)
-    {
-        color = [UIColor colorWithWhite:1 alpha:.9];
-        font = [UIFont fontWithDescriptor:[[self.daysFont fontDescriptor] fontDescriptorWithSymbolicTraits:UIFontDescriptorTraitBold] size:self.daysFont.pointSize];
-    }
-    
-    NSMutableParagraphStyle *para = [NSMutableParagraphStyle new];
-    para.alignment = NSTextAlignmentCenter;
-    para.lineBreakMode = NSLineBreakByCharWrapping;
-    
-    return [[NSMutableAttributedString alloc]initWithString:s attributes:@{ NSFontAttributeName: font, NSForegroundColorAttributeName: color, NSParagraphStyleAttributeName: para }];
+    return [MGCMiniCalendarGlyphAtlas atlasWithFont:self.daysFont color:[UIColor blackColor] scale:[UIScreen mainScreen].scale];
 }
 
-#pragma mark - UIView
-
-- (CGSize)sizeThatFits:(CGSize)size
+- (id<NSCopying>)contentForBackgroundRendering
 {
-    return [self preferredSizeYearWise:NO];
+    return [[MGCMonthMiniCalendarContent alloc]initWithMonthView:self];
 }
 
-- (void)drawRect:(CGRect)rect
++ (void)drawBackgroundRenderingContent:(MGCMonthMiniCalendarContent*)content inRect:(CGRect)rect
 {
+	MGCMiniCalendarGlyphAtlas *regularAtlas = content.regularAtlas;
+	MGCMiniCalendarGlyphAtlas *highlightedAtlas = content.highlightedAtlas;
+	
 	// calc sizes
-	CGSize daySize = [@"00" sizeWithAttributes:@{ NSFontAttributeName:self.daysFont }];
+	CGSize daySize = regularAtlas.cellSize;
 	CGFloat dayCellSize = MAX(daySize.width, daySize.height);
 	CGFloat space = dayCellSize / 2.;
-
-    if (isiPad) {
-        //NSLog(@"---------------- iPAD ------------------");
-        rect = CGRectInset(rect, kMonthMargin, kMonthMargin);
-    }
-    else{
-        //NSLog(@"---------------- iPhone ------------------");
-        rect = CGRectInset(rect, kMonthMarginiPhone, kMonthMarginiPhone);
-    }
+	
+	rect = CGRectInset(rect, content.margin, content.margin);
 	
 	// draw month header
-	if (self.showsMonthHeader)
+	if (content.headerText)
 	{
-		CGRect headerRect = [self.headerText boundingRectWithSize:rect.size options:NSStringDrawingUsesLineFragmentOrigin context:nil];
-		[self.headerText drawInRect:rect];
+		CGRect headerRect = [content.headerText boundingRectWithSize:rect.size options:NSStringDrawingUsesLineFragmentOrigin context:nil];
+		[content.headerText drawInRect:rect];
 		
 		rect.origin.y += headerRect.size.height + space;
 		rect.size.height -= headerRect.size.height + space;
@@ -233,17 +437,13 @@ static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
 	
 	
 	// draw days header
-	if (self.showsDayHeader)
+	if (content.dayLabels)
 	{
-		NSMutableParagraphStyle *para = [NSMutableParagraphStyle new];
-		para.alignment = NSTextAlignmentCenter;
-		para.lineBreakMode = NSLineBreakByCharWrapping;
-				
-		for (int i = 0; i < self.dayLabels.count; i++)
+		for (int i = 0; i < content.dayLabels.count; i++)
 		{
-			NSString *s = [self.dayLabels objectAtIndex:i];
+			NSString *s = [content.dayLabels objectAtIndex:i];
 			CGRect cellRect = CGRectMake(x, rect.origin.y, dayCellSize, dayCellSize);
-			[s drawInRect:cellRect withAttributes:@{ NSFontAttributeName:self.daysFont, NSParagraphStyleAttributeName:para }];
+			[regularAtlas drawString:s inRect:cellRect];
 			x += dayCellSize + space;
 		}
 		
@@ -257,15 +457,13 @@ static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
 	
 	
 	// draw day cells
-	NSDate *firstDayInMonth = [self.calendar mgc_startOfMonthForDate:self.date];
-	NSUInteger days = [self.calendar rangeOfUnit:NSCalendarUnitDay inUnit:NSCalendarUnitMonth forDate:firstDayInMonth].length;
-	NSUInteger firstCol = [self firstDayColumn];
+	NSUInteger firstCol = content.firstDayColumn;
 	
 	x = rect.origin.x + firstCol * (dayCellSize + space);
 	
-	for (NSUInteger i = 1, col = firstCol; i <= days; i++, col++)
+	for (NSUInteger i = 1, col = firstCol; i <= content.numberOfDays; i++, col++)
 	{
-		if (col == self.dayLabels.count)
+		if (col == content.numberOfColumns)
 		{
 			col = 0;
 			x = rect.origin.x;
@@ -275,28 +473,38 @@ static const CGFloat kDefaultHeaderFontSizeiPhone = 8;
 		CGRect cellRect = CGRectMake(x, y, dayCellSize, dayCellSize);
 		CGRect boxRect = CGRectInset(cellRect, -space / 2 + 1, -space / 2 + 1);
 		
-		UIColor *bkgColor = nil;
-		if ([self.delegate respondsToSelector:@selector(monthMiniCalendarView:backgroundColorForDayAtIndex:)])
-			bkgColor = [self.delegate monthMiniCalendarView:self backgroundColorForDayAtIndex:i];
-		
+		UIColor *bkgColor = [content.dayColors objectForKey:@(i)];
 		if (bkgColor)
 		{
 			[bkgColor setFill];
 			UIRectFill(boxRect);
 		}
 		
-		if ([self.highlightedDays containsIndex:i])
+		if ([content.highlightedDays containsIndex:i])
 		{
 			UIBezierPath* p = [UIBezierPath bezierPathWithOvalInRect:boxRect];
-			[self.highlightColor setFill];
+			[content.highlightColor setFill];
 			[p fill];
 		}
 		
-		NSMutableAttributedString *as = [self textForDayAtIndex:i cellColor:bkgColor];
-		[as drawInRect:cellRect];
+		BOOL highlighted = [content.highlightedDays containsIndex:i] || bkgColor != nil;
+		MGCMiniCalendarGlyphAtlas *atlas = highlighted ? highlightedAtlas : regularAtlas;
+		[atlas drawString:[[MGCMonthMiniCalendarView dayOrdinals] objectAtIndex:i] inRect:cellRect];
 		
 		x += cellRect.size.width + space;
 	}
 }
 
+#pragma mark - UIView
+
+- (CGSize)sizeThatFits:(CGSize)size
+{
+    return [self preferredSizeYearWise:NO];
+}
+
+- (void)drawRect:(CGRect)rect
+{
+	[MGCMonthMiniCalendarView drawBackgroundRenderingContent:[self contentForBackgroundRendering] inRect:rect];
+}
+
 @end
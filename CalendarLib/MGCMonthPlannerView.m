@@ -33,6 +33,8 @@
 #import "OrderedDictionary.h"
 #import "MGCReusableObjectQueue.h"
 #import "MGCMonthPlannerViewLayout.h"
+#import "MGCMonthHeightIndex.h"
+#import "MGCDayBoundaryTable.h"
 #import "MGCMonthPlannerViewDayCell.h"
 #import "MGCMonthPlannerBackgroundView.h"
 #import "MGCMonthPlannerWeekView.h"
@@ -57,6 +59,13 @@ static NSString* const kDefaultDateFormat = @"dMMYY";
 
 #pragma mark -
 
+// days covered by an event in the month planner view
+typedef struct {
+    NSInteger start;    // first day, as an offset from the start of the month
+    NSInteger end;      // day following the last one
+} MGCEventDaySpan;
+
+
 typedef enum
 {
     CalendarViewScrollingUp = 1 << 0,
@@ -73,10 +82,13 @@ typedef enum
 @property (nonatomic, readonly) NSDate *maxStartDate;				// maximum date for the start of a loaded page of the collection view - set with dateRange, nil for infinite scrolling
 @property (nonatomic, readonly) NSUInteger numberOfLoadedMonths;	// number of months loaded at once in the collection views
 @property (nonatomic, readonly) MGCDateRange* loadedDateRange;		// date range of all months currently loaded in the collection views
+@property (nonatomic) MGCMonthHeightIndex *monthHeights;			// index of the heights of the months, for conversions between months and offsets (created lazily)
 @property (nonatomic) NSDateFormatter *dateFormatter;				// date formatter for day cells
 @property (nonatomic) NSMutableArray *dayLabels;                    // week day labels (UILabel) for header view
 @property (nonatomic) MGCReusableObjectQueue *reuseQueue;			// reuse queue for MGCEventsRowView and MGCEventView objects
 @property (nonatomic) MutableOrderedDictionary *eventRows;			// cache of MRU MGCEventsRowView objects indexed by start date
+@property (nonatomic) NSMutableDictionary *eventSpans;				// days spanned by events, shared by the rows of a month [ { month start : { day : NSData of MGCEventDaySpan } }, ... ]
+@property (nonatomic) NSMutableDictionary *monthDays;				// day boundaries of the months in eventSpans [ { month start : MGCDayBoundaryTable }, ... ]
 @property (nonatomic, readwrite) NSDate *selectedEventDate;         // date of the selected event, or nil if no event is selected
 @property (nonatomic, readwrite) NSUInteger selectedEventIndex;     // index of the selected event at the date returned by selectedEventDate
 @property (nonatomic) MGCEventView *interactiveCell;				// cell moved around during drag and drop
@@ -113,6 +125,8 @@ typedef enum
     _itemHeight = 16;
     _reuseQueue = [MGCReusableObjectQueue new];
     _eventRows = [MutableOrderedDictionary dictionaryWithCapacity:kRowCacheSize];
+    _eventSpans = [NSMutableDictionary dictionary];
+    _monthDays = [NSMutableDictionary dictionary];
     _dragEventIndex = -1;
     _monthHeaderStyle = MGCMonthHeaderStyleDefault;
     _monthInsets = UIEdgeInsetsMake(20, 0, 20, 0);
@@ -176,6 +190,8 @@ typedef enum
         }
     }
     [self.eventRows removeObjectsForKeys:delete];
+    
+    [self discardUnusedEventSpans];
 }
 
 #pragma mark - Layout
@@ -197,6 +213,14 @@ typedef enum
     return self.dateFormatter.dateFormat;
 }
 
+// public
+- (void)setCalendar:(NSCalendar*)calendar
+{
+    _calendar = calendar;
+    self.monthHeights = nil;
+    [self discardEventSpansInRange:nil];
+}
+
 // public
 - (void)setDayCellHeaderHeight:(CGFloat)dayCellHeaderHeight
 {
@@ -372,12 +396,21 @@ typedef enum
     return numWeeks * self.rowHeight + self.monthInsets.top + self.monthInsets.bottom;
 }
 
+- (MGCMonthHeightIndex*)monthHeights
+{
+    if (!_monthHeights) {
+        _monthHeights = [MGCMonthHeightIndex indexWithCalendar:self.calendar referenceDate:self.startDate];
+    }
+    _monthHeights.rowHeight = self.rowHeight;
+    _monthHeights.monthSpacing = self.monthInsets.top + self.monthInsets.bottom;
+    return _monthHeights;
+}
+
 // height for month containing date
 - (CGFloat)heightForMonthAtDate:(NSDate*)date
 {
-    NSDate *monthStart = [self.calendar mgc_startOfMonthForDate:date];
-    NSUInteger numWeeks = [self.calendar rangeOfUnit:NSCalendarUnitWeekOfMonth inUnit:NSCalendarUnitMonth forDate:monthStart].length;
-    return numWeeks * self.rowHeight + self.monthInsets.top + self.monthInsets.bottom;
+    MGCMonthHeightIndex *monthHeights = self.monthHeights;
+    return [monthHeights heightForMonthOffset:[monthHeights monthOffsetForDate:date]];
 }
 
 // number of months loaded at once in the collection view
@@ -490,37 +523,27 @@ typedef enum
 // returns the offset from startDate to given month
 - (CGFloat)yOffsetForMonth:(NSDate*)date
 {
-    NSDate *startOfMonth = [self.calendar mgc_startOfMonthForDate:date];
-    
-    NSDateComponents *comps = [self.calendar components:NSCalendarUnitMonth fromDate:self.startDate toDate:startOfMonth options:0];
-    NSUInteger monthsDiff = labs(comps.month);
+    MGCMonthHeightIndex *monthHeights = self.monthHeights;
     
-    CGFloat offset = 0;
-    
-    NSDate *month = [startOfMonth earlierDate:self.startDate];
-    for (int i = 0; i < monthsDiff; i++) {
-        offset += [self heightForMonthAtDate:month];
-        month = [self.calendar dateByAddingUnit:NSCalendarUnitMonth value:1 toDate:month options:0];
-    }
-    
-    if ([startOfMonth compare:self.startDate] == NSOrderedAscending) {
-        offset = -offset;
-    }
-    return offset;
+    NSInteger month = [monthHeights monthOffsetForDate:date];
+    NSInteger startMonth = [monthHeights monthOffsetForDate:self.startDate];
+    return [monthHeights yOffsetForMonthOffset:month] - [monthHeights yOffsetForMonthOffset:startMonth];
 }
 
 // returns start date for the month at given offset
 - (NSDate*)monthFromOffset:(CGFloat)yOffset
 {
-    NSDate *month = self.startDate;
-    CGFloat y = yOffset > 0 ? [self heightForMonthAtDate:month] : 0;
+    MGCMonthHeightIndex *monthHeights = self.monthHeights;
     
-    while (y < fabs(yOffset)) {
-        month = [self.calendar dateByAddingUnit:NSCalendarUnitMonth value:(yOffset > 0 ? 1 : -1) toDate:month options:0];
-        y += [self heightForMonthAtDate:month];
-    };
+    NSInteger startMonth = [monthHeights monthOffsetForDate:self.startDate];
+    CGFloat y = [monthHeights yOffsetForMonthOffset:startMonth] + yOffset;
+    NSInteger month = [monthHeights monthOffsetForYOffset:y];
     
-    return month;
+    // an offset falling exactly on the top of a month below startDate belongs to the month above
+    if (yOffset > 0 && month > startMonth && [monthHeights yOffsetForMonthOffset:month] == y) {
+        month--;
+    }
+    return [monthHeights dateForMonthOffset:month];
 }
 
 - (void)reload
@@ -528,6 +551,7 @@ typedef enum
     [self deselectEventWithDelegate:YES];
     
     [self clearRowsCacheInDateRange:nil];
+    [self discardEventSpansInRange:nil];
     [self.eventsView reloadData];
 }
 
@@ -571,6 +595,7 @@ typedef enum
     }
     else if (self.style == MGCMonthPlannerStyleEvents) {
         [self deselectEventWithDelegate:YES];
+        [self discardEventSpansInRange:nil];
         
         MGCDateRange *visibleDateRange = [self visibleDays];
         
@@ -604,6 +629,9 @@ typedef enum
             [self deselectEventWithDelegate:YES];
         }
         
+        NSDate *dayStart = [self.calendar mgc_startOfDayForDate:date];
+        [self discardEventSpansInRange:[MGCDateRange dateRangeWithStart:dayStart end:[self.calendar mgc_nextStartOfDayForDate:dayStart]]];
+        
         MGCDateRange *visibleDateRange = [self visibleDays];
         
         [[self.eventRows copy] enumerateKeysAndObjectsUsingBlock:^(NSDate *date, MGCEventsRowView *rowView, BOOL* stop) {
@@ -635,6 +663,8 @@ typedef enum
             [self deselectEventWithDelegate:YES];
         }
         
+        [self discardEventSpansInRange:range];
+        
         MGCDateRange *visibleDateRange = [self visibleDays];
         
         [[self.eventRows copy] enumerateKeysAndObjectsUsingBlock:^(NSDate *date, MGCEventsRowView *rowView, BOOL* stop) {
@@ -1022,6 +1052,110 @@ typedef enum
     if (remove) {
         [self.reuseQueue enqueueReusableObject:remove];
         [self.eventRows removeObjectForKey:date];
+        
+        // event spans are kept as long as a row of their month is cached
+        NSDate *month = remove.referenceDate;
+        for (MGCEventsRowView *rowView in self.eventRows.allValues) {
+            if ([rowView.referenceDate isEqualToDate:month]) return;
+        }
+        [self.eventSpans removeObjectForKey:month];
+        [self.monthDays removeObjectForKey:month];
+    }
+}
+
+#pragma mark - Event spans
+
+// day boundaries of the month starting at given date
+- (MGCDayBoundaryTable*)dayBoundariesForMonth:(NSDate*)month
+{
+    MGCDayBoundaryTable *table = [self.monthDays objectForKey:month];
+    if (!table) {
+        NSUInteger numDays = [self.calendar rangeOfUnit:NSCalendarUnitDay inUnit:NSCalendarUnitMonth forDate:month].length;
+        table = [MGCDayBoundaryTable tableWithCalendar:self.calendar startDate:month numberOfDays:numDays];
+        [self.monthDays setObject:table forKey:month];
+    }
+    return table;
+}
+
+// days spanned by given range, as offsets from the start of the month (start is never before the month)
+- (MGCEventDaySpan)daySpanForDateRange:(MGCDateRange*)dateRange month:(NSDate*)month
+{
+    MGCDayBoundaryTable *days = [self dayBoundariesForMonth:month];
+    
+    MGCEventDaySpan span;
+    span.start = MAX(0, [days dayOffsetForDate:dateRange.start]);
+    // the day of the end date is always included
+    span.end = [days dayOffsetForDate:dateRange.end] + 1;
+    return span;
+}
+
+// spans of all events at given day of the month, fetched from the data source once and shared by all rows
+- (NSData*)eventSpansForDay:(NSUInteger)day month:(NSDate*)month
+{
+    NSMutableDictionary *monthSpans = [self.eventSpans objectForKey:month];
+    if (!monthSpans) {
+        monthSpans = [NSMutableDictionary dictionary];
+        [self.eventSpans setObject:monthSpans forKey:month];
+    }
+    
+    NSData *spans = [monthSpans objectForKey:@(day)];
+    if (!spans) {
+        NSDate *date = [[self dayBoundariesForMonth:month] dateForDayOffset:day];
+        NSUInteger count = [self.dataSource monthPlannerView:self numberOfEventsAtDate:date];
+        
+        NSMutableData *data = [NSMutableData dataWithLength:count * sizeof(MGCEventDaySpan)];
+        MGCEventDaySpan *daySpans = data.mutableBytes;
+        for (NSUInteger i = 0; i < count; i++) {
+            MGCDateRange *dateRange = [self.dataSource monthPlannerView:self dateRangeForEventAtIndex:i date:date];
+            daySpans[i] = [self daySpanForDateRange:dateRange month:month];
+        }
+        
+        spans = data;
+        [monthSpans setObject:spans forKey:@(day)];
+    }
+    return spans;
+}
+
+// if range is nil, discard all spans
+- (void)discardEventSpansInRange:(MGCDateRange*)range
+{
+    if (range == nil) {
+        [self.eventSpans removeAllObjects];
+        [self.monthDays removeAllObjects];
+        return;
+    }
+    
+    for (NSDate *month in self.eventSpans.allKeys) {
+        MGCDayBoundaryTable *days = [self dayBoundariesForMonth:month];
+        
+        NSInteger first = MAX(0, [days dayOffsetForDate:range.start]);
+        NSInteger last = MIN((NSInteger)days.numberOfDays, [days dayOffsetForDate:range.end]);
+        
+        // range end is excluded, unless it falls inside a day
+        if ([[days dateForDayOffset:last] compare:range.end] == NSOrderedAscending) {
+            last++;
+        }
+        
+        NSMutableDictionary *monthSpans = [self.eventSpans objectForKey:month];
+        for (NSInteger day = first; day < last; day++) {
+            [monthSpans removeObjectForKey:@(day)];
+        }
+    }
+}
+
+// removes spans of months without any cached row
+- (void)discardUnusedEventSpans
+{
+    NSMutableSet *months = [NSMutableSet set];
+    for (MGCEventsRowView *rowView in self.eventRows.allValues) {
+        [months addObject:rowView.referenceDate];
+    }
+    
+    for (NSDate *month in self.eventSpans.allKeys) {
+        if (![months containsObject:month]) {
+            [self.eventSpans removeObjectForKey:month];
+            [self.monthDays removeObjectForKey:month];
+        }
     }
 }
 
@@ -1497,30 +1631,26 @@ typedef enum
 
 - (NSUInteger)eventsRowView:(MGCEventsRowView*)view numberOfEventsForDayAtIndex:(NSUInteger)day
 {
-    NSDateComponents *comps = [NSDateComponents new];
-    comps.day = day;
-    NSDate *date = [self.calendar dateByAddingComponents:comps toDate:view.referenceDate options:0];
-    
-    NSUInteger count = [self.dataSource monthPlannerView:self numberOfEventsAtDate:date];
-    return count;
+    return [self eventSpansForDay:day month:view.referenceDate].length / sizeof(MGCEventDaySpan);
 }
 
 - (NSRange)eventsRowView:(MGCEventsRowView*)view rangeForEventAtIndexPath:(NSIndexPath*)indexPath
 {
-    NSDateComponents *comps = [NSDateComponents new];
-    comps.day = indexPath.section;
-    NSDate *date = [self.calendar dateByAddingComponents:comps toDate:view.referenceDate options:0];
+    NSData *spans = [self eventSpansForDay:indexPath.section month:view.referenceDate];
     
-    MGCDateRange *dateRange = [self.dataSource monthPlannerView:self dateRangeForEventAtIndex:indexPath.item date:date];
-    
-    NSInteger start = MAX(0, [self.calendar components:NSCalendarUnitDay fromDate:view.referenceDate toDate:dateRange.start options:0].day);
-    NSInteger end = [self.calendar components:NSCalendarUnitDay fromDate:view.referenceDate toDate:dateRange.end options:0].day;
-	if ([dateRange.end timeIntervalSinceDate:[self.calendar mgc_startOfDayForDate:dateRange.end]] >= 0) {
-        end++;
+    MGCEventDaySpan span;
+    if (indexPath.item < spans.length / sizeof(MGCEventDaySpan)) {
+        span = ((const MGCEventDaySpan*)spans.bytes)[indexPath.item];
+    }
+    else {
+        // the row was not reloaded after the events changed
+        NSDate *date = [[self dayBoundariesForMonth:view.referenceDate] dateForDayOffset:indexPath.section];
+        MGCDateRange *dateRange = [self.dataSource monthPlannerView:self dateRangeForEventAtIndex:indexPath.item date:date];
+        span = [self daySpanForDateRange:dateRange month:view.referenceDate];
     }
-    end = MIN(end, NSMaxRange(view.daysRange));
     
-    return NSMakeRange(start, end - start);
+    NSInteger end = MIN(span.end, NSMaxRange(view.daysRange));
+    return NSMakeRange(span.start, end - span.start);
 }
 
 - (MGCEventView*)eventsRowView:(MGCEventsRowView*)view cellForEventAtIndexPath:(NSIndexPath*)path
@@ -1641,17 +1771,21 @@ typedef enum
     CGFloat yOffsetMin = self.pagingMode == MGCMonthPlannerPagingModeHeaderTop ? 0 : self.monthInsets.top;
     CGFloat yOffsetMax = 0;
     
-    NSDate *monthStart = [self.startDate copy];
-    for (int i = 0; i < self.numberOfLoadedMonths; i++) {
-        CGFloat offset = yOffsetMin + [self heightForMonthAtDate:monthStart];
-        if (offset > scrollView.contentOffset.y) {
-            yOffsetMax = offset;
-            break;
-        }
-        yOffsetMin = offset;
-        
-        monthStart = [self.calendar dateByAddingUnit:NSCalendarUnitMonth value:1 toDate:monthStart options:0];
+    // month containing the current offset, among the loaded months
+    MGCMonthHeightIndex *monthHeights = self.monthHeights;
+    NSInteger startMonth = [monthHeights monthOffsetForDate:self.startDate];
+    CGFloat startY = [monthHeights yOffsetForMonthOffset:startMonth];
+    
+    NSInteger month = [monthHeights monthOffsetForYOffset:startY + scrollView.contentOffset.y - yOffsetMin];
+    month = MAX(month, startMonth);
+    
+    if (month < startMonth + (NSInteger)self.numberOfLoadedMonths) {
+        yOffsetMax = yOffsetMin + [monthHeights yOffsetForMonthOffset:month + 1] - startY;
+    }
+    else {
+        month = startMonth + self.numberOfLoadedMonths;
     }
+    yOffsetMin += [monthHeights yOffsetForMonthOffset:month] - startY;
     
     // we need to had a few checks to avoid flickering when swiping fast on a small distance
     // see http://stackoverflow.com/a/14291208/740949
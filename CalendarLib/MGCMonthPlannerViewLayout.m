@@ -34,11 +34,33 @@
 
 const CGFloat kMonthHeaderMargin = 3.;
 
+// keys of the attributes dictionary of a month
+static NSString* const DayCellsKey = @"DayCellsKey";			// attributes of the day cells, indexed by day
+static NSString* const SupplementaryViewsKey = @"SupplementaryViewsKey";	// attributes of the header, background and rows, keyed by kind and index path
+static NSString* const AllElementsKey = @"AllElementsKey";		// attributes of all elements
+
+
+// Geometry of a month, from which the attributes of all its elements can be computed.
+// It only depends on the data source, so it is kept until the data changes.
+typedef struct {
+	NSUInteger firstColumn;		// column of the first day of the month
+	NSUInteger numberOfDays;	// number of days in the month
+	NSUInteger numberOfRows;	// number of week rows
+	NSUInteger rowsAbove;		// number of week rows of the previous months, from which the vertical offset of the month is computed
+} MGCMonthGeometry;
+
+static BOOL MGCMonthGeometryEqualToGeometry(MGCMonthGeometry g1, MGCMonthGeometry g2)
+{
+	return g1.firstColumn == g2.firstColumn && g1.numberOfDays == g2.numberOfDays && g1.numberOfRows == g2.numberOfRows && g1.rowsAbove == g2.rowsAbove;
+}
+
 
 @interface MGCMonthPlannerViewLayout()
 
-@property (nonatomic) NSDictionary *layoutInfo;
-@property (nonatomic) CGFloat contentHeight;
+@property (nonatomic) NSData *monthGeometries;				// geometry of each month (MGCMonthGeometry values)
+@property (nonatomic) BOOL geometriesAreValid;				// NO when the data changed since the geometries were computed
+@property (nonatomic) NSMutableDictionary *monthAttributes;	// attributes of the elements of each month, created on demand (indexed by month)
+@property (nonatomic) CGFloat layoutWidth;					// width of the collection view when the month attributes were created
 
 @end
 
@@ -61,6 +83,148 @@ const CGFloat kMonthHeaderMargin = 3.;
 	return [self widthForColumnRange:NSMakeRange(colIndex, 1)];
 }
 
+- (NSUInteger)numberOfMonths
+{
+	return self.monthGeometries.length / sizeof(MGCMonthGeometry);
+}
+
+- (CGFloat)heightForMonthWithGeometry:(MGCMonthGeometry)geometry
+{
+	return self.monthInsets.top + geometry.numberOfRows * self.rowHeight + self.monthInsets.bottom;
+}
+
+// vertical offset of the month, or content height if month is the number of months
+- (CGFloat)yOffsetForMonthAtIndex:(NSUInteger)month
+{
+	NSUInteger numberOfMonths = self.numberOfMonths;
+	if (numberOfMonths == 0) return 0;
+	
+	const MGCMonthGeometry *geometries = self.monthGeometries.bytes;
+	NSUInteger rowsAbove = month < numberOfMonths ? geometries[month].rowsAbove : geometries[numberOfMonths - 1].rowsAbove + geometries[numberOfMonths - 1].numberOfRows;
+	return month * (self.monthInsets.top + self.monthInsets.bottom) + rowsAbove * self.rowHeight;
+}
+
+// creates the attributes of all elements of the month
+- (NSDictionary*)attributesForMonthAtIndex:(NSUInteger)month
+{
+	MGCMonthGeometry geometry = ((const MGCMonthGeometry*)self.monthGeometries.bytes)[month];
+	
+	NSMutableArray *dayCells = [NSMutableArray arrayWithCapacity:geometry.numberOfDays];
+	NSMutableDictionary *supplementaryViews = [NSMutableDictionary dictionary];
+	NSMutableArray *allElements = [NSMutableArray array];
+	
+	NSUInteger col = geometry.firstColumn;
+	NSUInteger day = 0;
+	CGFloat y = [self yOffsetForMonthAtIndex:month];
+	CGFloat totalWidth = self.collectionView.bounds.size.width - (self.monthInsets.left + self.monthInsets.right);
+	
+	CGRect monthRect = CGRectMake(0, y, self.collectionView.bounds.size.width, [self heightForMonthWithGeometry:geometry]);
+	
+	NSIndexPath *path = [NSIndexPath indexPathForItem:1 inSection:month];
+	CGRect headerFrame = CGRectMake(self.monthInsets.left, y, totalWidth, self.monthInsets.top);
+	if (self.alignMonthHeaders) {
+		CGFloat xOffset = [self widthForColumnRange:NSMakeRange(0, col)];
+		headerFrame.origin.x += (xOffset + kMonthHeaderMargin);
+		headerFrame.size.width -= (xOffset + 2*kMonthHeaderMargin);
+	}
+	UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:MonthHeaderViewKind withIndexPath:path];
+	attribs.frame = headerFrame;
+	[supplementaryViews setObject:attribs forKey:@[MonthHeaderViewKind, path]];
+	[allElements addObject:attribs];
+	
+	y += self.monthInsets.top;
+	
+	for (NSUInteger row = 0; row < geometry.numberOfRows; row++)
+	{
+		NSRange colRange = NSMakeRange(col, MIN(7 - col, geometry.numberOfDays - day));
+		
+		if (self.showEvents) {
+			NSIndexPath *path = [NSIndexPath indexPathForItem:day inSection:month];
+			UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:MonthRowViewKind withIndexPath:path];
+			CGFloat x = [self widthForColumnRange:NSMakeRange(0, col)] + self.monthInsets.left;
+			CGFloat width = [self widthForColumnRange:NSMakeRange(col, colRange.length)];
+			attribs.frame = CGRectMake(x, y + self.dayHeaderHeight, width, self.rowHeight - self.dayHeaderHeight);
+			attribs.zIndex = 1;
+			[supplementaryViews setObject:attribs forKey:@[MonthRowViewKind, path]];
+			[allElements addObject:attribs];
+		}
+		
+		for (; col < NSMaxRange(colRange); col++, day++)
+		{
+			NSIndexPath *path = [NSIndexPath indexPathForItem:day inSection:month];
+			UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:path];
+			CGFloat x = [self widthForColumnRange:NSMakeRange(0, col)] + self.monthInsets.left;
+			CGFloat width = [self widthForColumnRange:NSMakeRange(col, 1)];
+			attribs.frame = CGRectMake(x, y, width, self.rowHeight);
+			[dayCells addObject:attribs];
+			[allElements addObject:attribs];
+		}
+		
+		y += self.rowHeight;
+		col = 0;
+	}
+	
+	path = [NSIndexPath indexPathForItem:0 inSection:month];
+	attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:MonthBackgroundViewKind withIndexPath:path];
+	attribs.frame = UIEdgeInsetsInsetRect(monthRect, self.monthInsets);
+	attribs.zIndex = 2;
+	[supplementaryViews setObject:attribs forKey:@[MonthBackgroundViewKind, path]];
+	[allElements addObject:attribs];
+	
+	return @{ DayCellsKey: dayCells, SupplementaryViewsKey: supplementaryViews, AllElementsKey: allElements };
+}
+
+// returns the attributes of the elements of the month, creating them if needed
+- (NSDictionary*)layoutAttributesForMonthAtIndex:(NSUInteger)month
+{
+	if (month >= self.numberOfMonths) return nil;
+	
+	NSDictionary *attributes = [self.monthAttributes objectForKey:@(month)];
+	if (!attributes) {
+		attributes = [self attributesForMonthAtIndex:month];
+		[self.monthAttributes setObject:attributes forKey:@(month)];
+	}
+	return attributes;
+}
+
+- (void)discardMonthAttributes
+{
+	[self.monthAttributes removeAllObjects];
+}
+
+#pragma mark - Properties
+
+// all months have to be laid out again when one of the following properties changes
+
+- (void)setMonthInsets:(UIEdgeInsets)monthInsets
+{
+	_monthInsets = monthInsets;
+	[self discardMonthAttributes];
+}
+
+- (void)setRowHeight:(CGFloat)rowHeight
+{
+	_rowHeight = rowHeight;
+	[self discardMonthAttributes];
+}
+
+- (void)setDayHeaderHeight:(CGFloat)dayHeaderHeight
+{
+	_dayHeaderHeight = dayHeaderHeight;
+	[self discardMonthAttributes];
+}
+
+- (void)setAlignMonthHeaders:(BOOL)alignMonthHeaders
+{
+	_alignMonthHeaders = alignMonthHeaders;
+	[self discardMonthAttributes];
+}
+
+- (void)setShowEvents:(BOOL)showEvents
+{
+	_showEvents = showEvents;
+	[self discardMonthAttributes];
+}
 
 #pragma mark - NSObject
 
@@ -71,108 +235,100 @@ const CGFloat kMonthHeaderMargin = 3.;
 		_rowHeight = 140;
 		_dayHeaderHeight = 28;
         _showEvents = YES;
+		_monthAttributes = [NSMutableDictionary dictionary];
 	}
 	return self;
 }
 
 #pragma mark - UICollectionViewLayout
 
-- (void)prepareLayout
+// computes the geometry of each month - this is the only place where the delegate is asked for the columns of the months.
+// Attributes of a month are kept if its geometry did not change.
+- (void)updateMonthGeometries
 {
 	NSUInteger numberOfMonths = [self.collectionView numberOfSections];
-
-	NSMutableDictionary *layoutInfo = [NSMutableDictionary dictionary];
-	NSMutableDictionary *dayCellsInfo = [NSMutableDictionary dictionary];
-	NSMutableDictionary *monthsInfo = [NSMutableDictionary dictionary];
-	NSMutableDictionary *rowsInfo = [NSMutableDictionary dictionary];
 	
-	CGFloat y = 0;
-    CGFloat totalWidth = self.collectionView.bounds.size.width - (self.monthInsets.left + self.monthInsets.right);
-    
+	const MGCMonthGeometry *oldGeometries = self.monthGeometries.bytes;
+	NSUInteger oldNumberOfMonths = self.numberOfMonths;
+	
+	NSMutableData *monthGeometries = [NSMutableData dataWithLength:numberOfMonths * sizeof(MGCMonthGeometry)];
+	MGCMonthGeometry *geometries = monthGeometries.mutableBytes;
+	
+	NSUInteger rowsAbove = 0;
+	
 	for (NSUInteger month = 0; month < numberOfMonths; month++)
 	{
 		NSUInteger col = [self.delegate collectionView:self.collectionView layout:self columnForDayAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:month]];
 		NSUInteger daysInMonth = [self.collectionView numberOfItemsInSection:month];
 		NSUInteger numRows = ceil((col + daysInMonth) / 7.);
-		NSUInteger day = 0;
 		
-		CGRect monthRect = { .origin = CGPointMake(0, y) };
-        
-        NSIndexPath *path = [NSIndexPath indexPathForItem:1 inSection:month];;
-        CGRect headerFrame = CGRectMake(self.monthInsets.left, y, totalWidth, self.monthInsets.top);
-        if (self.alignMonthHeaders) {
-            CGFloat xOffset = [self widthForColumnRange:NSMakeRange(0, col)];
-            headerFrame.origin.x += (xOffset + kMonthHeaderMargin);
-            headerFrame.size.width -= (xOffset + 2*kMonthHeaderMargin);
-        }
-        UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:MonthHeaderViewKind withIndexPath:path];
-        attribs.frame = headerFrame;
-        [monthsInfo setObject:attribs forKey:path];
-        
-		y += self.monthInsets.top;
+		geometries[month] = (MGCMonthGeometry){ col, daysInMonth, numRows, rowsAbove };
 		
-		for (NSUInteger row = 0; row < numRows; row++)
-		{
-			NSRange colRange = NSMakeRange(col, MIN(7 - col, daysInMonth - day));
-			
-            if (self.showEvents) {
-                NSIndexPath *path = [NSIndexPath indexPathForItem:day inSection:month];
-                UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:MonthRowViewKind withIndexPath:path];
-                CGFloat x = [self widthForColumnRange:NSMakeRange(0, col)] + self.monthInsets.left;
-                CGFloat width = [self widthForColumnRange:NSMakeRange(col, colRange.length)];
-                attribs.frame = CGRectMake(x, y + self.dayHeaderHeight, width, self.rowHeight - self.dayHeaderHeight);
-                attribs.zIndex = 1;
-                [rowsInfo setObject:attribs forKey:path];
-            }
-
-			for (; col < NSMaxRange(colRange); col++, day++)
-			{
-				NSIndexPath *path = [NSIndexPath indexPathForItem:day inSection:month];
-				UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:path];
-				CGFloat x = [self widthForColumnRange:NSMakeRange(0, col)] + self.monthInsets.left;
-				CGFloat width = [self widthForColumnRange:NSMakeRange(col, 1)];
-				attribs.frame = CGRectMake(x, y, width, self.rowHeight);
-				[dayCellsInfo setObject:attribs forKey:path];
-			}
-			
-			y += self.rowHeight;
-			col = 0;
+		if (month >= oldNumberOfMonths || !MGCMonthGeometryEqualToGeometry(geometries[month], oldGeometries[month])) {
+			[self.monthAttributes removeObjectForKey:@(month)];
 		}
-			
-		y += self.monthInsets.bottom;
-		monthRect.size = CGSizeMake(self.collectionView.bounds.size.width, y - monthRect.origin.y);
-			
-        path = [NSIndexPath indexPathForItem:0 inSection:month];
-		attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:MonthBackgroundViewKind withIndexPath:path];
-		attribs.frame = UIEdgeInsetsInsetRect(monthRect, self.monthInsets);
-		attribs.zIndex = 2;
-		[monthsInfo setObject:attribs forKey:path];
+		
+		rowsAbove += numRows;
 	}
 	
-	self.contentHeight = y;
+	for (NSUInteger month = numberOfMonths; month < oldNumberOfMonths; month++) {
+		[self.monthAttributes removeObjectForKey:@(month)];
+	}
 	
-	[layoutInfo setObject:dayCellsInfo forKey:@"DayCellInfo"];
-	[layoutInfo setObject:monthsInfo forKey:@"MonthInfo"];
-	[layoutInfo setObject:rowsInfo forKey:@"RowsInfo"];
+	self.monthGeometries = monthGeometries;
+	self.geometriesAreValid = YES;
+}
+
+// month geometries are only computed again if the data changed - attributes are created when requested,
+// and kept until the geometry of their month changes
+- (void)prepareLayout
+{
+	if (self.collectionView.bounds.size.width != self.layoutWidth) {
+		[self discardMonthAttributes];
+		self.layoutWidth = self.collectionView.bounds.size.width;
+	}
+	
+	if (!self.geometriesAreValid) {
+		[self updateMonthGeometries];
+	}
+}
+
+- (void)invalidateLayoutWithContext:(UICollectionViewLayoutInvalidationContext*)context
+{
+	[super invalidateLayoutWithContext:context];
 	
-	self.layoutInfo = layoutInfo;
+	if (context.invalidateEverything || context.invalidateDataSourceCounts) {
+		self.geometriesAreValid = NO;
+	}
 }
 
 - (CGSize)collectionViewContentSize
 {
-	return CGSizeMake(self.collectionView.bounds.size.width, self.contentHeight);
+	return CGSizeMake(self.collectionView.bounds.size.width, [self yOffsetForMonthAtIndex:self.numberOfMonths]);
 }
 
 - (NSArray*)layoutAttributesForElementsInRect:(CGRect)rect
 {
-	NSMutableArray *allAttribs = [NSMutableArray arrayWithCapacity:self.layoutInfo.count];
+	NSMutableArray *allAttribs = [NSMutableArray array];
+	
+	NSUInteger numberOfMonths = self.numberOfMonths;
 	
-    for (NSString *kind in self.layoutInfo)
+	// binary search for the first month ending below the top of rect
+	NSUInteger first = 0, last = numberOfMonths;
+	while (first < last) {
+		NSUInteger month = (first + last) / 2;
+		if ([self yOffsetForMonthAtIndex:month + 1] <= CGRectGetMinY(rect)) {
+			first = month + 1;
+		}
+		else {
+			last = month;
+		}
+	}
+	
+	for (NSUInteger month = first; month < numberOfMonths && [self yOffsetForMonthAtIndex:month] < CGRectGetMaxY(rect); month++)
 	{
-        NSDictionary *attributesDict = [self.layoutInfo objectForKey:kind];
-        for (NSIndexPath *key in attributesDict)
+        for (UICollectionViewLayoutAttributes *attributes in [[self layoutAttributesForMonthAtIndex:month] objectForKey:AllElementsKey])
 		{
-            UICollectionViewLayoutAttributes *attributes = [attributesDict objectForKey:key];
             if (CGRectIntersectsRect(rect, attributes.frame))
 			{
 				[allAttribs addObject:attributes];
@@ -184,22 +340,14 @@ const CGFloat kMonthHeaderMargin = 3.;
 
 - (UICollectionViewLayoutAttributes*)layoutAttributesForItemAtIndexPath:(NSIndexPath*)indexPath
 {
-	NSDictionary *layout = [self.layoutInfo objectForKey:@"DayCellInfo"];
-	return [layout objectForKey:indexPath];
+	NSArray *dayCells = [[self layoutAttributesForMonthAtIndex:indexPath.section] objectForKey:DayCellsKey];
+	return indexPath.item < dayCells.count ? [dayCells objectAtIndex:indexPath.item] : nil;
 }
 
 - (UICollectionViewLayoutAttributes*)layoutAttributesForSupplementaryViewOfKind:(NSString*)kind atIndexPath:(NSIndexPath*)indexPath
 {
-	UICollectionViewLayoutAttributes *attribs = nil;
-	if ([kind isEqualToString:MonthBackgroundViewKind] || [kind isEqualToString:MonthHeaderViewKind]) {
-		NSDictionary *layout = [self.layoutInfo objectForKey:@"MonthInfo"];
-		attribs = [layout objectForKey:indexPath];
-	}
-	else if ([kind isEqualToString:MonthRowViewKind]) {
-		NSDictionary *layout = [self.layoutInfo objectForKey:@"RowsInfo"];
-		attribs = [layout objectForKey:indexPath];
-	}
-	return attribs;
+	NSDictionary *supplementaryViews = [[self layoutAttributesForMonthAtIndex:indexPath.section] objectForKey:SupplementaryViewsKey];
+	return [supplementaryViews objectForKey:@[kind, indexPath]];
 }
 
 @end
@@ -0,0 +1,63 @@
+//
+//  MGCMonthThumbnailCache.h
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import <UIKit/UIKit.h>
+
+
+// Cache of pre-rendered months, as shown by the year calendar view.
+// Thumbnails are identified by a key describing everything they depend on (month, calendar, fonts, highlighted days...),
+// and are tagged with the year they belong to.
+// The cache keeps its total cost (the memory size of the bitmaps) under totalCostLimit: when it exceeds the limit,
+// thumbnails of the years farthest from focusYear are evicted first.
+// All methods must be called on the main thread.
+@interface MGCMonthThumbnailCache : NSObject
+
+@property (nonatomic) NSUInteger totalCostLimit;		// memory budget in bytes. Default is 40 MB
+@property (nonatomic, readonly) NSUInteger totalCost;	// memory size of the cached thumbnails
+@property (nonatomic, readonly) NSUInteger count;		// number of cached thumbnails
+@property (nonatomic) NSInteger focusYear;				// year currently shown
+
+// returns the thumbnail for given key, or nil if it is not in the cache
+- (UIImage*)thumbnailForKey:(id<NSCopying>)key;
+
+// adds a thumbnail to the cache, evicting other thumbnails if needed
+- (void)setThumbnail:(UIImage*)thumbnail forKey:(id<NSCopying>)key year:(NSInteger)year;
+
+// renders a thumbnail of given size on a background queue by calling block, and adds it to the cache.
+// Does nothing if the thumbnail is already cached or being rendered.
+// The block is called in an image context with the screen scale - it must not access any view or UIScreen.
+- (void)renderThumbnailForKey:(id<NSCopying>)key year:(NSInteger)year size:(CGSize)size drawingBlock:(void (^)(CGRect rect))block;
+
+// returns YES if the thumbnail for given key is being rendered
+- (BOOL)isRenderingThumbnailForKey:(id<NSCopying>)key;
+
+- (void)removeAllThumbnails;
+
+@end
@@ -0,0 +1,192 @@
+//
+//  MGCMonthThumbnailCache.m
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import "MGCMonthThumbnailCache.h"
+
+
+static const NSUInteger kDefaultTotalCostLimit = 40 * 1024 * 1024;
+
+
+// cached thumbnail
+@interface MGCMonthThumbnail : NSObject
+
+@property (nonatomic) UIImage *image;
+@property (nonatomic) NSInteger year;
+@property (nonatomic) NSUInteger cost;
+@property (nonatomic) NSUInteger sequence;	// insertion order, the oldest thumbnail is evicted first among years at the same distance
+
+@end
+
+@implementation MGCMonthThumbnail
+@end
+
+
+@interface MGCMonthThumbnailCache ()
+
+@property (nonatomic) NSMutableDictionary *thumbnails;		// { key : MGCMonthThumbnail }
+@property (nonatomic) NSMutableSet *pendingKeys;			// keys of the thumbnails being rendered
+@property (nonatomic) dispatch_queue_t renderingQueue;
+@property (nonatomic, readwrite) NSUInteger totalCost;
+@property (nonatomic) NSUInteger sequence;
+
+@end
+
+
+@implementation MGCMonthThumbnailCache
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		[[NSNotificationCenter defaultCenter]addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+		_thumbnails = [NSMutableDictionary new];
+		_pendingKeys = [NSMutableSet new];
+		_renderingQueue = dispatch_queue_create("MGCMonthThumbnailCache.rendering", DISPATCH_QUEUE_SERIAL);
+		dispatch_set_target_queue(_renderingQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+		_totalCostLimit = kDefaultTotalCostLimit;
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter]removeObserver:self];
+}
+
+- (NSUInteger)count
+{
+	return self.thumbnails.count;
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit
+{
+	_totalCostLimit = totalCostLimit;
+	[self evictThumbnailsIfNeeded];
+}
+
+- (UIImage*)thumbnailForKey:(id<NSCopying>)key
+{
+	MGCMonthThumbnail *thumbnail = [self.thumbnails objectForKey:key];
+	return thumbnail.image;
+}
+
+- (void)setThumbnail:(UIImage*)image forKey:(id<NSCopying>)key year:(NSInteger)year
+{
+	NSParameterAssert(image && key);
+	
+	[self removeThumbnailForKey:key];
+	
+	MGCMonthThumbnail *thumbnail = [MGCMonthThumbnail new];
+	thumbnail.image = image;
+	thumbnail.year = year;
+	thumbnail.cost = image.size.width * image.scale * image.size.height * image.scale * 4;
+	thumbnail.sequence = self.sequence++;
+	
+	[self.thumbnails setObject:thumbnail forKey:key];
+	self.totalCost += thumbnail.cost;
+	
+	[self evictThumbnailsIfNeeded];
+}
+
+- (void)removeThumbnailForKey:(id<NSCopying>)key
+{
+	MGCMonthThumbnail *thumbnail = [self.thumbnails objectForKey:key];
+	if (thumbnail) {
+		self.totalCost -= thumbnail.cost;
+		[self.thumbnails removeObjectForKey:key];
+	}
+}
+
+- (void)removeAllThumbnails
+{
+	[self.thumbnails removeAllObjects];
+	self.totalCost = 0;
+}
+
+// evicts the thumbnails farthest from focusYear (and the oldest among them) until the cost is within the limit
+- (void)evictThumbnailsIfNeeded
+{
+	while (self.totalCost > self.totalCostLimit && self.thumbnails.count > 0) {
+		id evictedKey = nil;
+		NSInteger maxDistance = -1;
+		NSUInteger minSequence = NSUIntegerMax;
+		
+		for (id key in self.thumbnails) {
+			MGCMonthThumbnail *thumbnail = [self.thumbnails objectForKey:key];
+			NSInteger distance = labs(thumbnail.year - self.focusYear);
+			if (distance > maxDistance || (distance == maxDistance && thumbnail.sequence < minSequence)) {
+				evictedKey = key;
+				maxDistance = distance;
+				minSequence = thumbnail.sequence;
+			}
+		}
+		[self removeThumbnailForKey:evictedKey];
+	}
+}
+
+- (BOOL)isRenderingThumbnailForKey:(id<NSCopying>)key
+{
+	return [self.pendingKeys containsObject:key];
+}
+
+- (void)renderThumbnailForKey:(id<NSCopying>)key year:(NSInteger)year size:(CGSize)size drawingBlock:(void (^)(CGRect rect))block
+{
+	if ([self thumbnailForKey:key] || [self isRenderingThumbnailForKey:key] || size.width <= 0 || size.height <= 0) {
+		return;
+	}
+	
+	[self.pendingKeys addObject:key];
+	
+	CGFloat scale = [UIScreen mainScreen].scale;
+	
+	__weak typeof(self) weakSelf = self;
+	dispatch_async(self.renderingQueue, ^{
+		UIGraphicsBeginImageContextWithOptions(size, NO, scale);
+		block((CGRect){ CGPointZero, size });
+		UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+		UIGraphicsEndImageContext();
+		
+		dispatch_async(dispatch_get_main_queue(), ^{
+			MGCMonthThumbnailCache *cache = weakSelf;
+			[cache.pendingKeys removeObject:key];
+			if (image) {
+				[cache setThumbnail:image forKey:key year:year];
+			}
+		});
+	});
+}
+
+#pragma mark - Notifications
+
+- (void)didReceiveMemoryWarning:(NSNotification*)notification
+{
+	[self removeAllThumbnails];
+}
+
+@end
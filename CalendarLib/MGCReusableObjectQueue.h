@@ -53,6 +53,10 @@
 /*!
  * Implements a queue allowing expensive objects like UIViews to be reused,
  * in order to reduce memory allocations.
+ * Unused objects are kept in one stack per identifier, so the most recently used object is reused first.
+ * The size of each stack can be bounded with watermarks: objects enqueued above the high watermark
+ * are released, and memory warnings trim the stacks down to their low watermark, a few objects at a time
+ * when the main run loop is idle.
  */
 @interface MGCReusableObjectQueue : NSObject
 
@@ -62,10 +66,28 @@
 /*! Returns the total number of objects that were allocated by this queue - for debugging purposes */
 @property (readonly) NSUInteger totalCreated;
 
+/*! Returns the number of dequeued objects that were taken from the queue - for tuning purposes */
+@property (readonly) NSUInteger hits;
+
+/*! Returns the number of dequeued objects that had to be allocated because the queue was empty - for tuning purposes */
+@property (readonly) NSUInteger misses;
+
+/*! Maximum number of unused objects kept for an identifier, unless set with setLowWatermark:highWatermark:forReuseIdentifier:.
+ *	The default is NSUIntegerMax (no limit).
+ */
+@property (nonatomic) NSUInteger highWatermark;
+
+/*! Number of unused objects kept for an identifier when receiving a memory warning, unless set with setLowWatermark:highWatermark:forReuseIdentifier:.
+ *	The default is 0 (all unused objects are released).
+ */
+@property (nonatomic) NSUInteger lowWatermark;
+
 /*! Returns a default shared queue. */
 + (instancetype)defaultQueue;
 
-/*! Enqueues an object, making it available for reuse. */
+/*! Enqueues an object, making it available for reuse.
+ *	The object is released instead if the queue already holds highWatermark objects with the same identifier.
+ */
 - (void)enqueueReusableObject:(id<MGCReusableObject>)object;
 
 /*! Returns an object whose class was previously registered with given identifier.
@@ -78,6 +100,21 @@
  */
 - (void)registerClass:(Class)objectClass forObjectWithReuseIdentifier:(NSString*)identifier;
 
+/*! Sets the watermarks for objects with given identifier, overriding the default values of the queue. */
+- (void)setLowWatermark:(NSUInteger)lowWatermark highWatermark:(NSUInteger)highWatermark forReuseIdentifier:(NSString*)identifier;
+
+/*! Allocates objects with given identifier until the queue holds count of them.
+ *	Objects are created a few at a time on the main thread, when the run loop is about to wait,
+ *	so that prewarming does not delay scrolling or animations.
+ */
+- (void)prewarm:(NSString*)identifier count:(NSUInteger)count;
+
+/*! Returns the number of unused objects with given identifier currently stored in the queue. */
+- (NSUInteger)countForReuseIdentifier:(NSString*)identifier;
+
+/*! Removes unused objects from the queue, keeping at most the low watermark of each identifier. */
+- (void)trimToLowWatermarks;
+
 /*! Removes all unused objects from the queue. */
 - (void)removeAllObjects;
 
@@ -31,11 +31,88 @@
 #import "MGCReusableObjectQueue.h"
 
 
+static const NSUInteger kPrewarmBatchSize = 4;	// number of objects created per identifier each time the run loop is idle
+static const NSUInteger kTrimBatchSize = 8;		// number of objects released per identifier each time the run loop is idle
+
+
+// unused objects with the same identifier
+@interface MGCReusableObjectPool : NSObject
+
+@property (nonatomic) Class objectClass;
+@property (nonatomic, readonly) NSMutableArray *objects;	// stack of unused objects, most recently enqueued last
+@property (nonatomic, readonly) NSHashTable *members;		// same objects as the stack, compared by pointer, for fast lookup
+@property (nonatomic) BOOL hasWatermarks;					// YES if watermarks were set for this pool, otherwise those of the queue are used
+@property (nonatomic) NSUInteger lowWatermark;
+@property (nonatomic) NSUInteger highWatermark;
+@property (nonatomic) NSUInteger prewarmCount;				// number of objects to reach when prewarming, 0 if not prewarming
+@property (nonatomic) BOOL trimming;						// YES if objects above the low watermark are being released
+
+@end
+
+
+@implementation MGCReusableObjectPool
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		_objects = [NSMutableArray array];
+		_members = [[NSHashTable alloc]initWithOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality capacity:0];
+	}
+	return self;
+}
+
+- (NSUInteger)count
+{
+	return self.objects.count;
+}
+
+- (BOOL)containsObject:(id)object
+{
+	return [self.members containsObject:object];
+}
+
+- (void)pushObject:(id)object
+{
+	[self.objects addObject:object];
+	[self.members addObject:object];
+}
+
+- (id)popObject
+{
+	id object = [self.objects lastObject];
+	if (object) {
+		[self.objects removeLastObject];
+		[self.members removeObject:object];
+	}
+	return object;
+}
+
+// removes the count least recently enqueued objects
+- (void)removeOldestObjects:(NSUInteger)count
+{
+	count = MIN(count, self.objects.count);
+	for (NSUInteger i = 0; i < count; i++) {
+		[self.members removeObject:[self.objects objectAtIndex:i]];
+	}
+	[self.objects removeObjectsInRange:NSMakeRange(0, count)];
+}
+
+- (void)removeAllObjects
+{
+	[self.objects removeAllObjects];
+	[self.members removeAllObjects];
+}
+
+@end
+
+
 @interface MGCReusableObjectQueue ()
 
-@property (nonatomic) NSMutableDictionary *reusableObjectsSets;
-@property (nonatomic) NSMutableDictionary *objectClasses;
+@property (nonatomic) NSMutableDictionary *pools;			// [ { identifier : MGCReusableObjectPool }, ... ]
 @property (nonatomic, readwrite) NSUInteger totalCreated;
+@property (nonatomic, readwrite) NSUInteger hits;
+@property (nonatomic, readwrite) NSUInteger misses;
+@property (nonatomic) CFRunLoopObserverRef idleObserver;	// observer creating or releasing objects when the main run loop is idle
 
 @end
 
@@ -46,9 +123,10 @@
 - (instancetype)init
 {
 	if (self = [super init]) {
-        [[NSNotificationCenter defaultCenter]addObserver:self selector:@selector(removeAllObjects) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
-		_reusableObjectsSets = [NSMutableDictionary new];
-		_objectClasses = [NSMutableDictionary new];
+        [[NSNotificationCenter defaultCenter]addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+		_pools = [NSMutableDictionary new];
+		_highWatermark = NSUIntegerMax;
+		_lowWatermark = 0;
     }
     return self;
 }
@@ -57,6 +135,7 @@
 - (void)dealloc
 {
     [[NSNotificationCenter defaultCenter]removeObserver:self];
+	[self stopIdleObserver];
 }
 
 + (instancetype)defaultQueue
@@ -74,49 +153,85 @@
 - (NSUInteger)count
 {
 	NSUInteger count = 0;
-	for (NSString *identifier in self.reusableObjectsSets) {
-		NSMutableSet *set = [self.reusableObjectsSets objectForKey:identifier];
-		count += set.count;
+	for (NSString *identifier in self.pools) {
+		MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+		count += pool.count;
 	}
 	return count;
 }
 
+- (NSUInteger)countForReuseIdentifier:(NSString*)identifier
+{
+	MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+	return pool.count;
+}
+
+- (NSUInteger)lowWatermarkForPool:(MGCReusableObjectPool*)pool
+{
+	return pool.hasWatermarks ? pool.lowWatermark : self.lowWatermark;
+}
+
+- (NSUInteger)highWatermarkForPool:(MGCReusableObjectPool*)pool
+{
+	return pool.hasWatermarks ? pool.highWatermark : self.highWatermark;
+}
+
 - (void)registerClass:(Class)objectClass forObjectWithReuseIdentifier:(NSString*)identifier
 {
     if (objectClass) {
-        NSMutableSet *set = [self.reusableObjectsSets objectForKey:identifier];
-		if (!set) {
-			set = [NSMutableSet set];
-			[self.reusableObjectsSets setObject:set forKey:identifier];
-			[self.objectClasses setObject:NSStringFromClass(objectClass) forKey:identifier];
+        MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+		if (!pool) {
+			pool = [MGCReusableObjectPool new];
+			pool.objectClass = objectClass;
+			[self.pools setObject:pool forKey:identifier];
 		}
     }
 	else {
-        [self.objectClasses removeObjectForKey:identifier];
-		[self.reusableObjectsSets removeObjectForKey:identifier];
+		[self.pools removeObjectForKey:identifier];
     }
 }
 
+- (void)setLowWatermark:(NSUInteger)lowWatermark highWatermark:(NSUInteger)highWatermark forReuseIdentifier:(NSString*)identifier
+{
+	NSAssert(lowWatermark <= highWatermark, @"low watermark must not be greater than high watermark");
+	
+	MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+	pool.hasWatermarks = YES;
+	pool.lowWatermark = lowWatermark;
+	pool.highWatermark = highWatermark;
+	
+	if (pool.count > highWatermark) {
+		[pool removeOldestObjects:pool.count - highWatermark];
+	}
+}
+
 - (void)enqueueReusableObject:(id<MGCReusableObject>)object
 {
-	[[self.reusableObjectsSets objectForKey:object.reuseIdentifier]addObject:object];
+	MGCReusableObjectPool *pool = [self.pools objectForKey:object.reuseIdentifier];
+	
+	// the same object could be enqueued twice
+	if (pool.count < [self highWatermarkForPool:pool] && ![pool containsObject:object]) {
+		[pool pushObject:object];
+	}
 }
 
 - (id<MGCReusableObject>)dequeueReusableObjectWithReuseIdentifier:(NSString *)identifier
 {
-    id<MGCReusableObject> object = [[self.reusableObjectsSets objectForKey:identifier] anyObject];
+	MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+	
+    id<MGCReusableObject> object = [pool popObject];
     if (object) {
-		[[self.reusableObjectsSets objectForKey:identifier] removeObject:object];
 		if ([object respondsToSelector:@selector(prepareForReuse)]) {
 			[object prepareForReuse];
 		}
+		self.hits++;
 	}
 	else {
         object = [self newObjectWithReuseIdentifier:identifier];
         if (!object) {
             [NSException raise:@"Reuse queue exception" format:@"No class was registered for identifier %@", identifier];
         }
-		self.totalCreated++;
+		self.misses++;
     }
     
     return object;
@@ -124,20 +239,139 @@
 
 - (id<MGCReusableObject>)newObjectWithReuseIdentifier:(NSString*)identifier
 {
-    NSString *class = [self.objectClasses objectForKey:identifier];
-    if (class) {
-        Class objectClass = NSClassFromString(class);
-        id object = [[objectClass alloc]init];
+	MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+    if (pool) {
+        id object = [[pool.objectClass alloc]init];
         [object setReuseIdentifier:identifier];
+		self.totalCreated++;
 		return object;
 	}
 	
 	return nil;
 }
 
+#pragma mark - Idle work
+
+- (void)prewarm:(NSString*)identifier count:(NSUInteger)count
+{
+	MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+	if (!pool) {
+		[NSException raise:@"Reuse queue exception" format:@"No class was registered for identifier %@", identifier];
+	}
+	
+	pool.trimming = NO;
+	pool.prewarmCount = MIN(count, [self highWatermarkForPool:pool]);
+	if (pool.count < pool.prewarmCount) {
+		[self startIdleObserver];
+	}
+}
+
+- (void)startIdleObserver
+{
+	if (self.idleObserver) return;
+	
+	// only in default mode, so that nothing is created or released while tracking touches
+	__weak typeof(self) weakSelf = self;
+	self.idleObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopBeforeWaiting, true, 0, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+		[weakSelf idleBatch];
+	});
+	CFRunLoopAddObserver(CFRunLoopGetMain(), self.idleObserver, kCFRunLoopDefaultMode);
+	CFRunLoopWakeUp(CFRunLoopGetMain());
+}
+
+- (void)stopIdleObserver
+{
+	if (self.idleObserver) {
+		CFRunLoopObserverInvalidate(self.idleObserver);
+		CFRelease(self.idleObserver);
+		self.idleObserver = NULL;
+	}
+}
+
+// creates or releases a few objects for each identifier being prewarmed or trimmed
+- (void)idleBatch
+{
+	BOOL done = YES;
+	
+	for (NSString *identifier in self.pools) {
+		MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+		
+		if (pool.trimming) {
+			NSUInteger lowWatermark = [self lowWatermarkForPool:pool];
+			if (pool.count > lowWatermark) {
+				[pool removeOldestObjects:MIN(kTrimBatchSize, pool.count - lowWatermark)];
+			}
+			pool.trimming = pool.count > lowWatermark;
+		}
+		
+		for (NSUInteger i = 0; i < kPrewarmBatchSize && pool.count < pool.prewarmCount; i++) {
+			[pool pushObject:[self newObjectWithReuseIdentifier:identifier]];
+		}
+		
+		if (pool.count < pool.prewarmCount || pool.trimming) {
+			done = NO;
+		}
+		else {
+			pool.prewarmCount = 0;
+		}
+	}
+	
+	if (done) {
+		[self stopIdleObserver];
+	}
+	else {
+		// make sure the run loop comes back to us before going to sleep again
+		CFRunLoopWakeUp(CFRunLoopGetMain());
+	}
+}
+
+#pragma mark - Trimming
+
+// releasing many views at once can block the main thread for a noticeable time,
+// so they are released a few at a time when the run loop is idle, least recently used first
+- (void)didReceiveMemoryWarning:(NSNotification*)notification
+{
+	BOOL trimming = NO;
+	for (NSString *identifier in self.pools) {
+		MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+		pool.prewarmCount = 0;
+		pool.trimming = pool.count > [self lowWatermarkForPool:pool];
+		trimming |= pool.trimming;
+	}
+	
+	if (trimming) {
+		[self startIdleObserver];
+	}
+	else {
+		[self stopIdleObserver];
+	}
+}
+
+- (void)trimToLowWatermarks
+{
+	for (NSString *identifier in self.pools) {
+		MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+		NSUInteger lowWatermark = [self lowWatermarkForPool:pool];
+		
+		// release least recently used objects first
+		if (pool.count > lowWatermark) {
+			[pool removeOldestObjects:pool.count - lowWatermark];
+		}
+		pool.prewarmCount = 0;
+		pool.trimming = NO;
+	}
+	[self stopIdleObserver];
+}
+
 - (void)removeAllObjects
 {
-    [self.reusableObjectsSets removeAllObjects];
+	for (NSString *identifier in self.pools) {
+		MGCReusableObjectPool *pool = [self.pools objectForKey:identifier];
+		[pool removeAllObjects];
+		pool.prewarmCount = 0;
+		pool.trimming = NO;
+	}
+	[self stopIdleObserver];
 }
 
 
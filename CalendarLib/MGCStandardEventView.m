@@ -31,12 +31,138 @@
 #import "MGCStandardEventView.h"
 
 static CGFloat kSpace = 2;
+static const NSUInteger kTextLayoutCacheSize = 500;	// maximum number of text layouts kept in the shared cache
+
+
+// everything the text of the view depends on
+@interface MGCEventTextLayoutKey : NSObject
+
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic, copy) NSString *subtitle;
+@property (nonatomic, copy) NSString *detail;
+@property (nonatomic) MGCStandardEventViewStyle style;
+@property (nonatomic) UIFont *font;
+@property (nonatomic) UIColor *color;		// text color - depends on selection
+@property (nonatomic) CGFloat width;
+
+@end
+
+
+@implementation MGCEventTextLayoutKey
+
+- (BOOL)isEqual:(id)object
+{
+	if (self == object) return YES;
+	if (![object isKindOfClass:[MGCEventTextLayoutKey class]]) return NO;
+	
+	MGCEventTextLayoutKey *key = object;
+	return self.width == key.width && self.style == key.style &&
+		(self.title == key.title || [self.title isEqualToString:key.title]) &&
+		(self.subtitle == key.subtitle || [self.subtitle isEqualToString:key.subtitle]) &&
+		(self.detail == key.detail || [self.detail isEqualToString:key.detail]) &&
+		[self.font isEqual:key.font] && [self.color isEqual:key.color];
+}
+
+- (NSUInteger)hash
+{
+	return self.title.hash ^ (self.subtitle.hash * 31) ^ (self.detail.hash * 17) ^ (self.style << 24) ^ (NSUInteger)self.width;
+}
+
+@end
+
+
+// attributed string ready to be drawn, with its height for a given width.
+// Immutable once created, since layouts are shared by the main thread and the background rendering queue.
+@interface MGCEventTextLayout : NSObject
+
+@property (nonatomic, readonly) NSAttributedString *string;
+@property (nonatomic, readonly) CGFloat height;
+@property (nonatomic, readonly) NSAttributedString *singleLineString;	// string with line breaks replaced by spaces, used when the text does not fit
+
+- (instancetype)initWithString:(NSAttributedString*)string width:(CGFloat)width;
+
+@end
+
+
+@implementation MGCEventTextLayout
+
+- (instancetype)initWithString:(NSAttributedString*)string width:(CGFloat)width
+{
+	if (self = [super init]) {
+		_string = [string copy];
+		_height = [string boundingRectWithSize:CGSizeMake(width, CGFLOAT_MAX) options:NSStringDrawingUsesLineFragmentOrigin context:nil].size.height;
+		
+		NSMutableAttributedString *as = [string mutableCopy];
+		[as.mutableString replaceOccurrencesOfString:@"\n" withString:@"  " options:NSCaseInsensitiveSearch range:NSMakeRange(0, as.length)];
+		_singleLineString = as;
+	}
+	return self;
+}
+
+@end
+
+
+// attributed string ready to be drawn, with its height for a given width
+@interface MGCEventTextLayout : NSObject
+
+@property (nonatomic) NSAttributedString *string;
+@property (nonatomic) CGFloat height;
+@property (nonatomic, readonly) NSAttributedString *singleLineString;	// string with line breaks replaced by spaces, used when the text does not fit (created lazily)
+
+@end
+
+
+@implementation MGCEventTextLayout
+
+@synthesize singleLineString = _singleLineString;
+
+- (NSAttributedString*)singleLineString
+{
+	// layouts can be used from the background rendering queue
+	@synchronized (self) {
+		if (!_singleLineString) {
+			NSMutableAttributedString *as = [self.string mutableCopy];
+			[as.mutableString replaceOccurrencesOfString:@"\n" withString:@"  " options:NSCaseInsensitiveSearch range:NSMakeRange(0, as.length)];
+			_singleLineString = as;
+		}
+		return _singleLineString;
+	}
+}
+
+@end
+
+
+// content drawn by the view, for background rendering
+@interface MGCStandardEventViewContent : NSObject
+
+@property (nonatomic) MGCEventTextLayoutKey *textKey;
+@property (nonatomic) CGFloat visibleHeight;
+
+@end
+
+
+@implementation MGCStandardEventViewContent
+
+- (BOOL)isEqual:(id)object
+{
+	if (self == object) return YES;
+	if (![object isKindOfClass:[MGCStandardEventViewContent class]]) return NO;
+	
+	MGCStandardEventViewContent *content = object;
+	return self.visibleHeight == content.visibleHeight && [self.textKey isEqual:content.textKey];
+}
+
+- (NSUInteger)hash
+{
+	return self.textKey.hash ^ ((NSUInteger)self.visibleHeight << 8);
+}
+
+@end
 
 
 @interface MGCStandardEventView ()
 
 @property (nonatomic) UIView *leftBorderView;
-@property (nonatomic) NSMutableAttributedString *attrString;
 
 @end
 
@@ -58,49 +184,128 @@ static CGFloat kSpace = 2;
     return self;
 }
 
-- (void)redrawStringInRect:(CGRect)rect
+// text layouts shared by all views
++ (NSCache*)textLayoutCache
+{
+	static NSCache *cache;
+	static dispatch_once_t onceToken;
+	
+	dispatch_once(&onceToken, ^{
+		cache = [NSCache new];
+		cache.countLimit = kTextLayoutCacheSize;
+	});
+	return cache;
+}
+
+// bold and small variants of the fonts, created once per font
++ (UIFont*)fontWithFont:(UIFont*)font bold:(BOOL)bold
+{
+	static NSCache *cache;
+	static dispatch_once_t onceToken;
+	
+	dispatch_once(&onceToken, ^{
+		cache = [NSCache new];
+	});
+	
+	NSArray *fonts = [cache objectForKey:font];
+	if (!fonts) {
+		UIFont *boldFont = [UIFont fontWithDescriptor:[[font fontDescriptor] fontDescriptorWithSymbolicTraits:UIFontDescriptorTraitBold] size:font.pointSize];
+		UIFont *smallFont = [UIFont fontWithDescriptor:[font fontDescriptor] size:font.pointSize - 2];
+		fonts = @[ boldFont ?: font, smallFont ?: font ];
+		[cache setObject:fonts forKey:font];
+	}
+	return bold ? fonts[0] : fonts[1];
+}
+
+- (MGCEventTextLayoutKey*)textLayoutKeyForWidth:(CGFloat)width
+{
+	MGCEventTextLayoutKey *key = [MGCEventTextLayoutKey new];
+	key.title = self.title;
+	key.subtitle = self.subtitle;
+	key.detail = self.detail;
+	key.style = self.style;
+	key.font = self.font;
+	key.color = self.selected ? [UIColor whiteColor] : self.color;
+	key.width = width;
+	return key;
+}
+
+// this can be called from a background queue
++ (MGCEventTextLayout*)textLayoutForKey:(MGCEventTextLayoutKey*)key
+{
+	NSCache *cache = [MGCStandardEventView textLayoutCache];
+	MGCEventTextLayout *layout = [cache objectForKey:key];
+	if (!layout) {
+		// fully built before being shared through the cache
+		layout = [[MGCEventTextLayout alloc]initWithString:[self attributedStringForKey:key] width:key.width];
+		[cache setObject:layout forKey:key];
+	}
+	return layout;
+}
+
++ (NSAttributedString*)attributedStringForKey:(MGCEventTextLayoutKey*)key
 {
 	// attributed string can't be created with nil string
 	NSMutableString *s = [NSMutableString stringWithString:@""];
 	
-	if (self.style & MGCStandardEventViewStyleDot) {
+	if (key.style & MGCStandardEventViewStyleDot) {
 		[s appendString:@"\u2022 "]; // 25CF // 2219 // 30FB
 	}
 	
-	if (self.title) {
-		[s appendString:self.title];
+	if (key.title) {
+		[s appendString:key.title];
 	}
 	
-	UIFont *boldFont = [UIFont fontWithDescriptor:[[self.font fontDescriptor] fontDescriptorWithSymbolicTraits:UIFontDescriptorTraitBold] size:self.font.pointSize];
-	NSMutableAttributedString *as = [[NSMutableAttributedString alloc]initWithString:s attributes:@{NSFontAttributeName: boldFont ?: self.font }];
+	UIFont *boldFont = [MGCStandardEventView fontWithFont:key.font bold:YES];
+	NSMutableAttributedString *as = [[NSMutableAttributedString alloc]initWithString:s attributes:@{NSFontAttributeName: boldFont }];
 	
-	if (self.subtitle && self.subtitle.length > 0 && self.style & MGCStandardEventViewStyleSubtitle) {
-		NSMutableString *s  = [NSMutableString stringWithFormat:@"\n%@", self.subtitle];
-		NSMutableAttributedString *subtitle = [[NSMutableAttributedString alloc]initWithString:s attributes:@{NSFontAttributeName:self.font}];
+	if (key.subtitle && key.subtitle.length > 0 && key.style & MGCStandardEventViewStyleSubtitle) {
+		NSMutableString *s  = [NSMutableString stringWithFormat:@"\n%@", key.subtitle];
+		NSMutableAttributedString *subtitle = [[NSMutableAttributedString alloc]initWithString:s attributes:@{NSFontAttributeName:key.font}];
 		[as appendAttributedString:subtitle];
 	}
 	
-	if (self.detail && self.detail.length > 0 && self.style & MGCStandardEventViewStyleDetail) {
-		UIFont *smallFont = [UIFont fontWithDescriptor:[self.font fontDescriptor] size:self.font.pointSize - 2];
-		NSMutableString *s = [NSMutableString stringWithFormat:@"\t%@", self.detail];
+	if (key.detail && key.detail.length > 0 && key.style & MGCStandardEventViewStyleDetail) {
+		UIFont *smallFont = [MGCStandardEventView fontWithFont:key.font bold:NO];
+		NSMutableString *s = [NSMutableString stringWithFormat:@"\t%@", key.detail];
 		NSMutableAttributedString *detail = [[NSMutableAttributedString alloc]initWithString:s attributes:@{NSFontAttributeName:smallFont}];
 		[as appendAttributedString:detail];
 	}
 	
-	NSTextTab *t = [[NSTextTab alloc]initWithTextAlignment:NSTextAlignmentRight location:rect.size.width options:[[NSDictionary alloc] init]];
+	NSTextTab *t = [[NSTextTab alloc]initWithTextAlignment:NSTextAlignmentRight location:key.width options:[[NSDictionary alloc] init]];
 	NSMutableParagraphStyle *style = [NSMutableParagraphStyle new];
 	style.tabStops = @[t];
 	//style.hyphenationFactor = .4;
 	//style.lineBreakMode = NSLineBreakByTruncatingMiddle;
 	[as addAttribute:NSParagraphStyleAttributeName value:style range:NSMakeRange(0, as.length)];
 	
-	UIColor *color = self.selected ? [UIColor whiteColor] : self.color;
-	[as addAttribute:NSForegroundColorAttributeName value:color range:NSMakeRange(0, as.length)];
+	[as addAttribute:NSForegroundColorAttributeName value:key.color range:NSMakeRange(0, as.length)];
 	
-	self.attrString = as;
+	return as;
 }
 
 
+// rect where the text is drawn in given bounds
++ (CGRect)textRectForRect:(CGRect)rect style:(MGCStandardEventViewStyle)style
+{
+	CGRect drawRect = CGRectInset(rect, kSpace, 0);
+	if (style & MGCStandardEventViewStyleBorder) {
+		drawRect.origin.x += kSpace;
+		drawRect.size.width -= kSpace;
+	}
+	return drawRect;
+}
+
+// this can be called from a background queue
++ (void)drawTextWithKey:(MGCEventTextLayoutKey*)key inRect:(CGRect)drawRect visibleHeight:(CGFloat)visibleHeight
+{
+	MGCEventTextLayout *layout = [self textLayoutForKey:key];
+	drawRect.size.height = fminf(drawRect.size.height, visibleHeight);
+	
+	NSAttributedString *string = layout.height > drawRect.size.height ? layout.singleLineString : layout.string;
+	[string drawWithRect:drawRect options:NSStringDrawingTruncatesLastVisibleLine|NSStringDrawingUsesLineFragmentOrigin context:nil];
+}
+
 - (void)layoutSubviews
 {
 	[super layoutSubviews];
@@ -155,22 +360,28 @@ static CGFloat kSpace = 2;
 
 - (void)drawRect:(CGRect)rect
 {
-	CGRect drawRect = CGRectInset(rect, kSpace, 0);
-	if (self.style & MGCStandardEventViewStyleBorder) {
-		drawRect.origin.x += kSpace;
-		drawRect.size.width -= kSpace;
-	}
-	
-	[self redrawStringInRect:drawRect];
+	if ([self drawRenderedContentInRect:rect]) return;
 	
-	CGRect boundingRect = [self.attrString boundingRectWithSize:CGSizeMake(drawRect.size.width, CGFLOAT_MAX) options:NSStringDrawingUsesLineFragmentOrigin context:nil];
-	drawRect.size.height = fminf(drawRect.size.height, self.visibleHeight);
+	CGRect drawRect = [MGCStandardEventView textRectForRect:rect style:self.style];
+	[MGCStandardEventView drawTextWithKey:[self textLayoutKeyForWidth:drawRect.size.width] inRect:drawRect visibleHeight:self.visibleHeight];
+}
+
+#pragma mark - Background rendering
+
+- (id)contentForBackgroundRenderingWithSize:(CGSize)size
+{
+	CGRect drawRect = [MGCStandardEventView textRectForRect:CGRectMake(0, 0, size.width, size.height) style:self.style];
 	
-	if (boundingRect.size.height > drawRect.size.height) {
-		[self.attrString.mutableString replaceOccurrencesOfString:@"\n" withString:@"  " options:NSCaseInsensitiveSearch range:NSMakeRange(0, self.attrString.length)];
-	}
+	MGCStandardEventViewContent *content = [MGCStandardEventViewContent new];
+	content.textKey = [self textLayoutKeyForWidth:drawRect.size.width];
+	content.visibleHeight = fmin(self.visibleHeight, size.height);
+	return content;
+}
 
-	[self.attrString drawWithRect:drawRect options:NSStringDrawingTruncatesLastVisibleLine|NSStringDrawingUsesLineFragmentOrigin context:nil];
++ (void)drawBackgroundRenderingContent:(MGCStandardEventViewContent*)content inRect:(CGRect)rect
+{
+	CGRect drawRect = [self textRectForRect:rect style:content.textKey.style];
+	[self drawTextWithKey:content.textKey inRect:drawRect visibleHeight:content.visibleHeight];
 }
 
 #pragma mark - NSCopying protocol
@@ -33,10 +33,18 @@
 #import "MGCAlignedGeometry.h"
 
 
+static const CGFloat kSpacing = 5.;		// horizontal space around time marks
+
+
 @interface MGCTimeRowsView()
 
 @property (nonatomic) NSTimer *timer;
 @property (nonatomic) NSUInteger rounding;
+@property (nonatomic) NSMutableDictionary *hourMarkImages;	// rendered hour marks, indexed by hour - the view is redrawn on each step of a pinch
+@property (nonatomic) NSMutableArray *hourMarkLayers;		// layers showing the hour marks, from first to last hour of hourRange
+@property (nonatomic) CALayer *currentTimeLayer;			// current time mark
+@property (nonatomic) CALayer *currentTimeLineLayer;		// current time line
+@property (nonatomic) CALayer *timeMarkLayer;				// floating time mark
 
 @end
 
@@ -57,6 +65,19 @@
 		_currentTimeColor = [UIColor redColor];
 		_rounding = 15;
 		_hourRange = NSMakeRange(0, 24);
+		_hourMarkImages = [NSMutableDictionary dictionary];
+		_hourMarkLayers = [NSMutableArray array];
+		
+		// only the grid is drawn by the view - time marks and current time line are layers on top of it,
+		// so that they can move without redrawing everything
+		_currentTimeLayer = [CALayer layer];
+		_currentTimeLineLayer = [CALayer layer];
+		_timeMarkLayer = [CALayer layer];
+		for (CALayer *layer in @[ _currentTimeLayer, _currentTimeLineLayer, _timeMarkLayer ]) {
+			layer.hidden = YES;
+			layer.actions = @{ @"position": [NSNull null], @"bounds": [NSNull null], @"contents": [NSNull null], @"hidden": [NSNull null] };
+			[self.layer addSublayer:layer];
+		}
 		
 		self.showsCurrentTime = YES;
 	}
@@ -72,7 +93,7 @@
 		self.timer = [NSTimer scheduledTimerWithTimeInterval:60 target:self selector:@selector(timeChanged:) userInfo:nil repeats:YES];
 	}
 	
-	[self setNeedsDisplay];
+	[self updateCurrentTime];
 }
 
 - (BOOL)showsHalfHourLines
@@ -80,21 +101,79 @@
 	return self.hourSlotHeight > 100;
 }
 
+// the grid has to be drawn again when one of the following properties changes
+
 - (void)setHourRange:(NSRange)hourRange
 {
     NSAssert(hourRange.length >= 1 && NSMaxRange(hourRange) <= 24, @"Invalid hour range %@", NSStringFromRange(hourRange));
     _hourRange = hourRange;
+	[self setNeedsDisplay];
+	[self setNeedsLayout];
+}
+
+- (void)setHourSlotHeight:(CGFloat)hourSlotHeight
+{
+	_hourSlotHeight = hourSlotHeight;
+	[self setNeedsDisplay];
+	[self setNeedsLayout];
+}
+
+- (void)setInsetsHeight:(CGFloat)insetsHeight
+{
+	_insetsHeight = insetsHeight;
+	[self setNeedsDisplay];
+	[self setNeedsLayout];
+}
+
+// hour marks have to be rendered again when one of the following properties changes
+
+- (void)setFont:(UIFont*)font
+{
+	_font = font;
+	[self.hourMarkImages removeAllObjects];
+	[self setNeedsLayout];
+}
+
+- (void)setTimeColor:(UIColor*)timeColor
+{
+	_timeColor = timeColor;
+	[self.hourMarkImages removeAllObjects];
+	[self setNeedsDisplay];
+	[self setNeedsLayout];
+}
+
+- (void)setTimeColumnWidth:(CGFloat)timeColumnWidth
+{
+	if (timeColumnWidth != _timeColumnWidth) {
+		_timeColumnWidth = timeColumnWidth;
+		[self.hourMarkImages removeAllObjects];
+		[self setNeedsDisplay];
+		[self setNeedsLayout];
+	}
+}
+
+- (void)setDelegate:(id<MGCTimeRowsViewDelegate>)delegate
+{
+	_delegate = delegate;
+	[self.hourMarkImages removeAllObjects];
+	[self setNeedsLayout];
+}
+
+- (void)setCurrentTimeColor:(UIColor*)currentTimeColor
+{
+	_currentTimeColor = currentTimeColor;
+	[self updateCurrentTime];
 }
 
 - (void)setTimeMark:(NSTimeInterval)timeMark
 {
 	_timeMark = timeMark;
-	[self setNeedsDisplay];
+	[self updateTimeMark];
 }
 
 - (void)timeChanged:(NSDictionary*)dictionary
 {
-	[self setNeedsDisplay];
+	[self updateCurrentTime];
 }
 
 // time is the interval since the start of the day.
@@ -146,65 +225,180 @@
     return attrStr;
 }
 
+// returns the image of the mark for given time, rendered in a rect of given width
+- (UIImage*)imageForTimeMark:(MGCDayPlannerTimeMark)mark time:(NSTimeInterval)ti width:(CGFloat)width
+{
+	if (width <= 0) return nil;
+	
+	NSAttributedString *markAttrStr = [self attributedStringForTimeMark:mark time:ti];
+	CGSize markSize = [markAttrStr boundingRectWithSize:CGSizeMake(width, CGFLOAT_MAX) options:NSStringDrawingUsesLineFragmentOrigin context:nil].size;
+	CGRect rect = MGCAlignedRectMake(0, 0, width, markSize.height);
+	if (CGRectIsEmpty(rect)) {
+		return nil;
+	}
+	
+	UIGraphicsBeginImageContextWithOptions(rect.size, NO, 0);
+	[markAttrStr drawInRect:rect];
+	UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+	UIGraphicsEndImageContext();
+	return image;
+}
+
+// returns the image of the mark for given hour, rendered in a rect of given width
+- (UIImage*)imageForHourMark:(NSUInteger)hour width:(CGFloat)width
+{
+	UIImage *image = [self.hourMarkImages objectForKey:@(hour)];
+	if (!image) {
+		image = [self imageForTimeMark:MGCDayPlannerTimeMarkHeader time:hour * 3600 width:width];
+		if (image) {
+			[self.hourMarkImages setObject:image forKey:@(hour)];
+		}
+	}
+	return image;
+}
+
 - (BOOL)canDisplayTime:(NSTimeInterval)ti
 {
     CGFloat hour = ti/3600.;
     return hour >= self.hourRange.location && hour <= NSMaxRange(self.hourRange);
 }
 
+- (CGFloat)markWidth
+{
+	return self.timeColumnWidth - 2.*kSpacing;
+}
+
+// y offset of the line for given hour, aligned on pixels
+- (CGFloat)yOffsetForHourLine:(NSUInteger)hour
+{
+	CGFloat lineWidth = 1. / [UIScreen mainScreen].scale;
+	return MGCAlignedFloat((hour - self.hourRange.location) * self.hourSlotHeight + self.insetsHeight) - lineWidth * .5;
+}
+
+#pragma mark - Layers
+
+- (void)setImage:(UIImage*)image forLayer:(CALayer*)layer
+{
+	layer.contents = (id)image.CGImage;
+	layer.contentsScale = image.scale;
+}
+
+- (void)layoutHourMarks
+{
+	NSUInteger numMarks = self.hourRange.length + 1;
+	
+	while (self.hourMarkLayers.count < numMarks) {
+		CALayer *layer = [CALayer layer];
+		layer.actions = @{ @"position": [NSNull null], @"bounds": [NSNull null], @"contents": [NSNull null], @"hidden": [NSNull null] };
+		[self.layer insertSublayer:layer below:self.currentTimeLayer];
+		[self.hourMarkLayers addObject:layer];
+	}
+	while (self.hourMarkLayers.count > numMarks) {
+		[[self.hourMarkLayers lastObject] removeFromSuperlayer];
+		[self.hourMarkLayers removeLastObject];
+	}
+	
+	for (NSUInteger i = 0; i < numMarks; i++) {
+		NSUInteger hour = self.hourRange.location + i;
+		CALayer *layer = [self.hourMarkLayers objectAtIndex:i];
+		
+		UIImage *markImage = [self imageForHourMark:hour % 24 width:self.markWidth];
+		CGFloat y = [self yOffsetForHourLine:hour];
+		
+		[self setImage:markImage forLayer:layer];
+		layer.frame = MGCAlignedRectMake(kSpacing, y - markImage.size.height / 2., self.markWidth, markImage.size.height);
+	}
+}
+
+- (void)updateCurrentTime
+{
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	
+	NSDateComponents *comps = [self.calendar components:NSCalendarUnitHour|NSCalendarUnitMinute|NSCalendarUnitSecond fromDate:[NSDate date]];
+	NSTimeInterval currentTime = comps.hour*3600.+comps.minute*60.+comps.second;
+	
+	CGRect rectCurTime = CGRectZero;
+	BOOL showsCurrentTime = self.showsCurrentTime && [self canDisplayTime:currentTime];
+	
+	if (showsCurrentTime) {
+		UIImage *markImage = [self imageForTimeMark:MGCDayPlannerTimeMarkCurrent time:currentTime width:self.markWidth];
+		CGFloat y = [self yOffsetForTime:currentTime rounded:NO];
+		
+		rectCurTime = CGRectMake(kSpacing, y - markImage.size.height/2., self.markWidth, markImage.size.height);
+		[self setImage:markImage forLayer:self.currentTimeLayer];
+		self.currentTimeLayer.frame = rectCurTime;
+		
+		self.currentTimeLineLayer.backgroundColor = self.currentTimeColor.CGColor;
+		self.currentTimeLineLayer.frame = CGRectMake(self.timeColumnWidth - kSpacing, y, self.bounds.size.width - self.timeColumnWidth + kSpacing, 1);
+	}
+	self.currentTimeLayer.hidden = !showsCurrentTime;
+	self.currentTimeLineLayer.hidden = !showsCurrentTime;
+	
+	// hide hour marks under the current time mark
+	for (CALayer *layer in self.hourMarkLayers) {
+		layer.hidden = self.showsCurrentTime && CGRectIntersectsRect(layer.frame, rectCurTime);
+	}
+	
+	[CATransaction commit];
+}
+
+- (void)updateTimeMark
+{
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	
+	BOOL drawTimeMark = self.timeMark != 0 && [self canDisplayTime:self.timeMark];
+	
+	if (drawTimeMark) {
+		UIImage *markImage = [self imageForTimeMark:MGCDayPlannerTimeMarkFloating time:self.timeMark width:self.markWidth];
+		CGFloat y = [self yOffsetForTime:self.timeMark rounded:YES];
+		CGRect rectTimeMark = CGRectMake(kSpacing, y - markImage.size.height/2., self.markWidth, markImage.size.height);
+		
+		// don't draw time mark if it intersects any other mark
+		for (CALayer *layer in self.hourMarkLayers) {
+			drawTimeMark &= !CGRectIntersectsRect(layer.frame, rectTimeMark);
+		}
+		
+		if (drawTimeMark) {
+			[self setImage:markImage forLayer:self.timeMarkLayer];
+			self.timeMarkLayer.frame = rectTimeMark;
+		}
+	}
+	self.timeMarkLayer.hidden = !drawTimeMark;
+	
+	[CATransaction commit];
+}
+
+#pragma mark - UIView
+
+- (void)layoutSubviews
+{
+	[super layoutSubviews];
+	
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	[self layoutHourMarks];
+	[CATransaction commit];
+	
+	[self updateCurrentTime];
+	[self updateTimeMark];
+}
+
+// draws the hour and half-hour lines only
 - (void)drawRect:(CGRect)rect
 {
-	const CGFloat kSpacing = 5.;
 	const CGFloat dash[2]= {2, 3};
     
 	CGContextRef context = UIGraphicsGetCurrentContext();
+	CGFloat lineWidth = 1. / [UIScreen mainScreen].scale;
 	
-    CGSize markSizeMax = CGSizeMake(self.timeColumnWidth - 2.*kSpacing, CGFLOAT_MAX);
-    
-	// calculate rect for current time mark
-    NSDateComponents *comps = [self.calendar components:NSCalendarUnitHour|NSCalendarUnitMinute|NSCalendarUnitSecond fromDate:[NSDate date]];
-    NSTimeInterval currentTime = comps.hour*3600.+comps.minute*60.+comps.second;
-    
-    NSAttributedString *markAttrStr = [self attributedStringForTimeMark:MGCDayPlannerTimeMarkCurrent time:currentTime];
-    CGSize markSize = [markAttrStr boundingRectWithSize:markSizeMax options:NSStringDrawingUsesLineFragmentOrigin context:nil].size;
-    
-	CGFloat y = [self yOffsetForTime:currentTime rounded:NO];
-    CGRect rectCurTime = CGRectZero;
-	
-	// draw current time mark
-	if (self.showsCurrentTime && [self canDisplayTime:currentTime]) {
-        rectCurTime =  CGRectMake(kSpacing, y - markSize.height/2., markSizeMax.width, markSize.height);
-        [markAttrStr drawInRect:rectCurTime];
-		CGRect lineRect = CGRectMake(self.timeColumnWidth - kSpacing, y, self.bounds.size.width - self.timeColumnWidth + kSpacing, 1);
-        CGContextSetFillColorWithColor(context, self.currentTimeColor.CGColor);
-		UIRectFill(lineRect);
-	}
-	
-	// calculate rect for the floating time mark
-    NSAttributedString *floatingMarkAttrStr = [self attributedStringForTimeMark:MGCDayPlannerTimeMarkFloating time:self.timeMark];
-    markSize = [floatingMarkAttrStr boundingRectWithSize:markSizeMax options:NSStringDrawingUsesLineFragmentOrigin context:nil].size;
+	CGContextSetStrokeColorWithColor(context, self.timeColor.CGColor);
+	CGContextSetLineWidth(context, lineWidth);
 	
-    y = [self yOffsetForTime:self.timeMark rounded:YES];
-    CGRect rectTimeMark = CGRectMake(kSpacing, y - markSize.height/2., markSizeMax.width, markSize.height);
-    
-    BOOL drawTimeMark = self.timeMark != 0 && [self canDisplayTime:self.timeMark];
-    CGFloat lineWidth = 1. / [UIScreen mainScreen].scale;
-    
-	// draw the hour marks
 	for (NSUInteger i = self.hourRange.location; i <=  NSMaxRange(self.hourRange); i++) {
+		CGFloat y = [self yOffsetForHourLine:i];
 		
-        markAttrStr = [self attributedStringForTimeMark:MGCDayPlannerTimeMarkHeader time:(i % 24)*3600];
-        markSize = [markAttrStr boundingRectWithSize:markSizeMax options:NSStringDrawingUsesLineFragmentOrigin context:nil].size;
-        
-        y = MGCAlignedFloat((i - self.hourRange.location) * self.hourSlotHeight + self.insetsHeight) - lineWidth * .5;
-		CGRect r = MGCAlignedRectMake(kSpacing, y - markSize.height / 2., markSizeMax.width, markSize.height);
-
-		if (!CGRectIntersectsRect(r, rectCurTime) || !self.showsCurrentTime) {
-            [markAttrStr drawInRect:r];
- 		}
-        
-        CGContextSetStrokeColorWithColor(context, self.timeColor.CGColor);
-        CGContextSetLineWidth(context, lineWidth);
 		CGContextSetLineDash(context, 0, NULL, 0);
         CGContextMoveToPoint(context, self.timeColumnWidth, y);
 		CGContextAddLineToPoint(context, self.timeColumnWidth + rect.size.width, y);
@@ -217,13 +411,6 @@
 			CGContextAddLineToPoint(context, self.timeColumnWidth + rect.size.width, y);
 			CGContextStrokePath(context);
 		}
-		
-		// don't draw time mark if it intersects any other mark
-		drawTimeMark &= !CGRectIntersectsRect(r, rectTimeMark);
-	}
-
-	if (drawTimeMark) {
-        [floatingMarkAttrStr drawInRect:rectTimeMark];
 	}
 }
 
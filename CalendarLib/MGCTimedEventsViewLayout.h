@@ -29,6 +29,7 @@
 //
 
 #import <UIKit/UIKit.h>
+#import "MGCEventsLayoutCore.h"
 
 static NSString* const DimmingViewKind = @"DimmingViewKind";
 
@@ -47,14 +48,20 @@ typedef enum : NSUInteger
 @interface MGCTimedEventsViewLayoutInvalidationContext: UICollectionViewLayoutInvalidationContext
 
 @property (nonatomic) BOOL invalidateDimmingViews;  // set to true if layout attributes of dimming views must be recomputed
-@property (nonatomic) BOOL invalidateEventCells;  // set to true if layout attributes of event cells must be recomputed
+@property (nonatomic) BOOL invalidateEventCells;  // set to true if layout attributes of event cells must be recomputed, and their spans asked again to the delegate
 @property (nonatomic) NSMutableIndexSet *invalidatedSections;   // sections whose layout attributes (dimming views or event cells) must be recomputed - if nil, recompute everything
+@property (nonatomic) BOOL invalidateSectionDates;  // set to true if sections now show other days - layout attributes of days still shown are kept and moved to their new section
 
 @end
 
 
 // This collection view layout is responsible for the layout of event views in the timed-events part
 // of the day planner view.
+// The placements of the events of each day (see MGCLayoutPlaceTimedEvents) are cached, in pixels for the
+// height of the columns, so that only the covering pass is skipped when the day is laid out again.
+// The spans of the events are asked to the delegate again only on reloadData, updates of the collection view,
+// invalidation of the event cells of a section, or when the height of the columns changes: if the delegate
+// positions the events differently for another reason, it must invalidate their sections.
 @interface MGCTimedEventsViewLayout : UICollectionViewLayout
 
 @property (nonatomic, weak) id<MGCTimedEventsViewLayoutDelegate> delegate;
@@ -62,6 +69,15 @@ typedef enum : NSUInteger
 @property (nonatomic) CGFloat minimumVisibleHeight;  // if 2 cells overlap, and the height of the uncovered part of the upper cell is less than this value, the column is split
 @property (nonatomic) BOOL ignoreNextInvalidation;  // for some reason, UICollectionView reloadSections: messes up with scrolling and animations so we have to stick with using reloadData even when only individual sections need to be invalidated. As a workaroud, we explicitly invalidate them with custom context, and set this flag to YES before calling reloadData
 @property (nonatomic) TimedEventCoveringType coveringType;  // how to handle event covering
+@property (nonatomic, readonly, getter=isZooming) BOOL zooming;  // YES between beginZoomingWithVerticalInset: and endZooming
+
+// fast path for pinch-zooming: until endZooming is called, changes of the height of dayColumnSize stretch
+// the layout attributes computed for the previous height, instead of laying out the events again.
+// inset is the height of the margins at the top and bottom of the columns, which are not stretched.
+- (void)beginZoomingWithVerticalInset:(CGFloat)inset;
+
+// ends zooming and invalidates the layout, so that events are laid out for the final height
+- (void)endZooming;
 
 @end
 
@@ -72,4 +88,15 @@ typedef enum : NSUInteger
 - (CGRect)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout rectForEventAtIndexPath:(NSIndexPath*)indexPath;
 - (NSArray*)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout dimmingRectsForSection:(NSUInteger)section;
 
+@optional
+
+// bulk version of collectionView:layout:rectForEventAtIndexPath:, called once per section instead if implemented.
+// spans has room for all the items in the section: it should be filled with the vertical extent of the events
+// that are visible (with their item as index), and the number of spans written returned.
+- (NSUInteger)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout getEventSpans:(MGCEventSpan*)spans inSection:(NSUInteger)section;
+
+// day shown in section. If implemented, layout attributes are cached by day rather than by section,
+// so that they survive an invalidation with invalidateSectionDates set.
+- (NSDate*)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout dateForSection:(NSUInteger)section;
+
 @end
@@ -31,6 +31,7 @@
 #import "MGCTimedEventsViewLayout.h"
 #import "MGCEventCellLayoutAttributes.h"
 #import "MGCAlignedGeometry.h"
+#import "MGCEventsLayoutCore.h"
 
 
 // In iOS 8.1.2 and older, there is a bug with UICollectionView that will make
@@ -47,6 +48,13 @@
 
 static NSString* const DimmingViewsKey = @"DimmingViewsKey";
 static NSString* const EventCellsKey = @"EventCellsKey";
+static NSString* const SectionKey = @"SectionKey";   // section for which the layout attributes were computed
+static NSString* const EventSpansKey = @"EventSpansKey";    // spans of the events returned by the delegate (NSData of MGCEventSpan)
+static NSString* const EventPlacementsKey = @"EventPlacementsKey";  // placements computed from these spans (NSData of MGCEventCellPlacement)
+static NSString* const PlacementParamsKey = @"PlacementParamsKey";  // layout parameters the placements were computed with (NSData of MGCTimedEventsLayoutParams)
+static NSString* const SpansHeightKey = @"SpansHeightKey";  // column height for which the cached spans are known to be current - removed when the events may have changed
+static NSString* const ColumnHeightKey = @"ColumnHeightKey";  // height of the columns for which the layout attributes were computed
+static NSString* const ZoomedLayoutKey = @"ZoomedLayoutKey";  // layout attributes stretched to the current height while zooming
 
 
 @implementation MGCTimedEventsViewLayoutInvalidationContext
@@ -64,7 +72,10 @@ static NSString* const EventCellsKey = @"EventCellsKey";
 
 @interface MGCTimedEventsViewLayout()
 
-@property (nonatomic) NSMutableDictionary *layoutInfo;
+@property (nonatomic) NSMutableDictionary *layoutInfo;	// layout attributes per day, or per section if the delegate does not provide dates
+@property (nonatomic) BOOL needsDiscardingHiddenDates;	// set when sections might show other days, layoutInfo is cleaned up in prepareLayout
+@property (nonatomic, readwrite, getter=isZooming) BOOL zooming;
+@property (nonatomic) CGFloat zoomingInset;				// height of the margins which are not stretched while zooming
 
 #ifdef BUG_FIX
 @property (nonatomic) CGRect visibleBounds;
@@ -93,6 +104,140 @@ static NSString* const EventCellsKey = @"EventCellsKey";
 	return _layoutInfo;
 }
 
+- (void)setDayColumnSize:(CGSize)dayColumnSize
+{
+    // while zooming, a change of height is handled by layoutAttributesForSection:
+    BOOL discard = self.zooming ? dayColumnSize.width != _dayColumnSize.width : !CGSizeEqualToSize(dayColumnSize, _dayColumnSize);
+    
+    _dayColumnSize = dayColumnSize;
+    if (discard) {
+        [self discardLayoutAttributes];  // frames are not valid anymore, but placements might still be
+    }
+}
+
+- (void)setMinimumVisibleHeight:(CGFloat)minimumVisibleHeight
+{
+    if (minimumVisibleHeight != _minimumVisibleHeight) {
+        _minimumVisibleHeight = minimumVisibleHeight;
+        self.layoutInfo = nil;
+        [self invalidateLayout];
+    }
+}
+
+- (void)setCoveringType:(TimedEventCoveringType)coveringType
+{
+    if (coveringType != _coveringType) {
+        _coveringType = coveringType;
+        self.layoutInfo = nil;
+        [self invalidateLayout];
+    }
+}
+
+// removes the layout attributes of all sections, keeping the placements of the events
+- (void)discardLayoutAttributes
+{
+    for (NSMutableDictionary *sectionAttribs in self.layoutInfo.allValues) {
+        [sectionAttribs removeObjectForKey:DimmingViewsKey];
+        [sectionAttribs removeObjectForKey:EventCellsKey];
+        [sectionAttribs removeObjectForKey:ZoomedLayoutKey];
+    }
+}
+
+// forces the spans of the events to be asked to the delegate again for all sections, when the events may have changed
+- (void)discardCheckedSpans
+{
+    for (NSMutableDictionary *sectionAttribs in self.layoutInfo.allValues) {
+        [sectionAttribs removeObjectForKey:SpansHeightKey];
+    }
+}
+
+// key of the section in layoutInfo
+- (id<NSCopying>)keyForSection:(NSUInteger)section
+{
+    if ([self.delegate respondsToSelector:@selector(collectionView:layout:dateForSection:)]) {
+        return [self.delegate collectionView:self.collectionView layout:self dateForSection:section];
+    }
+    return @(section);
+}
+
+// called when sections might have been reassigned to other days: discards the layout of days not shown anymore.
+// the others are moved to their new section lazily, by layoutAttributesForSection:
+- (void)discardLayoutForHiddenDates
+{
+    if (![self.delegate respondsToSelector:@selector(collectionView:layout:dateForSection:)]) {
+        // we cannot tell where days went, placements will only be reused if the events are the same
+        [self discardLayoutAttributes];
+        [self discardCheckedSpans];
+    }
+    
+    NSInteger numSections = self.collectionView.numberOfSections;
+    NSMutableSet *keys = [NSMutableSet setWithCapacity:numSections];
+    for (NSUInteger section = 0; section < numSections; section++) {
+        [keys addObject:[self keyForSection:section]];
+    }
+    
+    for (id key in self.layoutInfo.allKeys) {
+        if (![keys containsObject:key]) {
+            [self.layoutInfo removeObjectForKey:key];
+        }
+    }
+}
+
+// stretches layout attributes vertically by given factor, keeping the top margin of the column fixed
+- (NSArray*)layoutAttributes:(NSArray*)attribs scaledBy:(CGFloat)scale
+{
+    CGFloat inset = self.zoomingInset;
+    
+    NSMutableArray *scaledAttribs = [NSMutableArray arrayWithCapacity:attribs.count];
+    for (UICollectionViewLayoutAttributes *a in attribs) {
+        UICollectionViewLayoutAttributes *scaled = [a copy];
+        CGRect frame = a.frame;
+        frame.origin.y = inset + (frame.origin.y - inset) * scale;
+        frame.size.height *= scale;
+        scaled.frame = MGCAlignedRect(frame);
+        if ([scaled isKindOfClass:[MGCEventCellLayoutAttributes class]]) {
+            MGCEventCellLayoutAttributes *cellAttribs = (MGCEventCellLayoutAttributes*)scaled;
+            cellAttribs.visibleHeight *= scale;
+        }
+        [scaledAttribs addObject:scaled];
+    }
+    return scaledAttribs;
+}
+
+// returns the layout attributes of the section stretched to the current column height (while zooming)
+- (NSDictionary*)zoomedLayoutAttributes:(NSMutableDictionary*)sectionAttribs
+{
+    CGFloat height = self.dayColumnSize.height;
+    NSDictionary *zoomedAttribs = [sectionAttribs objectForKey:ZoomedLayoutKey];
+    
+    if ([[zoomedAttribs objectForKey:ColumnHeightKey] doubleValue] != height) {
+        CGFloat layoutHeight = [[sectionAttribs objectForKey:ColumnHeightKey] doubleValue];
+        CGFloat scale = (height - 2 * self.zoomingInset) / (layoutHeight - 2 * self.zoomingInset);
+        
+        zoomedAttribs = @{ DimmingViewsKey: [self layoutAttributes:[sectionAttribs objectForKey:DimmingViewsKey] scaledBy:scale],
+                           EventCellsKey: [self layoutAttributes:[sectionAttribs objectForKey:EventCellsKey] scaledBy:scale],
+                           ColumnHeightKey: @(height) };
+        [sectionAttribs setObject:zoomedAttribs forKey:ZoomedLayoutKey];
+    }
+    return zoomedAttribs;
+}
+
+// moves layout attributes cached for another section by the corresponding number of columns.
+// only used for dimming views: event cells are framed again from their placements (see layoutAttributesForSection:)
+- (NSArray*)layoutAttributes:(NSArray*)attribs movedToSection:(NSUInteger)section fromSection:(NSUInteger)oldSection
+{
+    CGFloat dx = ((CGFloat)section - (CGFloat)oldSection) * self.dayColumnSize.width;
+    
+    NSMutableArray *movedAttribs = [NSMutableArray arrayWithCapacity:attribs.count];
+    for (UICollectionViewLayoutAttributes *a in attribs) {
+        UICollectionViewLayoutAttributes *moved = [a copy];
+        moved.indexPath = [NSIndexPath indexPathForItem:a.indexPath.item inSection:section];
+        moved.frame = CGRectOffset(a.frame, dx, 0);
+        [movedAttribs addObject:moved];
+    }
+    return movedAttribs;
+}
+
 - (NSArray*)layoutAttributesForDimmingViewsInSection:(NSUInteger)section
 {
     NSArray *dimmingRects = [self.delegate collectionView:self.collectionView layout:self dimmingRectsForSection:section];
@@ -117,233 +262,190 @@ static NSString* const EventCellsKey = @"EventCellsKey";
     return layoutAttribs;
 }
 
-- (NSArray*)layoutAttributesForEventCellsInSection:(NSUInteger)section
+- (MGCTimedEventsLayoutParams)layoutParamsForSection:(NSUInteger)section
+{
+    MGCTimedEventsLayoutParams params;
+    params.columnX = self.dayColumnSize.width * section;
+    params.columnWidth = self.dayColumnSize.width;
+    params.minimumVisibleHeight = self.minimumVisibleHeight;
+    params.scale = [UIScreen mainScreen].scale;
+    params.covering = self.coveringType == TimedEventCoveringTypeComplex ? MGCEventCoveringComplex : MGCEventCoveringClassic;
+    return params;
+}
+
+- (NSData*)eventSpansInSection:(NSUInteger)section
 {
     NSInteger numItems = [self.collectionView numberOfItemsInSection:section];
-    NSMutableArray *layoutAttribs = [NSMutableArray arrayWithCapacity:numItems];
     
-    for (NSInteger item = 0; item < numItems; item++) {
-        NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
-        
-        CGRect rect = [self.delegate collectionView:self.collectionView layout:self rectForEventAtIndexPath:indexPath];
-        if (!CGRectIsNull(rect)) {
-            MGCEventCellLayoutAttributes *cellAttribs = [MGCEventCellLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
-            
-            rect.origin.x = self.dayColumnSize.width * indexPath.section;
-            rect.size.width = self.dayColumnSize.width;
-            rect.size.height = fmax(self.minimumVisibleHeight, rect.size.height);
-            
-            cellAttribs.frame = MGCAlignedRect(CGRectInset(rect , 0, 1));
-            cellAttribs.visibleHeight = cellAttribs.frame.size.height;
-            cellAttribs.zIndex = 1;  // should appear above dimming views
+    NSMutableData *data = [NSMutableData dataWithLength:numItems * sizeof(MGCEventSpan)];
+    MGCEventSpan *spans = data.mutableBytes;
+    size_t count = 0;
+    
+    if ([self.delegate respondsToSelector:@selector(collectionView:layout:getEventSpans:inSection:)]) {
+        count = [self.delegate collectionView:self.collectionView layout:self getEventSpans:spans inSection:section];
+        NSAssert(count <= numItems, @"[MGCTimedEventsViewLayoutDelegate collectionView:layout:getEventSpans:inSection:] returned too many spans");
+    }
+    else {
+        for (NSInteger item = 0; item < numItems; item++) {
+            NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
             
-            [layoutAttribs addObject:cellAttribs];
+            CGRect rect = [self.delegate collectionView:self.collectionView layout:self rectForEventAtIndexPath:indexPath];
+            if (!CGRectIsNull(rect)) {
+                spans[count++] = (MGCEventSpan){ rect.origin.y, rect.origin.y + rect.size.height, item };
+            }
         }
     }
     
-    return [self adjustLayoutForOverlappingCells:layoutAttribs inSection:section];
+    data.length = count * sizeof(MGCEventSpan);
+    return data;
 }
 
-- (NSDictionary*)layoutAttributesForSection:(NSUInteger)section
+// returns the placements of the events in section.
+// placements hold pixel positions for the height of the columns they were computed for: caching them only saves
+// the covering pass. The spans are asked to the delegate again if the events may have changed since they were
+// fetched (see invalidateLayoutWithContext:) or if the height of the columns changed, and the placements are
+// computed again if the spans are different, or if the covering depends on changed parameters
+// (see MGCLayoutCanReusePlacements: with the classic covering, on the origin and width of the column).
+- (NSData*)eventPlacementsInSection:(NSUInteger)section cachedLayout:(NSMutableDictionary*)sectionAttribs
 {
-    NSMutableDictionary *sectionAttribs = [self.layoutInfo objectForKey:@(section)];
+    NSData *placements = [sectionAttribs objectForKey:EventPlacementsKey];
+    NSData *placedParams = [sectionAttribs objectForKey:PlacementParamsKey];
+    MGCTimedEventsLayoutParams params = [self layoutParamsForSection:section];
     
-    if (!sectionAttribs) {
-        sectionAttribs = [NSMutableDictionary dictionary];
+    NSNumber *spansHeight = [sectionAttribs objectForKey:SpansHeightKey];
+    BOOL spansAreCurrent = spansHeight && spansHeight.doubleValue == self.dayColumnSize.height;
+    
+    if (placements && placedParams && spansAreCurrent && MGCLayoutCanReusePlacements(placedParams.bytes, &params)) {
+        return placements;
     }
     
-    if (![sectionAttribs objectForKey:DimmingViewsKey]) {
-        NSArray *dimmingViewsAttribs = [self layoutAttributesForDimmingViewsInSection:section];
-        [sectionAttribs setObject:dimmingViewsAttribs forKey:DimmingViewsKey];
+    NSData *spans = [self eventSpansInSection:section];
+    [sectionAttribs setObject:@(self.dayColumnSize.height) forKey:SpansHeightKey];
+    
+    if (!placements || !placedParams || ![spans isEqualToData:[sectionAttribs objectForKey:EventSpansKey]] || !MGCLayoutCanReusePlacements(placedParams.bytes, &params)) {
+        size_t count = spans.length / sizeof(MGCEventSpan);
+        NSMutableData *data = [NSMutableData dataWithLength:count * sizeof(MGCEventCellPlacement)];
+        
+        if (!MGCLayoutPlaceTimedEvents(spans.bytes, count, &params, data.mutableBytes)) {
+            [sectionAttribs removeObjectForKey:SpansHeightKey];  // try again on next layout pass
+            return [NSData data];
+        }
+        
+        placements = data;
+        [sectionAttribs setObject:spans forKey:EventSpansKey];
+        [sectionAttribs setObject:placements forKey:EventPlacementsKey];
+        [sectionAttribs setObject:[NSData dataWithBytes:&params length:sizeof(params)] forKey:PlacementParamsKey];
     }
-    if (![sectionAttribs objectForKey:EventCellsKey]) {
-        NSArray *cellsAttribs = [self layoutAttributesForEventCellsInSection:section];
-        [sectionAttribs setObject:cellsAttribs forKey:EventCellsKey];
+    return placements;
+}
+
+- (NSArray*)layoutAttributesForEventCellsWithPlacements:(NSData*)placements inSection:(NSUInteger)section
+{
+    size_t count = placements.length / sizeof(MGCEventCellPlacement);
+    
+    MGCTimedEventsLayoutParams params = [self layoutParamsForSection:section];
+    MGCEventCellLayout *cells = malloc(count * sizeof(MGCEventCellLayout));
+    MGCLayoutFrameTimedEvents(placements.bytes, count, &params, cells);
+    
+    NSMutableArray *layoutAttribs = [NSMutableArray arrayWithCapacity:count];
+    
+    for (size_t i = 0; i < count; i++) {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForItem:cells[i].index inSection:section];
+        MGCEventCellLayoutAttributes *cellAttribs = [MGCEventCellLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
+        
+        MGCLayoutRect frame = cells[i].frame;
+        cellAttribs.frame = CGRectMake(frame.x, frame.y, frame.width, frame.height);
+        cellAttribs.visibleHeight = cells[i].visibleHeight;
+        cellAttribs.zIndex = cells[i].zIndex;   // should appear above dimming views
+        
+        [layoutAttribs addObject:cellAttribs];
     }
     
-    [self.layoutInfo setObject:sectionAttribs forKey:@(section)];
-   
-    return sectionAttribs;
+    free(cells);
+    
+    return layoutAttribs;
 }
 
-- (NSArray*)adjustLayoutForOverlappingCells:(NSArray*)attributes inSection:(NSUInteger)section
+- (NSDictionary*)layoutAttributesForSection:(NSUInteger)section
 {
-    const CGFloat kOverlapOffset = 4.;
+    id<NSCopying> key = [self keyForSection:section];
+    NSMutableDictionary *sectionAttribs = [self.layoutInfo objectForKey:key];
     
-    // sort layout attributes by frame y-position
-    NSArray *adjustedAttributes = [attributes sortedArrayUsingComparator:^NSComparisonResult(MGCEventCellLayoutAttributes *att1, MGCEventCellLayoutAttributes *att2) {
-        if (att1.frame.origin.y > att2.frame.origin.y) {
-            return NSOrderedDescending;
-        }
-        else if (att1.frame.origin.y < att2.frame.origin.y) {
-            return NSOrderedAscending;
-        }
-        return NSOrderedSame;
-    }];
-
-    if (self.coveringType == TimedEventCoveringTypeClassic) {
-        
-        for (NSUInteger i = 0; i < adjustedAttributes.count; i++) {
-            MGCEventCellLayoutAttributes *attribs1 = [adjustedAttributes objectAtIndex:i];
-            
-            NSMutableArray *layoutGroup = [NSMutableArray array];
-            [layoutGroup addObject:attribs1];
-            
-            NSMutableArray *coveredLayoutAttributes = [NSMutableArray array];
+    if (!sectionAttribs) {
+        sectionAttribs = [NSMutableDictionary dictionary];
+    }
+    else {
+        NSUInteger oldSection = [[sectionAttribs objectForKey:SectionKey] unsignedIntegerValue];
+        if (oldSection != section) {
+            [sectionAttribs removeObjectForKey:ZoomedLayoutKey];
             
-            // iterate previous frames (i.e with highest or equal y-pos)
-            for (NSInteger j = i - 1; j >= 0; j--) {
-                
-                MGCEventCellLayoutAttributes *attribs2 = [adjustedAttributes objectAtIndex:j];
-                if (CGRectIntersectsRect(attribs1.frame, attribs2.frame)) {
-                    CGFloat visibleHeight = fabs(attribs1.frame.origin.y - attribs2.frame.origin.y);
-                    
-                    if (visibleHeight > self.minimumVisibleHeight) {
-                        [coveredLayoutAttributes addObject:attribs2];
-                        attribs2.visibleHeight = visibleHeight;
-                        attribs1.zIndex = attribs2.zIndex + 1;
-                    }
-                    else {
-                        [layoutGroup addObject:attribs2];
-                    }
-                }
+            NSArray *dimmingViewsAttribs = [sectionAttribs objectForKey:DimmingViewsKey];
+            if (dimmingViewsAttribs) {
+                [sectionAttribs setObject:[self layoutAttributes:dimmingViewsAttribs movedToSection:section fromSection:oldSection] forKey:DimmingViewsKey];
             }
             
-
-            // now, distribute elements in layout group
-            CGFloat groupOffset = 0;
-            if (coveredLayoutAttributes.count > 0) {
-                BOOL lookForEmptySlot = YES;
-                NSUInteger slotNumber = 0;
-                CGFloat offset = 0;
+            // event cells are framed again for the new column if their placements are still valid there,
+            // otherwise they are laid out again (offsetting the frames would not match a new layout)
+            if ([sectionAttribs objectForKey:EventCellsKey]) {
+                NSData *placements = [sectionAttribs objectForKey:EventPlacementsKey];
+                NSData *placedParams = [sectionAttribs objectForKey:PlacementParamsKey];
+                MGCTimedEventsLayoutParams params = [self layoutParamsForSection:section];
                 
-                while (lookForEmptySlot) {
-                    offset = slotNumber * kOverlapOffset;
-                    
-                    lookForEmptySlot = NO;
-                    
-                    for (MGCEventCellLayoutAttributes *attribs in coveredLayoutAttributes) {
-                        if (attribs.frame.origin.x - section * self.dayColumnSize.width == offset) {
-                            lookForEmptySlot = YES;
-                            break;
-                        }
-                    }
-                    
-                    slotNumber += 1;
+                if (placements && placedParams && MGCLayoutCanReusePlacements(placedParams.bytes, &params)) {
+                    [sectionAttribs setObject:[self layoutAttributesForEventCellsWithPlacements:placements inSection:section] forKey:EventCellsKey];
                 }
-                
-                groupOffset += offset;
-            }
-            
-            CGFloat totalWidth = (self.dayColumnSize.width - 1.) - groupOffset;
-            CGFloat colWidth = totalWidth / layoutGroup.count;
-            
-            CGFloat x = section * self.dayColumnSize.width + groupOffset;
-            
-            for (MGCEventCellLayoutAttributes* attribs in [layoutGroup reverseObjectEnumerator]) {
-                attribs.frame = MGCAlignedRectMake(x, attribs.frame.origin.y, colWidth, attribs.frame.size.height);
-                x += colWidth;
-            }
-        }
-        
-        return adjustedAttributes;
-        
-    } else if (self.coveringType == TimedEventCoveringTypeComplex) {
-        
-        // Create clusters - groups of rectangles which don't have common parts with other groups
-        NSMutableArray *uninspectedAttributes = [adjustedAttributes mutableCopy];
-        NSMutableArray<NSMutableArray<MGCEventCellLayoutAttributes *> *> *clusters = [NSMutableArray new];
-        
-        while (uninspectedAttributes.count > 0) {
-            MGCEventCellLayoutAttributes *attrib = [uninspectedAttributes firstObject];
-            NSMutableArray<MGCEventCellLayoutAttributes *> *destinationCluster;
-            
-            for (NSMutableArray<MGCEventCellLayoutAttributes *> *cluster in clusters) {
-                for (MGCEventCellLayoutAttributes *clusteredAttrib in cluster) {
-                    if (CGRectIntersectsRect(clusteredAttrib.frame, attrib.frame)) {
-                        destinationCluster = cluster;
-                        break;
-                    }
+                else {
+                    [sectionAttribs removeObjectForKey:EventCellsKey];
                 }
             }
-            
-            if (destinationCluster) {
-                [destinationCluster addObject:attrib];
-            } else {
-                NSMutableArray<MGCEventCellLayoutAttributes *> *cluster = [NSMutableArray new];
-                [cluster addObject:attrib];
-                [clusters addObject:cluster];
-            }
-            
-            [uninspectedAttributes removeObject:attrib];
         }
-        
-        // Distribute rectangles evenly in clusters
-        for (NSMutableArray<MGCEventCellLayoutAttributes *> *cluster in clusters) {
-            [self expandCellsToMaxWidthInCluster:cluster];
+    }
+    [sectionAttribs setObject:@(section) forKey:SectionKey];
+    
+    CGFloat height = self.dayColumnSize.height;
+    
+    if (![sectionAttribs objectForKey:DimmingViewsKey] || ![sectionAttribs objectForKey:EventCellsKey]) {
+        // dimming views and event cells must be laid out for the same height (they might not while zooming)
+        if ([[sectionAttribs objectForKey:ColumnHeightKey] doubleValue] != height) {
+            [sectionAttribs removeObjectForKey:DimmingViewsKey];
+            [sectionAttribs removeObjectForKey:EventCellsKey];
         }
+        [sectionAttribs removeObjectForKey:ZoomedLayoutKey];
         
-        // Gather all the attributes and return them
-        NSMutableArray *attributes = [NSMutableArray new];
-        for (NSMutableArray<MGCEventCellLayoutAttributes *> *cluster in clusters) {
-            [attributes addObjectsFromArray:cluster];
+        if (![sectionAttribs objectForKey:DimmingViewsKey]) {
+            NSArray *dimmingViewsAttribs = [self layoutAttributesForDimmingViewsInSection:section];
+            [sectionAttribs setObject:dimmingViewsAttribs forKey:DimmingViewsKey];
         }
-        
-        return attributes;
+        if (![sectionAttribs objectForKey:EventCellsKey]) {
+            NSData *placements = [self eventPlacementsInSection:section cachedLayout:sectionAttribs];
+            NSArray *cellsAttribs = [self layoutAttributesForEventCellsWithPlacements:placements inSection:section];
+            [sectionAttribs setObject:cellsAttribs forKey:EventCellsKey];
+        }
+        [sectionAttribs setObject:@(height) forKey:ColumnHeightKey];
     }
     
-    return @[];
+    [self.layoutInfo setObject:sectionAttribs forKey:key];
+    
+    if (self.zooming && [[sectionAttribs objectForKey:ColumnHeightKey] doubleValue] != height) {
+        return [self zoomedLayoutAttributes:sectionAttribs];
+    }
+    return sectionAttribs;
 }
 
-- (void)expandCellsToMaxWidthInCluster:(NSMutableArray<MGCEventCellLayoutAttributes *> *)cluster
+#pragma mark - Zooming
+
+- (void)beginZoomingWithVerticalInset:(CGFloat)inset
 {
-    const NSUInteger padding = 2.f;
-    
-    // Expand the attributes to maximum possible width
-    NSMutableArray<NSMutableArray<MGCEventCellLayoutAttributes *> *> *columns = [NSMutableArray new];
-    [columns addObject:[NSMutableArray new]];
-    for (MGCEventCellLayoutAttributes *attribs in cluster) {
-        BOOL isPlaced = NO;
-        for (NSMutableArray<MGCEventCellLayoutAttributes *> *column in columns) {
-            if (column.count == 0) {
-                [column addObject:attribs];
-                isPlaced = YES;
-            } else if (!CGRectIntersectsRect(attribs.frame, [column lastObject].frame)) {
-                [column addObject:attribs];
-                isPlaced = YES;
-                break;
-            }
-        }
-        if (!isPlaced) {
-            NSMutableArray<MGCEventCellLayoutAttributes *> *column = [NSMutableArray new];
-            [column addObject:attribs];
-            [columns addObject:column];
-        }
-    }
-    
-    // Calculate left and right position for all the attributes, get the maxRowCount by looking in all columns
-    NSInteger maxRowCount = 0;
-    for (NSMutableArray<MGCEventCellLayoutAttributes *> *column in columns) {
-        maxRowCount = fmax(maxRowCount, column.count);
-    }
+    self.zoomingInset = inset;
+    self.zooming = YES;
+}
+
+- (void)endZooming
+{
+    if (!self.zooming) return;
     
-    CGFloat totalWidth = self.dayColumnSize.width - 2.f;
-
-    for (NSInteger i = 0; i < maxRowCount; i++) {
-        // Set the x position of the rect
-        NSInteger j = 0;
-        for (NSMutableArray<MGCEventCellLayoutAttributes *> *column in columns) {
-            CGFloat colWidth = totalWidth / columns.count;
-            if (column.count >= i + 1) {
-                MGCEventCellLayoutAttributes *attribs = [column objectAtIndex:i];
-                attribs.frame = MGCAlignedRectMake(attribs.frame.origin.x + j * colWidth,
-                                                   attribs.frame.origin.y,
-                                                   colWidth,
-                                                   attribs.frame.size.height);
-            }
-            j++;
-        }
-    }
+    self.zooming = NO;
+    [self invalidateLayout];
 }
 
 #pragma mark - UICollectionViewLayout
@@ -372,6 +474,16 @@ static NSString* const EventCellsKey = @"EventCellsKey";
     return [attribs objectAtIndex:indexPath.item];
 }
 
+- (void)prepareLayout
+{
+    [super prepareLayout];
+    
+    if (self.needsDiscardingHiddenDates) {
+        [self discardLayoutForHiddenDates];
+        self.needsDiscardingHiddenDates = NO;
+    }
+}
+
 - (void)prepareForCollectionViewUpdates:(NSArray*)updateItems
 {
 	//NSLog(@"prepare Collection updates");
@@ -391,16 +503,34 @@ static NSString* const EventCellsKey = @"EventCellsKey";
         
     }
     
-    if (context.invalidateEverything || context.invalidatedSections == nil) {
-        self.layoutInfo = nil;
+    // placements of the events are kept, they are only recomputed if the events moved.
+    // while zooming, layout attributes are kept as well, and stretched: the layout will be invalidated again by endZooming
+    
+    // events can only have changed on reloadData, updates of the collection view, or invalidation of their sections:
+    // other invalidations (bounds changes, zooming...) do not ask the delegate for the spans again
+    if (context.invalidateEverything || context.invalidateDataSourceCounts) {
+        [self discardCheckedSpans];
+    }
+    
+    if (context.invalidateEverything || (context.invalidatedSections == nil && !context.invalidateSectionDates)) {
+        if (!self.zooming) {
+            [self discardLayoutAttributes];
+        }
+        self.needsDiscardingHiddenDates = YES;
     }
     else {
+        if (context.invalidateSectionDates) {
+            self.needsDiscardingHiddenDates = YES;
+        }
+        
         [context.invalidatedSections enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            id<NSCopying> key = [self keyForSection:idx];
             if (context.invalidateDimmingViews) {
-                [[self.layoutInfo objectForKey:@(idx)]removeObjectForKey:DimmingViewsKey];
+                [[self.layoutInfo objectForKey:key]removeObjectForKey:DimmingViewsKey];
             }
             if (context.invalidateEventCells) {
-                [[self.layoutInfo objectForKey:@(idx)]removeObjectForKey:EventCellsKey];
+                [[self.layoutInfo objectForKey:key]removeObjectForKey:EventCellsKey];
+                [[self.layoutInfo objectForKey:key]removeObjectForKey:SpansHeightKey];
             }
         }];
     }
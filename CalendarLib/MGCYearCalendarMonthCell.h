@@ -35,5 +35,6 @@
 @interface MGCYearCalendarMonthCell : UICollectionViewCell
 
 @property (nonatomic) MGCMonthMiniCalendarView *calendarView;
+@property (nonatomic) UIImage *thumbnail;	// pre-rendered month shown instead of calendarView, if not nil
 
 @end
@@ -31,6 +31,13 @@
 #import "MGCYearCalendarMonthCell.h"
 
 
+@interface MGCYearCalendarMonthCell ()
+
+@property (nonatomic) UIImageView *thumbnailView;
+
+@end
+
+
 @implementation MGCYearCalendarMonthCell
 
 - (id)initWithFrame:(CGRect)frame
@@ -44,8 +51,31 @@
 		_calendarView = [[MGCMonthMiniCalendarView alloc]initWithFrame:self.bounds];
 		_calendarView.autoresizingMask = UIViewAutoresizingFlexibleHeight|UIViewAutoresizingFlexibleWidth;
 		[self.contentView addSubview:_calendarView];
+		
+		_thumbnailView = [[UIImageView alloc]initWithFrame:self.bounds];
+		_thumbnailView.autoresizingMask = UIViewAutoresizingFlexibleHeight|UIViewAutoresizingFlexibleWidth;
+		_thumbnailView.hidden = YES;
+		[self.contentView addSubview:_thumbnailView];
 	}
     return self;
 }
 
+- (UIImage*)thumbnail
+{
+	return self.thumbnailView.image;
+}
+
+- (void)setThumbnail:(UIImage*)thumbnail
+{
+	self.thumbnailView.image = thumbnail;
+	self.thumbnailView.hidden = (thumbnail == nil);
+	self.calendarView.hidden = (thumbnail != nil);
+}
+
+- (void)prepareForReuse
+{
+	[super prepareForReuse];
+	self.thumbnail = nil;
+}
+
 @end
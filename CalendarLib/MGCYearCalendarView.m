@@ -32,6 +32,8 @@
 #import "MGCYearCalendarMonthCell.h"
 #import "MGCMonthMiniCalendarView.h"
 #import "MGCYearCalendarMonthHeaderView.h"
+#import "MGCMonthThumbnailCache.h"
+#import "MGCYearCalendarViewLayout.h"
 #import "NSCalendar+MGCAdditions.h"
 #import "Constant.h"
 
@@ -45,6 +47,7 @@ static const CGFloat kCellMinimumSpacing = 25;			// minimum distance between mon
 static const CGFloat kDefaultDayFontSize = 13;			// default font size for the day ordinals
 static const CGFloat kDefaultMonthHeaderFontSize = 20;	// default font size for the month headers
 static const CGFloat kDefaultYearHeaderFontSize = 40;	// deafult font size for the year headers
+static const NSInteger kThumbnailsPrefetchYears = 1;	// number of years rendered in advance in the scrolling direction
 
 static const CGFloat kCellMinimumSpacingiPhone = 0;			// minimum distance between month cells
 static const CGFloat kDefaultDayFontSizeiPhone = 7;			// default font size for the day ordinals
@@ -85,12 +88,52 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
 
 #pragma mark -
 
-@interface MGCYearCalendarView ()<UICollectionViewDataSource, UICollectionViewDelegateFlowLayout, MGCMonthMiniCalendarViewDelegate>
+// MGCMonthThumbnailKey: identifies a pre-rendered month in the thumbnails cache.
+@interface MGCMonthThumbnailKey : NSObject<NSCopying>
+
+@property (nonatomic) id content;	// snapshot of the month view returned by contentForBackgroundRendering
+@property (nonatomic) CGSize size;	// size of the thumbnail
+
+@end
+
+@implementation MGCMonthThumbnailKey
+
+- (id)copyWithZone:(NSZone*)zone
+{
+    return self;    // immutable
+}
+
+- (BOOL)isEqual:(id)object
+{
+    if (![object isKindOfClass:MGCMonthThumbnailKey.class])
+        return NO;
+    
+    MGCMonthThumbnailKey *key = object;
+    return CGSizeEqualToSize(self.size, key.size) && [self.content isEqual:key.content];
+}
+
+- (NSUInteger)hash
+{
+    return [self.content hash];
+}
+
+@end
+
+
+#pragma mark -
+
+@interface MGCYearCalendarView ()<UICollectionViewDataSource, UICollectionViewDelegate, MGCMonthMiniCalendarViewDelegate>
 
 @property (nonatomic, readonly) YearEventsView *eventsView;		// collection view
 @property (nonatomic, copy) NSDate *startDate;					// first loaded day in the views (always set to the first day of the year)
 @property (nonatomic) NSDate *maxStartDate;						// maximum date for the start of a loaded page of the collection view - set with dateRange, nil for infinite scrolling
 @property (nonatomic) NSDateFormatter *dateFormatter;			// used to format month and year headers
+@property (nonatomic) MGCMonthThumbnailCache *thumbnails;		// pre-rendered months
+@property (nonatomic, readonly) MGCMonthMiniCalendarView *monthPrototype;	// offscreen view used to snapshot months without a cell
+@property (nonatomic) CGFloat lastContentOffset;				// used to find the scrolling direction
+@property (nonatomic) NSInteger lastPrefetchedYear;				// last year whose thumbnails were requested in advance
+@property (nonatomic) CGSize monthSize;							// preferred size of the month cells
+@property (nonatomic, copy) NSArray *monthSizeKey;				// calendar and fonts monthSize was computed for
 
 @end
 
@@ -99,6 +142,7 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
 
 // readonly properties whose getter's defined are not auto-synthesized
 @synthesize eventsView = _eventsView;
+@synthesize monthPrototype = _monthPrototype;
 
 #pragma mark - Initialization
 
@@ -108,6 +152,8 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
     _startDate = [_calendar mgc_startOfYearForDate:[NSDate date]];
     _dateFormatter = [NSDateFormatter new];
     _dateFormatter.calendar = _calendar;
+    _thumbnails = [MGCMonthThumbnailCache new];
+    _lastPrefetchedYear = NSIntegerMin;
     if (isiPad) {
         //NSLog(@"---------------- iPAD ------------------");
         _daysFont = [UIFont systemFontOfSize:kDefaultDayFontSize];
@@ -145,13 +191,41 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
 {
     _calendar = calendar;
     
+    [self.thumbnails removeAllThumbnails];
+    self.lastPrefetchedYear = NSIntegerMin;
 }
 
 #pragma mark - Properties
 
-- (UICollectionViewFlowLayout*)layout
+- (MGCYearCalendarViewLayout*)layout
+{
+    return (MGCYearCalendarViewLayout*)self.eventsView.collectionViewLayout;
+}
+
+- (MGCMonthMiniCalendarView*)monthPrototype
 {
-    return (UICollectionViewFlowLayout*)self.eventsView.collectionViewLayout;
+    if (!_monthPrototype)
+    {
+        _monthPrototype = [MGCMonthMiniCalendarView new];
+    }
+    return _monthPrototype;
+}
+
+// size of the month cells, computed again only if the calendar or fonts changed
+- (CGSize)preferredMonthSize
+{
+    NSArray *key = @[ self.calendar, self.daysFont, self.headerFont ];
+    if (![key isEqualToArray:self.monthSizeKey])
+    {
+        MGCMonthMiniCalendarView *cal = self.monthPrototype;
+        cal.calendar = self.calendar;
+        cal.daysFont = self.daysFont;
+        cal.headerText = [self headerTextForMonthAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:0]];
+        
+        self.monthSize = [cal preferredSizeYearWise:YES];
+        self.monthSizeKey = key;
+    }
+    return self.monthSize;
 }
 
 - (void)setDateRange:(MGCDateRange *)dateRange
@@ -226,17 +300,9 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
 
 - (CGRect)rectForYearAtIndex:(NSUInteger)year
 {
-    NSIndexPath *first = [NSIndexPath indexPathForItem:0 inSection:year];
-    
-    CGFloat top = [self.eventsView layoutAttributesForSupplementaryElementOfKind:UICollectionElementKindSectionHeader atIndexPath:first].frame.origin.y;
-    
-    NSDate *date = [self dateForIndexPath:first];
-    NSUInteger lastMonth = [self.calendar rangeOfUnit:NSCalendarUnitMonth inUnit:NSCalendarUnitYear forDate:date].length - 1;
-    
-    NSIndexPath *last = [NSIndexPath indexPathForItem:lastMonth inSection:year];
-    CGFloat bottom = CGRectGetMaxY([self.eventsView layoutAttributesForItemAtIndexPath:last].frame) + self.layout.sectionInset.bottom;
-    
-    return CGRectMake(0, top, self.bounds.size.width, bottom - top);
+    CGRect rect = [self.layout rectForYearAtIndex:year];
+    rect.size.width = self.bounds.size.width;
+    return rect;
 }
 
 - (NSAttributedString*)headerTextForMonthAtIndexPath:(NSIndexPath*)indexPath
@@ -255,6 +321,96 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
     }
 }
 
+// year of date, counted from a fixed reference date (year numbers are not monotonic in some calendars)
+- (NSInteger)yearForDate:(NSDate*)date
+{
+    return [self.calendar components:NSCalendarUnitYear fromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:0] toDate:date options:0].year;
+}
+
+#pragma mark - Thumbnails
+
+- (void)configureMonthView:(MGCMonthMiniCalendarView*)view atIndexPath:(NSIndexPath*)indexPath
+{
+    NSDate *date = [self dateForIndexPath:indexPath];
+    
+    view.calendar = self.calendar;
+    view.date = date;
+    view.daysFont = self.daysFont;
+    view.delegate = self;
+    view.headerText = [self headerTextForMonthAtIndexPath:indexPath];
+    
+    view.highlightedDays = nil;
+    if ([self.calendar mgc_isDate:date sameMonthAsDate:[NSDate date]])
+    {
+        NSUInteger i = [self.calendar components:NSCalendarUnitDay fromDate:date toDate:[NSDate date] options:0].day + 1;
+        view.highlightedDays = [NSIndexSet indexSetWithIndex:i];
+        view.highlightColor = [UIColor redColor];
+    }
+}
+
+// key of the thumbnail for the month shown by view, holding a snapshot of everything its drawing depends on
+- (MGCMonthThumbnailKey*)thumbnailKeyForMonthView:(MGCMonthMiniCalendarView*)view
+{
+    MGCMonthThumbnailKey *key = [MGCMonthThumbnailKey new];
+    key.content = [view contentForBackgroundRendering];
+    key.size = self.layout.itemSize;
+    return key;
+}
+
+// renders the thumbnail for key on a background queue, if it is not already cached.
+// Only the snapshot is drawn from the background queue, never a view.
+- (void)renderThumbnailForKey:(MGCMonthThumbnailKey*)key atIndexPath:(NSIndexPath*)indexPath
+{
+    id content = key.content;
+    NSInteger year = [self yearForDate:[self dateForIndexPath:indexPath]];
+    
+    [self.thumbnails renderThumbnailForKey:key year:year size:key.size drawingBlock:^(CGRect rect) {
+        [MGCMonthMiniCalendarView drawBackgroundRenderingContent:content inRect:rect];
+    }];
+}
+
+// renders the month at indexPath on a background queue, if it is not already cached
+- (void)renderThumbnailForMonthAtIndexPath:(NSIndexPath*)indexPath
+{
+    [self configureMonthView:self.monthPrototype atIndexPath:indexPath];
+    [self renderThumbnailForKey:[self thumbnailKeyForMonthView:self.monthPrototype] atIndexPath:indexPath];
+}
+
+- (void)renderThumbnailsForYearAtIndex:(NSInteger)year
+{
+    NSInteger numMonths = [self numberOfMonthsForYearAtIndex:year];
+    for (NSInteger month = 0; month < numMonths; month++)
+    {
+        [self renderThumbnailForMonthAtIndexPath:[NSIndexPath indexPathForItem:month inSection:year]];
+    }
+}
+
+// renders in advance the years following the visible ones in the scrolling direction
+- (void)prefetchThumbnails
+{
+    CGFloat contentOffset = self.eventsView.contentOffset.y;
+    BOOL scrollingDown = contentOffset >= self.lastContentOffset;
+    self.lastContentOffset = contentOffset;
+    
+    NSArray *visible = [[self.eventsView indexPathsForVisibleItems]sortedArrayUsingSelector:@selector(compare:)];
+    if (visible.count == 0)
+        return;
+    
+    NSIndexPath *first = [visible firstObject], *last = [visible lastObject];
+    self.thumbnails.focusYear = [self yearForDate:[self dateForIndexPath:[visible objectAtIndex:visible.count / 2]]];
+    
+    NSInteger section = scrollingDown ? last.section + kThumbnailsPrefetchYears : first.section - kThumbnailsPrefetchYears;
+    if (section < 0 || section >= [self numberOfSectionsInCollectionView:self.eventsView])
+        return;
+    
+    NSInteger year = [self yearForDate:[self dateForIndexPath:[NSIndexPath indexPathForItem:0 inSection:section]]];
+    if (year != self.lastPrefetchedYear)
+    {
+        self.lastPrefetchedYear = year;
+        [self renderThumbnailsForYearAtIndex:section];
+    }
+}
+
 #pragma mark - Public
 
 - (NSDate*)dateForMonthAtPoint:(CGPoint)pt
@@ -326,10 +482,8 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
         if ((diff = [self adjustStartDate:self.startDate byNumberOfYears:-kYearsLoadingStep]) != 0)
         {
             [self.eventsView reloadData];
-            // strangely, layout is not invalidated immediately.
-            // we have to call prepareLayout ourselves, otherwise layoutAttributesForItemAtIndexPath: will fail (in rectForYearAtIndex:)
+            // the layout computes the offsets of the new years on demand, straight from the data source
             [self.layout invalidateLayout];
-            [self.layout prepareLayout];
             newYOffset = [self rectForYearAtIndex:diff].origin.y + yOffset;
         }
     }
@@ -365,8 +519,7 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
 {
     if (!_eventsView)
     {
-        UICollectionViewFlowLayout *layout = [UICollectionViewFlowLayout new];
-        layout.scrollDirection = UICollectionViewScrollDirectionVertical;
+        MGCYearCalendarViewLayout *layout = [MGCYearCalendarViewLayout new];
         
         _eventsView = [[YearEventsView alloc]initWithFrame:CGRectZero collectionViewLayout:layout];
         _eventsView.yearView = self;
@@ -397,13 +550,7 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
 {
     self.eventsView.frame = CGRectMake(0, 0, self.bounds.size.width, self.bounds.size.height);
     
-    MGCMonthMiniCalendarView *cal = [MGCMonthMiniCalendarView new];
-    cal.calendar = self.calendar;
-    cal.daysFont = self.daysFont;
-    cal.headerText = [self headerTextForMonthAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:0]];
-    CGSize cellSize =  [cal preferredSizeYearWise:YES];
-    
-    self.layout.itemSize = cellSize;
+    self.layout.itemSize = [self preferredMonthSize];
     
     if (isiPad) {
         //NSLog(@"---------------- iPAD ------------------");
@@ -421,11 +568,10 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
     
     
     
-    self.layout.headerReferenceSize = CGSizeMake(self.bounds.size.width, 60);
+    self.layout.headerHeight = 60;
     if ([self.delegate respondsToSelector:@selector(heightForYearHeaderInCalendarYearView:)])
     {
-        CGFloat height = [self.delegate heightForYearHeaderInCalendarYearView:self];
-        self.layout.headerReferenceSize = CGSizeMake(0, height);
+        self.layout.headerHeight = [self.delegate heightForYearHeaderInCalendarYearView:self];
     }
     
     if (!self.eventsView.superview)
@@ -455,25 +601,18 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
 
 - (UICollectionViewCell*)collectionView:(UICollectionView*)collectionView cellForItemAtIndexPath:(NSIndexPath*)indexPath
 {
-    NSDate *date = [self dateForIndexPath:indexPath];
-    
     MGCYearCalendarMonthCell* cell = [self.eventsView dequeueReusableCellWithReuseIdentifier:MonthCellReuseIdentifier forIndexPath:indexPath];
     
-    cell.calendarView.calendar = self.calendar;
-    cell.calendarView.date = date;
-    cell.calendarView.daysFont = self.daysFont;
-    cell.calendarView.delegate = self;
-    cell.calendarView.headerText = [self headerTextForMonthAtIndexPath:indexPath];
+    [self configureMonthView:cell.calendarView atIndexPath:indexPath];
     
-    cell.calendarView.highlightedDays = nil;
-    if ([self.calendar mgc_isDate:date sameMonthAsDate:[NSDate date]])
+    // show the pre-rendered month if there is one, otherwise draw it and render it for next time
+    MGCMonthThumbnailKey *key = [self thumbnailKeyForMonthView:cell.calendarView];
+    cell.thumbnail = [self.thumbnails thumbnailForKey:key];
+    if (!cell.thumbnail)
     {
-        NSUInteger i = [self.calendar components:NSCalendarUnitDay fromDate:date toDate:[NSDate date] options:0].day + 1;
-        cell.calendarView.highlightedDays = [NSIndexSet indexSetWithIndex:i];
-        cell.calendarView.highlightColor = [UIColor redColor];
+        [cell.calendarView setNeedsDisplay];
+        [self renderThumbnailForKey:key atIndexPath:indexPath];
     }
-    
-    [cell.calendarView setNeedsDisplay];
     return cell;
 }
 
@@ -513,11 +652,13 @@ static const CGFloat kDefaultYearHeaderFontSizeiPhone = 20;	// deafult font size
     return reusableview;
 }
 
-#pragma mark - UICollectionViewDelegateFlowLayout
+#pragma mark - UICollectionViewDelegate
 
 
 - (void)scrollViewDidScroll:(UIScrollView*)scrollview
 {
+    [self prefetchThumbnails];
+    
     if ([self.delegate respondsToSelector:@selector(calendarYearViewDidScroll:)])
     {
         [self.delegate calendarYearViewDidScroll:self];
@@ -0,0 +1,52 @@
+//
+//  MGCYearCalendarViewLayout.h
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import <UIKit/UIKit.h>
+
+
+// Layout of the year calendar view: each section is a year, with a header on top,
+// followed by its months laid out in rows of equally sized cells.
+// Frames are computed arithmetically from the year and month indexes, so the layout
+// never builds attributes for elements that are not asked for. The only state is the
+// vertical offset of each year, which is computed on demand from the number of months
+// returned by the data source, and dropped when the layout is invalidated.
+@interface MGCYearCalendarViewLayout : UICollectionViewLayout
+
+@property (nonatomic) CGSize itemSize;							// size of a month cell
+@property (nonatomic) CGFloat minimumInteritemSpacing;			// minimum horizontal space between month cells
+@property (nonatomic) CGFloat minimumLineSpacing;				// vertical space between rows of month cells
+@property (nonatomic) UIEdgeInsets sectionInset;				// margins around the months of a year
+@property (nonatomic) CGFloat headerHeight;						// height of the year headers - 0 to hide them
+@property (nonatomic, readonly) NSUInteger numberOfColumns;		// number of month cells in a row
+
+// rect of the year at given index, including its header and insets
+- (CGRect)rectForYearAtIndex:(NSUInteger)year;
+
+@end
@@ -0,0 +1,284 @@
+//
+//  MGCYearCalendarViewLayout.m
+//  Graphical Calendars Library for iOS
+//
+//  Distributed under the MIT License
+//  Get the latest version from here:
+//
+//	https://github.com/jumartin/Calendar
+//
+//  Copyright (c) 2014-2016 Julien Martin
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#import "MGCYearCalendarViewLayout.h"
+
+
+@interface MGCYearCalendarViewLayout ()
+
+@property (nonatomic) NSData *yearOffsets;		// numberOfYears + 1 CGFloat values: vertical offset of each year, and content height
+
+@end
+
+
+@implementation MGCYearCalendarViewLayout
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		_itemSize = CGSizeMake(50, 50);
+		_minimumInteritemSpacing = 10;
+		_minimumLineSpacing = 10;
+	}
+	return self;
+}
+
+#pragma mark - Properties
+
+- (void)setItemSize:(CGSize)itemSize
+{
+	if (!CGSizeEqualToSize(itemSize, _itemSize)) {
+		_itemSize = itemSize;
+		[self invalidateLayout];
+	}
+}
+
+- (void)setMinimumInteritemSpacing:(CGFloat)minimumInteritemSpacing
+{
+	if (minimumInteritemSpacing != _minimumInteritemSpacing) {
+		_minimumInteritemSpacing = minimumInteritemSpacing;
+		[self invalidateLayout];
+	}
+}
+
+- (void)setMinimumLineSpacing:(CGFloat)minimumLineSpacing
+{
+	if (minimumLineSpacing != _minimumLineSpacing) {
+		_minimumLineSpacing = minimumLineSpacing;
+		[self invalidateLayout];
+	}
+}
+
+- (void)setSectionInset:(UIEdgeInsets)sectionInset
+{
+	if (!UIEdgeInsetsEqualToEdgeInsets(sectionInset, _sectionInset)) {
+		_sectionInset = sectionInset;
+		[self invalidateLayout];
+	}
+}
+
+- (void)setHeaderHeight:(CGFloat)headerHeight
+{
+	if (headerHeight != _headerHeight) {
+		_headerHeight = headerHeight;
+		[self invalidateLayout];
+	}
+}
+
+#pragma mark - Geometry
+
+- (CGFloat)contentWidth
+{
+	UIEdgeInsets insets = self.collectionView.contentInset;
+	return MAX(0, self.collectionView.bounds.size.width - insets.left - insets.right);
+}
+
+- (CGFloat)availableWidth
+{
+	return MAX(0, self.contentWidth - self.sectionInset.left - self.sectionInset.right);
+}
+
+- (NSUInteger)numberOfColumns
+{
+	CGFloat cols = floor((self.availableWidth + self.minimumInteritemSpacing) / (self.itemSize.width + self.minimumInteritemSpacing));
+	return MAX(1, (NSUInteger)cols);
+}
+
+// horizontal distance between the origins of two consecutive month cells in a row.
+// As with the flow layout, cells are justified: extra space goes between them.
+- (CGFloat)columnStride
+{
+	NSUInteger cols = self.numberOfColumns;
+	if (cols == 1) {
+		return 0;
+	}
+	CGFloat spacing = MAX(self.minimumInteritemSpacing, (self.availableWidth - cols * self.itemSize.width) / (cols - 1));
+	return self.itemSize.width + spacing;
+}
+
+- (NSUInteger)numberOfYears
+{
+	id<UICollectionViewDataSource> dataSource = self.collectionView.dataSource;
+	if ([dataSource respondsToSelector:@selector(numberOfSectionsInCollectionView:)]) {
+		return [dataSource numberOfSectionsInCollectionView:self.collectionView];
+	}
+	return 1;
+}
+
+// the data source is asked directly, so that the result is right even before the collection view updates its counts after a reload
+- (NSUInteger)numberOfMonthsInYear:(NSUInteger)year
+{
+	return [self.collectionView.dataSource collectionView:self.collectionView numberOfItemsInSection:year];
+}
+
+- (NSUInteger)numberOfRowsForNumberOfMonths:(NSUInteger)numMonths
+{
+	NSUInteger cols = self.numberOfColumns;
+	return (numMonths + cols - 1) / cols;
+}
+
+- (CGFloat)heightForYearWithNumberOfMonths:(NSUInteger)numMonths
+{
+	NSUInteger rows = [self numberOfRowsForNumberOfMonths:numMonths];
+	CGFloat monthsHeight = rows > 0 ? rows * self.itemSize.height + (rows - 1) * self.minimumLineSpacing : 0;
+	return self.headerHeight + self.sectionInset.top + monthsHeight + self.sectionInset.bottom;
+}
+
+- (NSData*)yearOffsets
+{
+	if (!_yearOffsets) {
+		NSUInteger numYears = self.numberOfYears;
+		NSMutableData *data = [NSMutableData dataWithLength:(numYears + 1) * sizeof(CGFloat)];
+		CGFloat *offsets = data.mutableBytes;
+		
+		for (NSUInteger year = 0; year < numYears; year++) {
+			offsets[year + 1] = offsets[year] + [self heightForYearWithNumberOfMonths:[self numberOfMonthsInYear:year]];
+		}
+		_yearOffsets = data;
+	}
+	return _yearOffsets;
+}
+
+- (NSUInteger)numberOfLoadedYears
+{
+	return self.yearOffsets.length / sizeof(CGFloat) - 1;
+}
+
+- (CGFloat)yOffsetForYearAtIndex:(NSUInteger)year
+{
+	const CGFloat *offsets = self.yearOffsets.bytes;
+	return offsets[MIN(year, self.numberOfLoadedYears)];
+}
+
+- (CGRect)rectForYearAtIndex:(NSUInteger)year
+{
+	CGFloat top = [self yOffsetForYearAtIndex:year];
+	CGFloat bottom = [self yOffsetForYearAtIndex:year + 1];
+	return CGRectMake(0, top, self.contentWidth, bottom - top);
+}
+
+- (CGRect)frameForMonthAtIndexPath:(NSIndexPath*)indexPath
+{
+	NSUInteger cols = self.numberOfColumns;
+	NSUInteger row = indexPath.item / cols;
+	NSUInteger col = indexPath.item % cols;
+	
+	CGFloat x = self.sectionInset.left + col * self.columnStride;
+	if (cols == 1) {
+		x += (self.availableWidth - self.itemSize.width) / 2.;	// single column is centered
+	}
+	CGFloat y = [self yOffsetForYearAtIndex:indexPath.section] + self.headerHeight + self.sectionInset.top + row * (self.itemSize.height + self.minimumLineSpacing);
+	
+	return (CGRect){ CGPointMake(x, y), self.itemSize };
+}
+
+- (CGRect)frameForHeaderOfYearAtIndex:(NSUInteger)year
+{
+	return CGRectMake(0, [self yOffsetForYearAtIndex:year], self.contentWidth, self.headerHeight);
+}
+
+#pragma mark - UICollectionViewLayout
+
+- (CGSize)collectionViewContentSize
+{
+	return CGSizeMake(self.contentWidth, [self yOffsetForYearAtIndex:self.numberOfLoadedYears]);
+}
+
+- (NSArray*)layoutAttributesForElementsInRect:(CGRect)rect
+{
+	NSMutableArray *allAttribs = [NSMutableArray array];
+	
+	const CGFloat *offsets = self.yearOffsets.bytes;
+	NSUInteger numYears = self.numberOfLoadedYears;
+	
+	// only a few years are loaded at a time, a linear search is fine
+	for (NSUInteger year = 0; year < numYears && offsets[year] < CGRectGetMaxY(rect); year++) {
+		if (offsets[year + 1] <= CGRectGetMinY(rect)) {
+			continue;
+		}
+		
+		if (self.headerHeight > 0 && CGRectIntersectsRect(rect, [self frameForHeaderOfYearAtIndex:year])) {
+			[allAttribs addObject:[self layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionHeader atIndexPath:[NSIndexPath indexPathForItem:0 inSection:year]]];
+		}
+		
+		// rows of months intersecting rect
+		NSUInteger numMonths = [self numberOfMonthsInYear:year];
+		NSUInteger numRows = [self numberOfRowsForNumberOfMonths:numMonths];
+		CGFloat rowStride = self.itemSize.height + self.minimumLineSpacing;
+		CGFloat monthsTop = offsets[year] + self.headerHeight + self.sectionInset.top;
+		
+		if (numRows == 0 || rowStride <= 0) {
+			continue;
+		}
+		
+		NSInteger firstRow = MAX(0, floor((CGRectGetMinY(rect) - monthsTop - self.itemSize.height) / rowStride));
+		NSInteger lastRow = MIN((NSInteger)numRows - 1, floor((CGRectGetMaxY(rect) - monthsTop) / rowStride));
+		
+		NSUInteger cols = self.numberOfColumns;
+		for (NSInteger row = firstRow; row <= lastRow; row++) {
+			for (NSUInteger item = (NSUInteger)row * cols; item < MIN((NSUInteger)(row + 1) * cols, numMonths); item++) {
+				UICollectionViewLayoutAttributes *attribs = [self layoutAttributesForItemAtIndexPath:[NSIndexPath indexPathForItem:item inSection:year]];
+				if (CGRectIntersectsRect(rect, attribs.frame)) {
+					[allAttribs addObject:attribs];
+				}
+			}
+		}
+	}
+	return allAttribs;
+}
+
+- (UICollectionViewLayoutAttributes*)layoutAttributesForItemAtIndexPath:(NSIndexPath*)indexPath
+{
+	UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
+	attribs.frame = [self frameForMonthAtIndexPath:indexPath];
+	return attribs;
+}
+
+- (UICollectionViewLayoutAttributes*)layoutAttributesForSupplementaryViewOfKind:(NSString*)kind atIndexPath:(NSIndexPath*)indexPath
+{
+	UICollectionViewLayoutAttributes *attribs = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:kind withIndexPath:indexPath];
+	attribs.frame = [self frameForHeaderOfYearAtIndex:indexPath.section];
+	return attribs;
+}
+
+- (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds
+{
+	return newBounds.size.width != self.collectionView.bounds.size.width;
+}
+
+- (void)invalidateLayoutWithContext:(UICollectionViewLayoutInvalidationContext*)context
+{
+	[super invalidateLayoutWithContext:context];
+	
+	// vertical offsets of the years are computed again on demand
+	self.yearOffsets = nil;
+}
+
+@end
@@ -0,0 +1,148 @@
+//
+//  MGCDayBoundaryTableTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCDayBoundaryTable.h"
+#import "NSCalendar+MGCAdditions.h"
+
+
+static const NSUInteger kNumberOfDays = 63;
+
+
+@interface MGCDayBoundaryTableTests : XCTestCase
+
+@end
+
+
+@implementation MGCDayBoundaryTableTests
+
+- (NSCalendar*)calendarWithTimeZoneName:(NSString*)name
+{
+    NSCalendar *calendar = [[NSCalendar alloc] initWithCalendarIdentifier:NSCalendarIdentifierGregorian];
+    calendar.timeZone = [NSTimeZone timeZoneWithName:name];
+    return calendar;
+}
+
+// start of a range of days around the transitions of 2016 in the northern and southern hemisphere
+- (NSDate*)startDateWithCalendar:(NSCalendar*)calendar month:(NSInteger)month
+{
+    NSDateComponents *comps = [NSDateComponents new];
+    comps.year = 2016;
+    comps.month = month;
+    comps.day = 1;
+    return [calendar dateFromComponents:comps];
+}
+
+// time zones with daylight saving time transitions at 2am, at midnight (Sao Paulo), of 30 minutes (Lord Howe),
+// and without transitions
+- (NSArray*)timeZoneNames
+{
+    return @[ @"Europe/Paris", @"America/New_York", @"America/Sao_Paulo", @"Australia/Lord_Howe", @"Asia/Tokyo", @"GMT" ];
+}
+
+- (void)testDaysMatchCalendar
+{
+    for (NSString *name in [self timeZoneNames]) {
+        NSCalendar *calendar = [self calendarWithTimeZoneName:name];
+        
+        for (NSNumber *month in @[ @2, @9, @10 ]) {
+            NSDate *startDate = [self startDateWithCalendar:calendar month:month.integerValue];
+            MGCDayBoundaryTable *table = [MGCDayBoundaryTable tableWithCalendar:calendar startDate:startDate numberOfDays:kNumberOfDays];
+            
+            // include days before and after the table, which are computed by the calendar
+            for (NSInteger day = -3; day < (NSInteger)kNumberOfDays + 3; day++) {
+                NSDateComponents *comps = [NSDateComponents new];
+                comps.day = day;
+                NSDate *expected = [calendar dateByAddingComponents:comps toDate:startDate options:0];
+                
+                XCTAssertEqualObjects([table dateForDayOffset:day], expected, @"%@, day %ld", name, (long)day);
+            }
+        }
+    }
+}
+
+- (void)testDatesMatchCalendar
+{
+    for (NSString *name in [self timeZoneNames]) {
+        NSCalendar *calendar = [self calendarWithTimeZoneName:name];
+        
+        for (NSNumber *month in @[ @2, @9, @10 ]) {
+            NSDate *startDate = [self startDateWithCalendar:calendar month:month.integerValue];
+            MGCDayBoundaryTable *table = [MGCDayBoundaryTable tableWithCalendar:calendar startDate:startDate numberOfDays:kNumberOfDays];
+            
+            // every 10 minutes, from 2 days before the table to 2 days after
+            NSTimeInterval end = (kNumberOfDays + 2) * 24 * 3600;
+            for (NSTimeInterval t = -2 * 24 * 3600; t < end; t += 600) {
+                NSDate *date = [startDate dateByAddingTimeInterval:t];
+                
+                NSInteger dayOffset = [calendar components:NSCalendarUnitDay fromDate:startDate toDate:date options:0].day;
+                XCTAssertEqual([table dayOffsetForDate:date], dayOffset, @"%@, %@", name, date);
+                
+                XCTAssertEqualObjects([table startOfDayForDate:date], [calendar mgc_startOfDayForDate:date], @"%@, %@", name, date);
+                
+                NSDateComponents *comps = [calendar components:NSCalendarUnitHour|NSCalendarUnitMinute|NSCalendarUnitSecond fromDate:date];
+                NSTimeInterval timeOfDay = comps.hour * 3600 + comps.minute * 60 + comps.second;
+                XCTAssertEqual([table timeOfDayForDate:date], timeOfDay, @"%@, %@", name, date);
+            }
+        }
+    }
+}
+
+- (void)testSettingTimeOfDayMatchesCalendar
+{
+    for (NSString *name in [self timeZoneNames]) {
+        NSCalendar *calendar = [self calendarWithTimeZoneName:name];
+        
+        for (NSNumber *month in @[ @2, @9, @10 ]) {
+            NSDate *startDate = [self startDateWithCalendar:calendar month:month.integerValue];
+            MGCDayBoundaryTable *table = [MGCDayBoundaryTable tableWithCalendar:calendar startDate:startDate numberOfDays:kNumberOfDays];
+            
+            for (NSInteger day = -2; day < (NSInteger)kNumberOfDays + 2; day++) {
+                NSDate *date = [table dateForDayOffset:day];
+                
+                // every half hour, and the last minute of the day as used for the scrollable time range
+                for (NSInteger minutes = 0; minutes < 24 * 60; minutes += (minutes == 23 * 60 + 30 ? 29 : 30)) {
+                    NSDate *expected = [calendar dateBySettingHour:minutes / 60 minute:minutes % 60 second:0 ofDate:date options:0];
+                    NSDate *result = [table dateBySettingTimeOfDay:minutes * 60 ofDate:date];
+                    
+                    XCTAssertEqualObjects(result, expected, @"%@, %@, %ld:%02ld", name, date, (long)(minutes / 60), (long)(minutes % 60));
+                }
+            }
+        }
+    }
+}
+
+- (void)testPerformanceOfCalendar
+{
+    NSCalendar *calendar = [self calendarWithTimeZoneName:@"Europe/Paris"];
+    NSDate *startDate = [self startDateWithCalendar:calendar month:3];
+    
+    [self measureBlock:^{
+        for (NSTimeInterval t = 0; t < kNumberOfDays * 24 * 3600; t += 900) {
+            NSDate *date = [startDate dateByAddingTimeInterval:t];
+            [calendar components:NSCalendarUnitDay fromDate:startDate toDate:date options:0];
+            [calendar components:NSCalendarUnitHour|NSCalendarUnitMinute fromDate:date];
+        }
+    }];
+}
+
+- (void)testPerformanceOfTable
+{
+    NSCalendar *calendar = [self calendarWithTimeZoneName:@"Europe/Paris"];
+    NSDate *startDate = [self startDateWithCalendar:calendar month:3];
+    
+    [self measureBlock:^{
+        MGCDayBoundaryTable *table = [MGCDayBoundaryTable tableWithCalendar:calendar startDate:startDate numberOfDays:kNumberOfDays];
+        for (NSTimeInterval t = 0; t < kNumberOfDays * 24 * 3600; t += 900) {
+            NSDate *date = [startDate dateByAddingTimeInterval:t];
+            [table dayOffsetForDate:date];
+            [table timeOfDayForDate:date];
+        }
+    }];
+}
+
+@end
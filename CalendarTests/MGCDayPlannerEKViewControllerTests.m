@@ -0,0 +1,151 @@
+//
+//  MGCDayPlannerEKViewControllerTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCDayPlannerEKViewController.h"
+#import "MGCDateRange.h"
+#import "NSCalendar+MGCAdditions.h"
+#import "MGCEventDescriptorArray.h"
+
+
+// in-memory event source, counting the queries it receives
+@interface MGCInMemoryEventSource : NSObject<MGCEventSource>
+
+@property (nonatomic) NSArray *events;
+@property (nonatomic) NSUInteger numberOfQueries;
+
+@end
+
+
+@implementation MGCInMemoryEventSource
+
+- (NSArray*)eventsFrom:(NSDate*)startDate to:(NSDate*)endDate calendars:(NSArray*)calendars
+{
+    self.numberOfQueries++;
+
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(EKEvent *ev, NSDictionary *bindings) {
+        return [ev.startDate compare:endDate] == NSOrderedAscending && [ev.endDate compare:startDate] == NSOrderedDescending;
+    }];
+    return [[self.events filteredArrayUsingPredicate:predicate] sortedArrayUsingSelector:@selector(compareStartDateWithEvent:)];
+}
+
+@end
+
+
+@interface MGCDayPlannerEKViewController (Testing)
+
+- (NSDictionary*)eventsPerDayInDateRange:(MGCDateRange*)range;
+- (NSArray*)dayRangesForDates:(NSArray*)dates;
+
+@end
+
+
+// private class of MGCDayPlannerEKViewController.m
+@interface MGCDayEventsSnapshot : NSObject
+
+@property (nonatomic, readonly) MGCEventDescriptorArray *descriptors;
+
+- (instancetype)initWithEvents:(NSArray*)events calendars:(NSSet*)calendars calendar:(NSCalendar*)calendar;
+
+@end
+
+
+@interface MGCDayPlannerEKViewControllerTests : XCTestCase
+
+@property (nonatomic) NSCalendar *calendar;
+@property (nonatomic) EKEventStore *eventStore;
+@property (nonatomic) NSDate *day0;
+
+@end
+
+
+@implementation MGCDayPlannerEKViewControllerTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.calendar = [NSCalendar currentCalendar];   // default calendar of the controller - setting it would load the view
+    self.eventStore = [EKEventStore new];
+    self.day0 = [self.calendar mgc_startOfDayForDate:[NSDate date]];
+}
+
+- (NSDate*)dateForDay:(NSInteger)day hour:(NSInteger)hour
+{
+    NSDateComponents *comps = [NSDateComponents new];
+    comps.day = day;
+    comps.hour = hour;
+    return [self.calendar dateByAddingComponents:comps toDate:self.day0 options:0];
+}
+
+- (EKEvent*)eventFrom:(NSDate*)start to:(NSDate*)end allDay:(BOOL)allDay
+{
+    EKEvent *ev = [EKEvent eventWithEventStore:self.eventStore];
+    ev.allDay = allDay;
+    ev.startDate = start;
+    ev.endDate = end;
+    return ev;
+}
+
+- (void)testEventsAreBucketedPerDayWithOneQuery
+{
+    EKEvent *morning = [self eventFrom:[self dateForDay:0 hour:9] to:[self dateForDay:0 hour:10] allDay:NO];
+    EKEvent *overnight = [self eventFrom:[self dateForDay:0 hour:22] to:[self dateForDay:1 hour:2] allDay:NO];
+    EKEvent *untilMidnight = [self eventFrom:[self dateForDay:1 hour:20] to:[self dateForDay:2 hour:0] allDay:NO];
+    EKEvent *holidays = [self eventFrom:[self dateForDay:1 hour:0] to:[self dateForDay:5 hour:0] allDay:YES];
+    EKEvent *outside = [self eventFrom:[self dateForDay:6 hour:9] to:[self dateForDay:6 hour:10] allDay:NO];
+
+    MGCInMemoryEventSource *source = [MGCInMemoryEventSource new];
+    source.events = @[ outside, holidays, untilMidnight, overnight, morning ];
+
+    MGCDayPlannerEKViewController *controller = [[MGCDayPlannerEKViewController alloc]initWithEventStore:self.eventStore];
+    controller.eventSource = source;
+
+    MGCDateRange *range = [MGCDateRange dateRangeWithStart:[self dateForDay:0 hour:0] end:[self dateForDay:3 hour:0]];
+    NSDictionary *eventsPerDay = [controller eventsPerDayInDateRange:range];
+
+    XCTAssertEqual(source.numberOfQueries, 1);
+    XCTAssertEqualObjects(eventsPerDay[[self dateForDay:0 hour:0]], (@[ morning, overnight ]));
+    XCTAssertEqualObjects(eventsPerDay[[self dateForDay:1 hour:0]], (@[ overnight, holidays, untilMidnight ]));
+    XCTAssertEqualObjects(eventsPerDay[[self dateForDay:2 hour:0]], (@[ holidays ]));
+    XCTAssertNil(eventsPerDay[[self dateForDay:3 hour:0]]);
+}
+
+- (void)testDaysAreCoalescedIntoContiguousRanges
+{
+    MGCDayPlannerEKViewController *controller = [[MGCDayPlannerEKViewController alloc]initWithEventStore:self.eventStore];
+
+    NSArray *dates = @[ [self dateForDay:8 hour:0], [self dateForDay:1 hour:0], [self dateForDay:0 hour:0], [self dateForDay:4 hour:0], [self dateForDay:2 hour:0], [self dateForDay:5 hour:0] ];
+    NSArray *ranges = [controller dayRangesForDates:dates];
+
+    XCTAssertEqual(ranges.count, 3);
+    XCTAssertEqualObjects(ranges[0], [MGCDateRange dateRangeWithStart:[self dateForDay:0 hour:0] end:[self dateForDay:3 hour:0]]);
+    XCTAssertEqualObjects(ranges[1], [MGCDateRange dateRangeWithStart:[self dateForDay:4 hour:0] end:[self dateForDay:6 hour:0]]);
+    XCTAssertEqualObjects(ranges[2], [MGCDateRange dateRangeWithStart:[self dateForDay:8 hour:0] end:[self dateForDay:9 hour:0]]);
+}
+
+- (void)testDescriptorIdentifiersAreStableAcrossSnapshots
+{
+    EKEvent *morning = [self eventFrom:[self dateForDay:0 hour:9] to:[self dateForDay:0 hour:10] allDay:NO];
+    EKEvent *evening = [self eventFrom:[self dateForDay:0 hour:18] to:[self dateForDay:0 hour:19] allDay:NO];
+    morning.calendar = evening.calendar = self.eventStore.defaultCalendarForNewEvents;
+    NSSet *calendars = morning.calendar ? [NSSet setWithObject:morning.calendar] : [NSSet set];
+    
+    MGCDayEventsSnapshot *snapshot = [[MGCDayEventsSnapshot alloc]initWithEvents:@[ morning, evening ] calendars:calendars calendar:self.calendar];
+    MGCDayEventsSnapshot *reloaded = [[MGCDayEventsSnapshot alloc]initWithEvents:@[ morning, evening ] calendars:calendars calendar:self.calendar];
+    
+    NSUInteger count = [snapshot.descriptors numberOfEventsOfType:MGCTimedEventType];
+    XCTAssertEqual(count, [reloaded.descriptors numberOfEventsOfType:MGCTimedEventType]);
+    for (NSUInteger i = 0; i < count; i++) {
+        XCTAssertEqual([snapshot.descriptors descriptorOfType:MGCTimedEventType atIndex:i].identifier, [reloaded.descriptors descriptorOfType:MGCTimedEventType atIndex:i].identifier);
+    }
+    if (count == 2) {
+        XCTAssertNotEqual([snapshot.descriptors descriptorOfType:MGCTimedEventType atIndex:0].identifier, [snapshot.descriptors descriptorOfType:MGCTimedEventType atIndex:1].identifier);
+    }
+}
+
+@end
@@ -0,0 +1,411 @@
+//
+//  MGCEventsLayoutCoreTests.c
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+//  Checks the layout core against the reference implementations of the layout algorithms,
+//  on randomized days. Runs without UIKit (see CMakeLists.txt).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "MGCEventsLayoutCore.h"
+
+
+#define MAX_EVENTS 400
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { failures++; printf("%s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+
+static MGCLayoutRect AlignedRectMake(MGCLayoutFloat x, MGCLayoutFloat y, MGCLayoutFloat width, MGCLayoutFloat height, MGCLayoutFloat scale)
+{
+    return MGCLayoutAlignedRect(MGCLayoutRectMake(x, y, width, height), scale);
+}
+
+// frames of the cells before covering, sorted by y-position, as built by MGCTimedEventsViewLayout
+static size_t ReferenceInitialCells(const MGCEventSpan *spans, size_t count, const MGCTimedEventsLayoutParams *params, MGCEventCellLayout *cells)
+{
+    for (size_t i = 0; i < count; i++) {
+        MGCLayoutFloat height = fmax(params->minimumVisibleHeight, spans[i].end - spans[i].start);
+        MGCLayoutRect frame = AlignedRectMake(params->columnX, spans[i].start + 1, params->columnWidth, height - 2, params->scale);
+        MGCEventCellLayout cell = { frame, frame.height, 1, spans[i].index };
+
+        // insertion sort, stable
+        size_t j = i;
+        while (j > 0 && cells[j - 1].frame.y > cell.frame.y) {
+            cells[j] = cells[j - 1];
+            j--;
+        }
+        cells[j] = cell;
+    }
+    return count;
+}
+
+// classic covering, as originally implemented in -[MGCTimedEventsViewLayout adjustLayoutForOverlappingCells:inSection:]
+static void ReferenceClassicCovering(MGCEventCellLayout *cells, size_t count, const MGCTimedEventsLayoutParams *params)
+{
+    const MGCLayoutFloat kOverlapOffset = 4.;
+    size_t group[MAX_EVENTS], covered[MAX_EVENTS];
+
+    for (size_t i = 0; i < count; i++) {
+        size_t groupCount = 0, coveredCount = 0;
+        group[groupCount++] = i;
+
+        for (long j = (long)i - 1; j >= 0; j--) {
+            if (MGCLayoutRectIntersectsRect(cells[i].frame, cells[j].frame)) {
+                MGCLayoutFloat visibleHeight = fabs(cells[i].frame.y - cells[j].frame.y);
+                if (visibleHeight > params->minimumVisibleHeight) {
+                    covered[coveredCount++] = j;
+                    cells[j].visibleHeight = visibleHeight;
+                    cells[i].zIndex = cells[j].zIndex + 1;
+                }
+                else {
+                    group[groupCount++] = j;
+                }
+            }
+        }
+
+        MGCLayoutFloat groupOffset = 0;
+        if (coveredCount > 0) {
+            int lookForEmptySlot = 1;
+            size_t slotNumber = 0;
+            MGCLayoutFloat offset = 0;
+            while (lookForEmptySlot) {
+                offset = slotNumber * kOverlapOffset;
+                lookForEmptySlot = 0;
+                for (size_t k = 0; k < coveredCount; k++) {
+                    if (cells[covered[k]].frame.x - params->columnX == offset) {
+                        lookForEmptySlot = 1;
+                        break;
+                    }
+                }
+                slotNumber += 1;
+            }
+            groupOffset += offset;
+        }
+
+        MGCLayoutFloat totalWidth = (params->columnWidth - 1.) - groupOffset;
+        MGCLayoutFloat colWidth = totalWidth / groupCount;
+        MGCLayoutFloat x = params->columnX + groupOffset;
+
+        for (size_t k = groupCount; k-- > 0;) {
+            MGCLayoutRect frame = cells[group[k]].frame;
+            cells[group[k]].frame = AlignedRectMake(x, frame.y, colWidth, frame.height, params->scale);
+            x += colWidth;
+        }
+    }
+}
+
+// complex covering, as originally implemented in -[MGCTimedEventsViewLayout expandCellsToMaxWidthInCluster:]
+static void ReferenceComplexCovering(MGCEventCellLayout *cells, size_t count, const MGCTimedEventsLayoutParams *params)
+{
+    static size_t clusters[MAX_EVENTS][MAX_EVENTS], columns[MAX_EVENTS][MAX_EVENTS];
+    size_t clusterSizes[MAX_EVENTS], columnSizes[MAX_EVENTS];
+    size_t numClusters = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        long destination = -1;
+        for (size_t c = 0; c < numClusters; c++) {
+            for (size_t k = 0; k < clusterSizes[c]; k++) {
+                if (MGCLayoutRectIntersectsRect(cells[clusters[c][k]].frame, cells[i].frame)) {
+                    destination = c;
+                    break;
+                }
+            }
+        }
+        if (destination < 0) {
+            destination = numClusters++;
+            clusterSizes[destination] = 0;
+        }
+        clusters[destination][clusterSizes[destination]++] = i;
+    }
+
+    for (size_t c = 0; c < numClusters; c++) {
+        size_t numColumns = 1;
+        columnSizes[0] = 0;
+
+        for (size_t k = 0; k < clusterSizes[c]; k++) {
+            size_t i = clusters[c][k];
+            int isPlaced = 0;
+            for (size_t col = 0; col < numColumns; col++) {
+                if (columnSizes[col] == 0) {
+                    columns[col][columnSizes[col]++] = i;
+                    isPlaced = 1;
+                }
+                else if (!MGCLayoutRectIntersectsRect(cells[i].frame, cells[columns[col][columnSizes[col] - 1]].frame)) {
+                    columns[col][columnSizes[col]++] = i;
+                    isPlaced = 1;
+                    break;
+                }
+            }
+            if (!isPlaced) {
+                columnSizes[numColumns] = 0;
+                columns[numColumns][columnSizes[numColumns]++] = i;
+                numColumns++;
+            }
+        }
+
+        MGCLayoutFloat colWidth = (params->columnWidth - 2.f) / numColumns;
+        for (size_t col = 0; col < numColumns; col++) {
+            for (size_t k = 0; k < columnSizes[col]; k++) {
+                MGCLayoutRect frame = cells[columns[col][k]].frame;
+                cells[columns[col][k]].frame = AlignedRectMake(frame.x + col * colWidth, frame.y, colWidth, frame.height, params->scale);
+            }
+        }
+    }
+}
+
+static void RandomSpans(MGCEventSpan *spans, size_t count, MGCLayoutFloat minimumVisibleHeight)
+{
+    for (size_t i = 0; i < count; i++) {
+        // cluster start times so that a lot of events overlap or start at the same position
+        MGCLayoutFloat start = (rand() % 48) * 25. + (rand() % 3) * 7.5;
+        MGCLayoutFloat height = fmax(minimumVisibleHeight, rand() % 200) + (rand() % 4) / 3.;
+        spans[i] = (MGCEventSpan){ start, start + height, i };
+    }
+}
+
+static void TestTimedEvents(MGCEventCovering covering)
+{
+    static MGCEventSpan spans[MAX_EVENTS];
+    static MGCEventCellLayout expected[MAX_EVENTS], cells[MAX_EVENTS];
+
+    for (int run = 0; run < 2000; run++) {
+        MGCTimedEventsLayoutParams params;
+        params.columnWidth = 40. + (rand() % 3000) / 10.;
+        params.columnX = (rand() % 7) * params.columnWidth;
+        params.minimumVisibleHeight = 15.;
+        params.scale = 1 + rand() % 3;
+        params.covering = covering;
+
+        size_t count = rand() % (run % 10 == 0 ? MAX_EVENTS : 40);
+        RandomSpans(spans, count, params.minimumVisibleHeight);
+
+        ReferenceInitialCells(spans, count, &params, expected);
+        if (covering == MGCEventCoveringClassic) {
+            ReferenceClassicCovering(expected, count, &params);
+        }
+        else {
+            ReferenceComplexCovering(expected, count, &params);
+        }
+
+        MGCLayoutTimedEvents(spans, count, &params, cells);
+
+        for (size_t i = 0; i < count; i++) {
+            CHECK(cells[i].index == expected[i].index, "covering %d run %d: cell %zu has index %zu, expected %zu", covering, run, i, cells[i].index, expected[i].index);
+            CHECK(memcmp(&cells[i].frame, &expected[i].frame, sizeof(MGCLayoutRect)) == 0, "covering %d run %d: cell %zu frame (%g %g %g %g), expected (%g %g %g %g)", covering, run, i,
+                  cells[i].frame.x, cells[i].frame.y, cells[i].frame.width, cells[i].frame.height,
+                  expected[i].frame.x, expected[i].frame.y, expected[i].frame.width, expected[i].frame.height);
+            CHECK(cells[i].visibleHeight == expected[i].visibleHeight, "covering %d run %d: cell %zu visible height %g, expected %g", covering, run, i, cells[i].visibleHeight, expected[i].visibleHeight);
+            CHECK(cells[i].zIndex == expected[i].zIndex, "covering %d run %d: cell %zu zIndex %ld, expected %ld", covering, run, i, cells[i].zIndex, expected[i].zIndex);
+        }
+    }
+}
+
+// frames computed from placements are the same as the ones of MGCLayoutTimedEvents, and for complex covering
+// (which does not depend on the column width) placements can be reused for another column
+static void TestFramesOfPlacements(MGCEventCovering covering)
+{
+    static MGCEventSpan spans[MAX_EVENTS];
+    static MGCEventCellPlacement placements[MAX_EVENTS];
+    static MGCEventCellLayout expected[MAX_EVENTS], cells[MAX_EVENTS];
+
+    for (int run = 0; run < 2000; run++) {
+        MGCTimedEventsLayoutParams params;
+        params.columnWidth = 40. + (rand() % 3000) / 10.;
+        params.columnX = (rand() % 7) * params.columnWidth;
+        params.minimumVisibleHeight = 15.;
+        params.scale = 1 + rand() % 3;
+        params.covering = covering;
+
+        size_t count = rand() % (run % 10 == 0 ? MAX_EVENTS : 40);
+        RandomSpans(spans, count, params.minimumVisibleHeight);
+
+        MGCLayoutPlaceTimedEvents(spans, count, &params, placements);
+
+        // move and resize the column, as when the view is resized or recentered
+        MGCTimedEventsLayoutParams placedParams = params;
+        if (run % 2 == 0) {
+            params.columnWidth = 40. + (rand() % 3000) / 10.;
+            params.columnX = (rand() % 7) * params.columnWidth;
+        }
+
+        bool reusable = MGCLayoutCanReusePlacements(&placedParams, &params);
+        bool sameColumn = params.columnX == placedParams.columnX && params.columnWidth == placedParams.columnWidth;
+        CHECK(reusable == (covering == MGCEventCoveringComplex || sameColumn), "covering %d run %d: placements %s reusable", covering, run, reusable ? "should not be" : "should be");
+
+        if (!reusable) {
+            MGCLayoutPlaceTimedEvents(spans, count, &params, placements);
+        }
+
+        MGCLayoutTimedEvents(spans, count, &params, expected);
+        MGCLayoutFrameTimedEvents(placements, count, &params, cells);
+
+        for (size_t i = 0; i < count; i++) {
+            CHECK(cells[i].index == expected[i].index, "covering %d run %d: cell %zu has index %zu, expected %zu", covering, run, i, cells[i].index, expected[i].index);
+            CHECK(memcmp(&cells[i].frame, &expected[i].frame, sizeof(MGCLayoutRect)) == 0, "covering %d run %d: cell %zu frame (%g %g %g %g), expected (%g %g %g %g)", covering, run, i,
+                  cells[i].frame.x, cells[i].frame.y, cells[i].frame.width, cells[i].frame.height,
+                  expected[i].frame.x, expected[i].frame.y, expected[i].frame.width, expected[i].frame.height);
+            CHECK(cells[i].visibleHeight == expected[i].visibleHeight, "covering %d run %d: cell %zu visible height %g, expected %g", covering, run, i, cells[i].visibleHeight, expected[i].visibleHeight);
+            CHECK(cells[i].zIndex == expected[i].zIndex, "covering %d run %d: cell %zu zIndex %ld, expected %ld", covering, run, i, cells[i].zIndex, expected[i].zIndex);
+        }
+    }
+}
+
+static void TestColumnsOfDisjointClusters(void)
+{
+    // 3 events overlapping each other, then 2 consecutive events
+    MGCEventSpan spans[] = { { 0, 60, 0 }, { 10, 30, 1 }, { 20, 50, 2 }, { 60, 90, 3 }, { 90, 120, 4 } };
+    size_t columns[5], columnCounts[5];
+
+    MGCLayoutAssignColumns(spans, 5, columns, columnCounts);
+
+    size_t expectedColumns[] = { 0, 1, 2, 0, 0 };
+    size_t expectedCounts[] = { 3, 3, 3, 1, 1 };
+    for (size_t i = 0; i < 5; i++) {
+        CHECK(columns[i] == expectedColumns[i], "span %zu in column %zu, expected %zu", i, columns[i], expectedColumns[i]);
+        CHECK(columnCounts[i] == expectedCounts[i], "span %zu in cluster of %zu columns, expected %zu", i, columnCounts[i], expectedCounts[i]);
+    }
+}
+
+static void TestEmptyDay(void)
+{
+    MGCTimedEventsLayoutParams params = { 0 };
+    params.columnWidth = 100;
+    params.scale = 2;
+
+    // nothing is allocated nor accessed when there is no event
+    for (MGCEventCovering covering = MGCEventCoveringClassic; covering <= MGCEventCoveringComplex; covering++) {
+        params.covering = covering;
+        CHECK(MGCLayoutTimedEvents(NULL, 0, &params, NULL), "covering %d: layout of an empty day failed", covering);
+        CHECK(MGCLayoutPlaceTimedEvents(NULL, 0, &params, NULL), "covering %d: placement of an empty day failed", covering);
+        MGCLayoutFrameTimedEvents(NULL, 0, &params, NULL);
+    }
+    CHECK(MGCLayoutAssignColumns(NULL, 0, NULL, NULL), "column assignment of an empty day failed");
+}
+
+// all-day events stacking, as originally implemented in -[MGCAllDayEventsViewLayout prepareLayout]
+static size_t ReferenceAllDayEvents(const MGCDayRange *ranges, size_t count, const size_t *eventCounts, size_t numberOfDays, size_t maxVisibleLines, size_t *lines, size_t *hiddenCounts)
+{
+    unsigned long long lineDays[MAX_EVENTS];    // days used on each line
+    size_t numLines = 0, maxLines = 0;
+
+    memset(hiddenCounts, 0, numberOfDays * sizeof(size_t));
+
+    for (size_t i = 0; i < count; i++) {
+        unsigned long long days = 0;
+        for (size_t day = ranges[i].location; day < ranges[i].location + ranges[i].length; day++) {
+            days |= 1ULL << day;
+        }
+
+        size_t numLine = 0;
+        for (; numLine < numLines; numLine++) {
+            if (!(lineDays[numLine] & days)) {
+                lineDays[numLine] |= days;
+                break;
+            }
+        }
+        if (numLine == numLines) {
+            lineDays[numLines++] = days;
+        }
+
+        size_t maxVisibleEvents = 0;
+        for (size_t day = ranges[i].location; day < ranges[i].location + ranges[i].length; day++) {
+            if (eventCounts[day] > maxVisibleEvents) maxVisibleEvents = eventCounts[day];
+        }
+        maxVisibleEvents = maxVisibleEvents > maxVisibleLines ? maxVisibleLines - 1 : maxVisibleEvents;
+
+        if (numLine < maxVisibleEvents) {
+            lines[i] = numLine;
+            if (numLine + 1 > maxLines) maxLines = numLine + 1;
+        }
+        else {
+            lines[i] = MGCLayoutHiddenLine;
+            for (size_t day = ranges[i].location; day < ranges[i].location + ranges[i].length; day++) {
+                hiddenCounts[day]++;
+                maxLines = maxVisibleEvents + 1;
+            }
+        }
+    }
+    return maxLines;
+}
+
+// sorted ranges are laid out by the packer, others by searching a grid of occupied days
+static void TestAllDayEvents(bool sorted)
+{
+    static MGCDayRange ranges[MAX_EVENTS];
+    static size_t lines[MAX_EVENTS], expectedLines[MAX_EVENTS];
+    size_t eventCounts[64], hiddenCounts[64], expectedHiddenCounts[64];
+
+    for (int run = 0; run < 2000; run++) {
+        size_t numberOfDays = 1 + rand() % 31;
+        size_t maxVisibleLines = 1 + rand() % 6;
+        size_t count = rand() % (run % 10 == 0 ? MAX_EVENTS : 30);
+
+        memset(eventCounts, 0, sizeof(eventCounts));
+
+        // ranges are given by day of appearance, as collected by the layout,
+        // which also gives empty ranges at day 0 for events outside of the visible days
+        for (size_t i = 0; i < count; i++) {
+            size_t location = rand() % numberOfDays;
+            size_t length = 1 + rand() % 7;
+            if (location + length > numberOfDays) {
+                length = numberOfDays - location;
+            }
+            if (rand() % 20 == 0) {
+                location = length = 0;
+            }
+            ranges[i] = (MGCDayRange){ location, length, i };
+            for (size_t day = location; day < location + length; day++) {
+                eventCounts[day]++;
+            }
+        }
+        for (size_t i = 1; i < count && sorted; i++) {
+            MGCDayRange range = ranges[i];
+            size_t j = i;
+            while (j > 0 && ranges[j - 1].location > range.location) {
+                ranges[j] = ranges[j - 1];
+                j--;
+            }
+            ranges[j] = range;
+        }
+
+        size_t expectedNumLines = ReferenceAllDayEvents(ranges, count, eventCounts, numberOfDays, maxVisibleLines, expectedLines, expectedHiddenCounts);
+        size_t numLines = MGCLayoutAllDayEvents(ranges, count, eventCounts, numberOfDays, maxVisibleLines, lines, hiddenCounts);
+
+        CHECK(numLines == expectedNumLines, "run %d: %zu lines, expected %zu", run, numLines, expectedNumLines);
+        for (size_t i = 0; i < count; i++) {
+            CHECK(lines[i] == expectedLines[i], "run %d: range %zu on line %zu, expected %zu", run, i, lines[i], expectedLines[i]);
+        }
+        for (size_t day = 0; day < numberOfDays; day++) {
+            CHECK(hiddenCounts[day] == expectedHiddenCounts[day], "run %d: %zu hidden events on day %zu, expected %zu", run, hiddenCounts[day], day, expectedHiddenCounts[day]);
+        }
+    }
+}
+
+int main(void)
+{
+    srand(1);
+
+    TestColumnsOfDisjointClusters();
+    TestEmptyDay();
+    TestTimedEvents(MGCEventCoveringClassic);
+    TestTimedEvents(MGCEventCoveringComplex);
+    TestFramesOfPlacements(MGCEventCoveringClassic);
+    TestFramesOfPlacements(MGCEventCoveringComplex);
+    TestAllDayEvents(true);
+    TestAllDayEvents(false);
+
+    if (failures > 0) {
+        printf("%d test(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("All tests passed\n");
+    return EXIT_SUCCESS;
+}
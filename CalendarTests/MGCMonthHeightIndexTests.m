@@ -0,0 +1,129 @@
+//
+//  MGCMonthHeightIndexTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCMonthHeightIndex.h"
+#import "NSCalendar+MGCAdditions.h"
+
+
+static const CGFloat kRowHeight = 60.;
+static const CGFloat kMonthSpacing = 40.;
+
+
+@interface MGCMonthHeightIndexTests : XCTestCase
+
+@end
+
+
+@implementation MGCMonthHeightIndexTests
+
+- (NSArray*)calendars
+{
+    NSMutableArray *calendars = [NSMutableArray array];
+    for (NSString *identifier in @[ NSCalendarIdentifierGregorian, NSCalendarIdentifierHebrew, NSCalendarIdentifierIslamicCivil ]) {
+        for (NSNumber *firstWeekday in @[ @1, @2, @7 ]) {
+            NSCalendar *calendar = [[NSCalendar alloc] initWithCalendarIdentifier:identifier];
+            calendar.firstWeekday = firstWeekday.unsignedIntegerValue;
+            [calendars addObject:calendar];
+        }
+    }
+    return calendars;
+}
+
+- (MGCMonthHeightIndex*)indexWithCalendar:(NSCalendar*)calendar
+{
+    MGCMonthHeightIndex *index = [MGCMonthHeightIndex indexWithCalendar:calendar referenceDate:[NSDate date]];
+    index.rowHeight = kRowHeight;
+    index.monthSpacing = kMonthSpacing;
+    return index;
+}
+
+// height of the month at given offset, the way the month planner view computed it before the index
+- (CGFloat)expectedHeightForMonthOffset:(NSInteger)monthOffset index:(MGCMonthHeightIndex*)index
+{
+    NSDate *date = [index.calendar dateByAddingUnit:NSCalendarUnitMonth value:monthOffset toDate:index.referenceDate options:0];
+    NSUInteger numWeeks = [index.calendar rangeOfUnit:NSCalendarUnitWeekOfMonth inUnit:NSCalendarUnitMonth forDate:date].length;
+    return numWeeks * kRowHeight + kMonthSpacing;
+}
+
+- (void)testHeightsMatchCalendar
+{
+    for (NSCalendar *calendar in [self calendars]) {
+        MGCMonthHeightIndex *index = [self indexWithCalendar:calendar];
+        
+        // start away from the reference month, so that the table grows in both directions
+        for (NSInteger month = 30; month >= -60; month--) {
+            XCTAssertEqual([index heightForMonthOffset:month], [self expectedHeightForMonthOffset:month index:index], @"%@, month %ld", calendar.calendarIdentifier, (long)month);
+        }
+    }
+}
+
+- (void)testOffsetsAreSumsOfHeights
+{
+    for (NSCalendar *calendar in [self calendars]) {
+        MGCMonthHeightIndex *index = [self indexWithCalendar:calendar];
+        
+        CGFloat y = 0;
+        for (NSInteger month = 0; month < 200; month++) {
+            XCTAssertEqual([index yOffsetForMonthOffset:month], y);
+            y += [index heightForMonthOffset:month];
+        }
+        
+        y = 0;
+        for (NSInteger month = -1; month > -200; month--) {
+            y -= [index heightForMonthOffset:month];
+            XCTAssertEqual([index yOffsetForMonthOffset:month], y);
+        }
+    }
+}
+
+- (void)testMonthForOffset
+{
+    for (NSCalendar *calendar in [self calendars]) {
+        MGCMonthHeightIndex *index = [self indexWithCalendar:calendar];
+        
+        for (NSUInteger i = 0; i < 500; i++) {
+            CGFloat y = (CGFloat)arc4random_uniform(2000000) - 1000000.;
+            NSInteger month = [index monthOffsetForYOffset:y];
+            
+            XCTAssertLessThanOrEqual([index yOffsetForMonthOffset:month], y);
+            XCTAssertGreaterThan([index yOffsetForMonthOffset:month + 1], y);
+        }
+        
+        // month boundaries belong to the month below
+        CGFloat y = [index yOffsetForMonthOffset:12];
+        XCTAssertEqual([index monthOffsetForYOffset:y], 12);
+    }
+}
+
+- (void)testMonthDates
+{
+    NSCalendar *calendar = [NSCalendar currentCalendar];
+    MGCMonthHeightIndex *index = [self indexWithCalendar:calendar];
+    
+    for (NSInteger month = -30; month < 30; month++) {
+        NSDate *date = [index dateForMonthOffset:month];
+        XCTAssertEqualObjects(date, [calendar mgc_startOfMonthForDate:date]);
+        XCTAssertEqual([index monthOffsetForDate:date], month);
+        XCTAssertEqual([index monthOffsetForDate:[calendar dateByAddingUnit:NSCalendarUnitDay value:10 toDate:date options:0]], month);
+    }
+}
+
+- (void)testPerformanceFarAwayOffsets
+{
+    MGCMonthHeightIndex *index = [self indexWithCalendar:[NSCalendar currentCalendar]];
+    
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 1000; i++) {
+            NSInteger month = (NSInteger)arc4random_uniform(2400) - 1200;		// 100 years around the reference month
+            CGFloat y = [index yOffsetForMonthOffset:month];
+            XCTAssertEqual([index monthOffsetForYOffset:y], month);
+        }
+    }];
+}
+
+@end
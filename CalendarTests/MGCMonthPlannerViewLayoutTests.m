@@ -0,0 +1,115 @@
+//
+//  MGCMonthPlannerViewLayoutTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCMonthPlannerViewLayout.h"
+
+
+// data source with given first columns and number of days per month
+@interface MGCMonthsDataSource : NSObject<UICollectionViewDataSource, MGCMonthPlannerViewLayoutDelegate>
+
+@property (nonatomic) NSArray *firstColumns;
+@property (nonatomic) NSArray *numberOfDays;
+@property (nonatomic) NSUInteger columnRequests;   // number of times the layout asked for a column
+
+@end
+
+
+@implementation MGCMonthsDataSource
+
+- (NSInteger)numberOfSectionsInCollectionView:(UICollectionView*)collectionView
+{
+    return self.numberOfDays.count;
+}
+
+- (NSInteger)collectionView:(UICollectionView*)collectionView numberOfItemsInSection:(NSInteger)section
+{
+    return [self.numberOfDays[section] integerValue];
+}
+
+- (UICollectionViewCell*)collectionView:(UICollectionView*)collectionView cellForItemAtIndexPath:(NSIndexPath*)indexPath
+{
+    return nil;
+}
+
+- (NSUInteger)collectionView:(UICollectionView*)collectionView layout:(MGCMonthPlannerViewLayout*)layout columnForDayAtIndexPath:(NSIndexPath*)indexPath
+{
+    self.columnRequests++;
+    return ([self.firstColumns[indexPath.section] unsignedIntegerValue] + indexPath.item) % 7;
+}
+
+@end
+
+
+@interface MGCMonthPlannerViewLayoutTests : XCTestCase
+
+@property (nonatomic) MGCMonthsDataSource *dataSource;
+@property (nonatomic) MGCMonthPlannerViewLayout *layout;
+@property (nonatomic) UICollectionView *collectionView;
+
+@end
+
+
+@implementation MGCMonthPlannerViewLayoutTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    // 5, 5, 6 and 4 rows
+    self.dataSource = [MGCMonthsDataSource new];
+    self.dataSource.firstColumns = @[ @3, @6, @5, @0 ];
+    self.dataSource.numberOfDays = @[ @31, @28, @31, @28 ];
+
+    self.layout = [MGCMonthPlannerViewLayout new];
+    self.layout.delegate = self.dataSource;
+    self.layout.rowHeight = 100;
+    self.layout.monthInsets = UIEdgeInsetsMake(20, 0, 30, 0);
+
+    self.collectionView = [[UICollectionView alloc]initWithFrame:CGRectMake(0, 0, 700, 600) collectionViewLayout:self.layout];
+    self.collectionView.dataSource = self.dataSource;
+    [self.collectionView layoutIfNeeded];
+}
+
+- (void)testMonthsAreStackedFromTheirNumberOfRows
+{
+    CGRect firstDay = [self.layout layoutAttributesForItemAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:2]].frame;
+    XCTAssertEqual(firstDay.origin.x, 500);
+    XCTAssertEqual(firstDay.origin.y, 2 * 50 + 10 * 100 + 20);
+
+    XCTAssertEqual(self.layout.collectionViewContentSize.height, 4 * 50 + 20 * 100);
+}
+
+- (void)testRowHeightChangeMovesMonthsWithoutAskingForColumns
+{
+    NSUInteger requests = self.dataSource.columnRequests;
+
+    self.layout.rowHeight = 80;
+    [self.layout invalidateLayoutWithContext:[UICollectionViewLayoutInvalidationContext new]];
+    [self.collectionView layoutIfNeeded];
+
+    CGRect firstDay = [self.layout layoutAttributesForItemAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:3]].frame;
+    XCTAssertEqual(firstDay.origin.y, 3 * 50 + 16 * 80 + 20);
+    XCTAssertEqual(self.dataSource.columnRequests, requests);
+}
+
+- (void)testGeometriesAreComputedAgainWhenDataChanges
+{
+    NSUInteger requests = self.dataSource.columnRequests;
+
+    self.dataSource.firstColumns = @[ @6, @6, @5, @0 ];
+    [self.collectionView reloadData];
+    [self.collectionView layoutIfNeeded];
+
+    XCTAssertGreaterThan(self.dataSource.columnRequests, requests);
+
+    // the first month now has 6 rows
+    CGRect firstDay = [self.layout layoutAttributesForItemAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:1]].frame;
+    XCTAssertEqual(firstDay.origin.y, 50 + 6 * 100 + 20);
+}
+
+@end
@@ -0,0 +1,109 @@
+//
+//  MGCMonthThumbnailCacheTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCMonthThumbnailCache.h"
+
+
+@interface MGCMonthThumbnailCacheTests : XCTestCase
+
+@end
+
+
+@implementation MGCMonthThumbnailCacheTests
+
+// 10x10 image at scale 1, costing 400 bytes
+- (UIImage*)image
+{
+    UIGraphicsBeginImageContextWithOptions(CGSizeMake(10, 10), NO, 1);
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    return image;
+}
+
+- (void)testCostIsBitmapSize
+{
+    MGCMonthThumbnailCache *cache = [MGCMonthThumbnailCache new];
+    [cache setThumbnail:[self image] forKey:@"a" year:0];
+    [cache setThumbnail:[self image] forKey:@"b" year:0];
+    XCTAssertEqual(cache.totalCost, 800);
+
+    // replacing a thumbnail does not count it twice
+    [cache setThumbnail:[self image] forKey:@"b" year:0];
+    XCTAssertEqual(cache.totalCost, 800);
+    XCTAssertEqual(cache.count, 2);
+
+    [cache removeAllThumbnails];
+    XCTAssertEqual(cache.totalCost, 0);
+    XCTAssertNil([cache thumbnailForKey:@"a"]);
+}
+
+- (void)testYearsFarthestFromFocusAreEvictedFirst
+{
+    MGCMonthThumbnailCache *cache = [MGCMonthThumbnailCache new];
+    cache.totalCostLimit = 4 * 400;
+    cache.focusYear = 2016;
+
+    [cache setThumbnail:[self image] forKey:@"2010" year:2010];
+    [cache setThumbnail:[self image] forKey:@"2016" year:2016];
+    [cache setThumbnail:[self image] forKey:@"2019" year:2019];
+    [cache setThumbnail:[self image] forKey:@"2015" year:2015];
+    [cache setThumbnail:[self image] forKey:@"2017" year:2017];
+
+    XCTAssertEqual(cache.count, 4);
+    XCTAssertNil([cache thumbnailForKey:@"2010"]);
+
+    cache.focusYear = 2010;
+    cache.totalCostLimit = 2 * 400;
+
+    XCTAssertEqual(cache.count, 2);
+    XCTAssertNotNil([cache thumbnailForKey:@"2015"]);
+    XCTAssertNotNil([cache thumbnailForKey:@"2016"]);
+}
+
+- (void)testOldestThumbnailIsEvictedAmongSameDistance
+{
+    MGCMonthThumbnailCache *cache = [MGCMonthThumbnailCache new];
+    cache.totalCostLimit = 2 * 400;
+    cache.focusYear = 2016;
+
+    [cache setThumbnail:[self image] forKey:@"2015" year:2015];
+    [cache setThumbnail:[self image] forKey:@"2017" year:2017];
+    [cache setThumbnail:[self image] forKey:@"2016" year:2016];
+
+    XCTAssertNil([cache thumbnailForKey:@"2015"]);
+    XCTAssertNotNil([cache thumbnailForKey:@"2017"]);
+    XCTAssertNotNil([cache thumbnailForKey:@"2016"]);
+}
+
+- (void)testRenderedThumbnailIsCached
+{
+    MGCMonthThumbnailCache *cache = [MGCMonthThumbnailCache new];
+
+    __block NSUInteger numberOfDraws = 0;
+    void (^block)(CGRect) = ^(CGRect rect) {
+        numberOfDraws++;
+        [[UIColor redColor] setFill];
+        UIRectFill(rect);
+    };
+
+    [cache renderThumbnailForKey:@"a" year:0 size:CGSizeMake(20, 10) drawingBlock:block];
+    [cache renderThumbnailForKey:@"a" year:0 size:CGSizeMake(20, 10) drawingBlock:block];
+    XCTAssertTrue([cache isRenderingThumbnailForKey:@"a"]);
+
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while ([cache isRenderingThumbnailForKey:@"a"] && [timeout timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:.01]];
+    }
+
+    UIImage *thumbnail = [cache thumbnailForKey:@"a"];
+    XCTAssertNotNil(thumbnail);
+    XCTAssertTrue(CGSizeEqualToSize(thumbnail.size, CGSizeMake(20, 10)));
+    XCTAssertEqual(numberOfDraws, 1);
+}
+
+@end
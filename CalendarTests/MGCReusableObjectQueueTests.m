@@ -0,0 +1,153 @@
+//
+//  MGCReusableObjectQueueTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCReusableObjectQueue.h"
+
+
+static NSString* const kIdentifier = @"Identifier";
+
+
+@interface MGCTestReusableObject : NSObject<MGCReusableObject>
+
+@property (nonatomic, copy) NSString *reuseIdentifier;
+@property (nonatomic) NSUInteger reuseCount;
+
+@end
+
+
+@implementation MGCTestReusableObject
+
+- (void)prepareForReuse
+{
+    self.reuseCount++;
+}
+
+@end
+
+
+@interface MGCReusableObjectQueueTests : XCTestCase
+
+@property (nonatomic) MGCReusableObjectQueue *queue;
+
+@end
+
+
+@implementation MGCReusableObjectQueueTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.queue = [MGCReusableObjectQueue new];
+    [self.queue registerClass:MGCTestReusableObject.class forObjectWithReuseIdentifier:kIdentifier];
+}
+
+- (void)testMostRecentlyEnqueuedObjectIsReusedFirst
+{
+    MGCTestReusableObject *obj1 = (MGCTestReusableObject*)[self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier];
+    MGCTestReusableObject *obj2 = (MGCTestReusableObject*)[self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier];
+    XCTAssertEqualObjects(obj1.reuseIdentifier, kIdentifier);
+    XCTAssertNotEqual(obj1, obj2);
+    
+    [self.queue enqueueReusableObject:obj1];
+    [self.queue enqueueReusableObject:obj2];
+    [self.queue enqueueReusableObject:obj2];    // enqueued twice, kept once
+    XCTAssertEqual(self.queue.count, 2);
+    
+    XCTAssertEqual([self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier], obj2);
+    XCTAssertEqual([self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier], obj1);
+    XCTAssertEqual(obj1.reuseCount, 1);
+    
+    XCTAssertEqual(self.queue.totalCreated, 2);
+    XCTAssertEqual(self.queue.misses, 2);
+    XCTAssertEqual(self.queue.hits, 2);
+}
+
+- (void)testUnregisteredIdentifierRaises
+{
+    XCTAssertThrows([self.queue dequeueReusableObjectWithReuseIdentifier:@"Unknown"]);
+}
+
+- (void)testWatermarks
+{
+    [self.queue setLowWatermark:2 highWatermark:5 forReuseIdentifier:kIdentifier];
+    
+    NSMutableArray *objects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 8; i++) {
+        [objects addObject:[self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier]];
+    }
+    for (id<MGCReusableObject> object in objects) {
+        [self.queue enqueueReusableObject:object];
+    }
+    XCTAssertEqual([self.queue countForReuseIdentifier:kIdentifier], 5);
+    
+    // the most recently used objects are kept
+    [self.queue trimToLowWatermarks];
+    XCTAssertEqual([self.queue countForReuseIdentifier:kIdentifier], 2);
+    XCTAssertEqual([self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier], objects[1]);
+    XCTAssertEqual([self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier], objects[0]);
+}
+
+- (void)testDefaultWatermarksKeepEverythingUntilMemoryWarning
+{
+    NSMutableArray *objects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 50; i++) {
+        [objects addObject:[self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier]];
+    }
+    for (id<MGCReusableObject> object in objects) {
+        [self.queue enqueueReusableObject:object];
+    }
+    XCTAssertEqual(self.queue.count, 50);
+    
+    // objects are released in batches when the run loop is idle
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    XCTAssertEqual(self.queue.count, 50);
+    
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2];
+    while (self.queue.count > 0 && [timeout timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:.1]];
+    }
+    XCTAssertEqual(self.queue.count, 0);
+}
+
+- (void)testEnqueueingManyObjectsKeepsEachOnce
+{
+    NSMutableArray *objects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 1000; i++) {
+        [objects addObject:[self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier]];
+    }
+    for (id<MGCReusableObject> object in objects) {
+        [self.queue enqueueReusableObject:object];
+        [self.queue enqueueReusableObject:object];
+    }
+    XCTAssertEqual(self.queue.count, 1000);
+    
+    [self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier];
+    [self.queue enqueueReusableObject:objects.lastObject];
+    XCTAssertEqual(self.queue.count, 1000);
+}
+
+- (void)testPrewarmingWhenIdle
+{
+    [self.queue prewarm:kIdentifier count:10];
+    XCTAssertEqual(self.queue.count, 0);
+    
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2];
+    while ([self.queue countForReuseIdentifier:kIdentifier] < 10 && [timeout timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:.1]];
+    }
+    
+    XCTAssertEqual([self.queue countForReuseIdentifier:kIdentifier], 10);
+    XCTAssertEqual(self.queue.totalCreated, 10);
+    
+    [self.queue dequeueReusableObjectWithReuseIdentifier:kIdentifier];
+    XCTAssertEqual(self.queue.hits, 1);
+    XCTAssertEqual(self.queue.misses, 0);
+}
+
+@end
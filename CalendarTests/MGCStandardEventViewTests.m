@@ -0,0 +1,69 @@
+//
+//  MGCStandardEventViewTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCStandardEventView.h"
+
+
+@interface MGCStandardEventView (Testing)
+
+- (id)textLayoutKeyForWidth:(CGFloat)width;
++ (NSAttributedString*)attributedStringForKey:(id)key;
+
+@end
+
+
+@interface MGCStandardEventViewTests : XCTestCase
+
+@end
+
+
+@implementation MGCStandardEventViewTests
+
+- (MGCStandardEventView*)eventView
+{
+    MGCStandardEventView *view = [[MGCStandardEventView alloc]initWithFrame:CGRectMake(0, 0, 200, 60)];
+    view.title = @"Title";
+    view.subtitle = @"Subtitle";
+    view.detail = @"Detail";
+    view.style = MGCStandardEventViewStylePlain|MGCStandardEventViewStyleSubtitle|MGCStandardEventViewStyleDetail;
+    return view;
+}
+
+- (void)testTextLayoutKeyTakesViewContent
+{
+    MGCStandardEventView *view = [self eventView];
+
+    NSAttributedString *string = [MGCStandardEventView attributedStringForKey:[view textLayoutKeyForWidth:200]];
+    XCTAssertEqualObjects(string.string, @"Title\nSubtitle\tDetail");
+
+    UIFont *font = [string attribute:NSFontAttributeName atIndex:string.length - 1 effectiveRange:NULL];
+    XCTAssertEqual(font.pointSize, view.font.pointSize - 2);
+}
+
+- (void)testTextLayoutKeysDifferWithContent
+{
+    MGCStandardEventView *view = [self eventView];
+    id key1 = [view textLayoutKeyForWidth:200];
+
+    view.title = @"Other title";
+    id key2 = [view textLayoutKeyForWidth:200];
+
+    XCTAssertNotEqualObjects(key1, key2);
+    XCTAssertEqualObjects(key2, [view textLayoutKeyForWidth:200]);
+}
+
+- (void)testDrawing
+{
+    MGCStandardEventView *view = [self eventView];
+
+    UIGraphicsBeginImageContextWithOptions(view.bounds.size, NO, 1);
+    XCTAssertNoThrow([view drawRect:view.bounds]);
+    UIGraphicsEndImageContext();
+}
+
+@end
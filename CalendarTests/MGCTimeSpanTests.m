@@ -0,0 +1,63 @@
+//
+//  MGCTimeSpanTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCDateRange.h"
+
+
+@interface MGCTimeSpanTests : XCTestCase
+
+@end
+
+
+@implementation MGCTimeSpanTests
+
+// random span starting on a quarter hour, with at most 4 hours length, possibly empty
+- (MGCTimeSpan)randomSpan
+{
+    CFAbsoluteTime start = 500000000. + arc4random_uniform(48) * 900.;
+    return MGCTimeSpanMake(start, start + arc4random_uniform(17) * 900.);
+}
+
+- (void)assertSpan:(MGCTimeSpan)span equalToRange:(MGCDateRange*)range
+{
+    XCTAssertTrue(MGCTimeSpanEqualToTimeSpan(span, range.timeSpan), @"[%f - %f[ != %@", span.start, span.end, range);
+    XCTAssertEqual(MGCTimeSpanIsEmpty(span), range.isEmpty);
+}
+
+- (void)testBridgeIsLossless
+{
+    MGCTimeSpan span = MGCTimeSpanMake(489196800.123456, 489200400.654321);
+    MGCDateRange *range = [MGCDateRange dateRangeWithTimeSpan:span];
+    
+    XCTAssertTrue(MGCTimeSpanEqualToTimeSpan(range.timeSpan, span));
+    XCTAssertEqualObjects([MGCDateRange dateRangeWithTimeSpan:range.timeSpan], range);
+}
+
+- (void)testOperationsMatchDateRange
+{
+    for (NSUInteger run = 0; run < 1000; run++) {
+        MGCTimeSpan span1 = [self randomSpan], span2 = [self randomSpan];
+        MGCDateRange *range1 = [MGCDateRange dateRangeWithTimeSpan:span1];
+        MGCDateRange *range2 = [MGCDateRange dateRangeWithTimeSpan:span2];
+        
+        XCTAssertEqual(MGCTimeSpanIntersectsTimeSpan(span1, span2), [range1 intersectsDateRange:range2]);
+        
+        CFAbsoluteTime time = span2.start;
+        XCTAssertEqual(MGCTimeSpanContainsTime(span1, time), [range1 containsDate:[NSDate dateWithTimeIntervalSinceReferenceDate:time]]);
+        
+        MGCDateRange *intersection = [range1 copy];
+        [intersection intersectDateRange:range2];
+        [self assertSpan:MGCTimeSpanIntersection(span1, span2) equalToRange:intersection];
+        
+        MGCDateRange *unionRange = [range1 copy];
+        [unionRange unionDateRange:range2];
+        [self assertSpan:MGCTimeSpanUnion(span1, span2) equalToRange:unionRange];
+    }
+}
+
+@end
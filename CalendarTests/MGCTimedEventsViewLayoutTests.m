@@ -0,0 +1,402 @@
+//
+//  MGCTimedEventsViewLayoutTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2015 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCTimedEventsViewLayout.h"
+#import "MGCEventCellLayoutAttributes.h"
+#import "MGCAlignedGeometry.h"
+#import "MGCEventsLayoutCore.h"
+
+
+// data source and delegate of a collection view showing one day per section, starting at firstDay
+@interface MGCTestTimedEventsDataSource : NSObject<UICollectionViewDataSource, MGCTimedEventsViewLayoutDelegate>
+
+@property (nonatomic) NSInteger firstDay;
+@property (nonatomic) NSInteger numberOfDays;
+@property (nonatomic) NSMutableDictionary *rectsByDay;  // { day : array of event rects }
+@property (nonatomic) NSUInteger rectRequests;          // number of calls to collectionView:layout:rectForEventAtIndexPath:
+
+@end
+
+
+@implementation MGCTestTimedEventsDataSource
+
+- (NSArray*)rectsForSection:(NSInteger)section
+{
+    return [self.rectsByDay objectForKey:@(self.firstDay + section)] ?: @[];
+}
+
+- (NSInteger)numberOfSectionsInCollectionView:(UICollectionView*)collectionView
+{
+    return self.numberOfDays;
+}
+
+- (NSInteger)collectionView:(UICollectionView*)collectionView numberOfItemsInSection:(NSInteger)section
+{
+    return [self rectsForSection:section].count;
+}
+
+- (UICollectionViewCell*)collectionView:(UICollectionView*)collectionView cellForItemAtIndexPath:(NSIndexPath*)indexPath
+{
+    return [UICollectionViewCell new];
+}
+
+- (CGRect)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout rectForEventAtIndexPath:(NSIndexPath*)indexPath
+{
+    self.rectRequests++;
+    return [[[self rectsForSection:indexPath.section] objectAtIndex:indexPath.item] CGRectValue];
+}
+
+- (NSArray*)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout dimmingRectsForSection:(NSUInteger)section
+{
+    return @[];
+}
+
+- (NSDate*)collectionView:(UICollectionView*)collectionView layout:(MGCTimedEventsViewLayout*)layout dateForSection:(NSUInteger)section
+{
+    return [NSDate dateWithTimeIntervalSinceReferenceDate:(self.firstDay + section) * 24 * 3600];
+}
+
+@end
+
+
+@interface MGCTimedEventsViewLayoutTests : XCTestCase
+
+@end
+
+
+@implementation MGCTimedEventsViewLayoutTests
+
+// reference implementation of the classic covering, as it was before the sweep-line version
+- (NSArray*)classicLayoutForCells:(NSArray*)attributes inSection:(NSUInteger)section columnWidth:(CGFloat)columnWidth minimumVisibleHeight:(CGFloat)minimumVisibleHeight
+{
+    const CGFloat kOverlapOffset = 4.;
+
+    NSArray *adjustedAttributes = [attributes sortedArrayUsingComparator:^NSComparisonResult(MGCEventCellLayoutAttributes *att1, MGCEventCellLayoutAttributes *att2) {
+        if (att1.frame.origin.y > att2.frame.origin.y) {
+            return NSOrderedDescending;
+        }
+        else if (att1.frame.origin.y < att2.frame.origin.y) {
+            return NSOrderedAscending;
+        }
+        return NSOrderedSame;
+    }];
+
+    for (NSUInteger i = 0; i < adjustedAttributes.count; i++) {
+        MGCEventCellLayoutAttributes *attribs1 = [adjustedAttributes objectAtIndex:i];
+
+        NSMutableArray *layoutGroup = [NSMutableArray array];
+        [layoutGroup addObject:attribs1];
+
+        NSMutableArray *coveredLayoutAttributes = [NSMutableArray array];
+
+        for (NSInteger j = i - 1; j >= 0; j--) {
+            MGCEventCellLayoutAttributes *attribs2 = [adjustedAttributes objectAtIndex:j];
+            if (CGRectIntersectsRect(attribs1.frame, attribs2.frame)) {
+                CGFloat visibleHeight = fabs(attribs1.frame.origin.y - attribs2.frame.origin.y);
+
+                if (visibleHeight > minimumVisibleHeight) {
+                    [coveredLayoutAttributes addObject:attribs2];
+                    attribs2.visibleHeight = visibleHeight;
+                    attribs1.zIndex = attribs2.zIndex + 1;
+                }
+                else {
+                    [layoutGroup addObject:attribs2];
+                }
+            }
+        }
+
+        CGFloat groupOffset = 0;
+        if (coveredLayoutAttributes.count > 0) {
+            BOOL lookForEmptySlot = YES;
+            NSUInteger slotNumber = 0;
+            CGFloat offset = 0;
+
+            while (lookForEmptySlot) {
+                offset = slotNumber * kOverlapOffset;
+                lookForEmptySlot = NO;
+
+                for (MGCEventCellLayoutAttributes *attribs in coveredLayoutAttributes) {
+                    if (attribs.frame.origin.x - section * columnWidth == offset) {
+                        lookForEmptySlot = YES;
+                        break;
+                    }
+                }
+                slotNumber += 1;
+            }
+            groupOffset += offset;
+        }
+
+        CGFloat totalWidth = (columnWidth - 1.) - groupOffset;
+        CGFloat colWidth = totalWidth / layoutGroup.count;
+
+        CGFloat x = section * columnWidth + groupOffset;
+
+        for (MGCEventCellLayoutAttributes* attribs in [layoutGroup reverseObjectEnumerator]) {
+            attribs.frame = MGCAlignedRectMake(x, attribs.frame.origin.y, colWidth, attribs.frame.size.height);
+            x += colWidth;
+        }
+    }
+
+    return adjustedAttributes;
+}
+
+// reference implementation of the complex covering, as it was before the sweep-line version
+- (NSArray*)complexLayoutForCells:(NSArray*)attributes columnWidth:(CGFloat)columnWidth
+{
+    NSArray *adjustedAttributes = [attributes sortedArrayUsingComparator:^NSComparisonResult(MGCEventCellLayoutAttributes *att1, MGCEventCellLayoutAttributes *att2) {
+        if (att1.frame.origin.y > att2.frame.origin.y) {
+            return NSOrderedDescending;
+        }
+        else if (att1.frame.origin.y < att2.frame.origin.y) {
+            return NSOrderedAscending;
+        }
+        return NSOrderedSame;
+    }];
+
+    NSMutableArray *uninspectedAttributes = [adjustedAttributes mutableCopy];
+    NSMutableArray *clusters = [NSMutableArray new];
+
+    while (uninspectedAttributes.count > 0) {
+        MGCEventCellLayoutAttributes *attrib = [uninspectedAttributes firstObject];
+        NSMutableArray *destinationCluster;
+
+        for (NSMutableArray *cluster in clusters) {
+            for (MGCEventCellLayoutAttributes *clusteredAttrib in cluster) {
+                if (CGRectIntersectsRect(clusteredAttrib.frame, attrib.frame)) {
+                    destinationCluster = cluster;
+                    break;
+                }
+            }
+        }
+
+        if (destinationCluster) {
+            [destinationCluster addObject:attrib];
+        } else {
+            [clusters addObject:[NSMutableArray arrayWithObject:attrib]];
+        }
+        [uninspectedAttributes removeObject:attrib];
+    }
+
+    NSMutableArray *result = [NSMutableArray new];
+    for (NSMutableArray *cluster in clusters) {
+        NSMutableArray *columns = [NSMutableArray arrayWithObject:[NSMutableArray new]];
+        for (MGCEventCellLayoutAttributes *attribs in cluster) {
+            BOOL isPlaced = NO;
+            for (NSMutableArray *column in columns) {
+                if (column.count == 0) {
+                    [column addObject:attribs];
+                    isPlaced = YES;
+                } else if (!CGRectIntersectsRect(attribs.frame, ((MGCEventCellLayoutAttributes*)[column lastObject]).frame)) {
+                    [column addObject:attribs];
+                    isPlaced = YES;
+                    break;
+                }
+            }
+            if (!isPlaced) {
+                [columns addObject:[NSMutableArray arrayWithObject:attribs]];
+            }
+        }
+
+        CGFloat totalWidth = columnWidth - 2.f;
+        CGFloat colWidth = totalWidth / columns.count;
+        NSInteger j = 0;
+        for (NSMutableArray *column in columns) {
+            for (MGCEventCellLayoutAttributes *attribs in column) {
+                attribs.frame = MGCAlignedRectMake(attribs.frame.origin.x + j * colWidth, attribs.frame.origin.y, colWidth, attribs.frame.size.height);
+            }
+            j++;
+        }
+        [result addObjectsFromArray:cluster];
+    }
+    return result;
+}
+
+// random event rects, as returned by collectionView:layout:rectForEventAtIndexPath:
+- (NSArray*)randomRectsWithCount:(NSUInteger)count
+{
+    NSMutableArray *rects = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger item = 0; item < count; item++) {
+        // cluster start times so that a lot of events overlap or start at the same position
+        CGFloat y = arc4random_uniform(48) * 25. + arc4random_uniform(3) * 7.5;
+        CGFloat height = arc4random_uniform(200);
+        [rects addObject:[NSValue valueWithCGRect:CGRectMake(0, y, 0, height)]];
+    }
+    return rects;
+}
+
+// cells built the same way as in layoutAttributesForEventCellsInSection: before the layout core
+- (NSArray*)cellsForRects:(NSArray*)rects section:(NSUInteger)section columnWidth:(CGFloat)columnWidth minimumVisibleHeight:(CGFloat)minimumVisibleHeight
+{
+    NSMutableArray *cells = [NSMutableArray arrayWithCapacity:rects.count];
+    for (NSUInteger item = 0; item < rects.count; item++) {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
+        MGCEventCellLayoutAttributes *attribs = [MGCEventCellLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
+
+        CGRect rect = [rects[item] CGRectValue];
+        rect.origin.x = columnWidth * section;
+        rect.size.width = columnWidth;
+        rect.size.height = fmax(minimumVisibleHeight, rect.size.height);
+
+        attribs.frame = MGCAlignedRect(CGRectInset(rect , 0, 1));
+        attribs.visibleHeight = attribs.frame.size.height;
+        attribs.zIndex = 1;
+        [cells addObject:attribs];
+    }
+    return cells;
+}
+
+- (void)assertLayoutOfRects:(NSArray*)rects withParams:(MGCTimedEventsLayoutParams)params equalToCells:(NSArray*)expected
+{
+    MGCEventSpan *spans = malloc(rects.count * sizeof(MGCEventSpan));
+    MGCEventCellLayout *cells = malloc(rects.count * sizeof(MGCEventCellLayout));
+
+    for (NSUInteger item = 0; item < rects.count; item++) {
+        CGRect rect = [rects[item] CGRectValue];
+        spans[item] = (MGCEventSpan){ rect.origin.y, rect.origin.y + rect.size.height, item };
+    }
+
+    MGCLayoutTimedEvents(spans, rects.count, &params, cells);
+
+    XCTAssertEqual(rects.count, expected.count);
+    for (NSUInteger i = 0; i < MIN(rects.count, expected.count); i++) {
+        MGCEventCellLayoutAttributes *expectedAttribs = expected[i];
+        CGRect frame = CGRectMake(cells[i].frame.x, cells[i].frame.y, cells[i].frame.width, cells[i].frame.height);
+
+        XCTAssertEqual(cells[i].index, expectedAttribs.indexPath.item);
+        XCTAssertTrue(CGRectEqualToRect(frame, expectedAttribs.frame), @"%@ != %@", NSStringFromCGRect(frame), NSStringFromCGRect(expectedAttribs.frame));
+        XCTAssertEqual(cells[i].visibleHeight, expectedAttribs.visibleHeight);
+        XCTAssertEqual(cells[i].zIndex, expectedAttribs.zIndex);
+    }
+
+    free(spans);
+    free(cells);
+}
+
+- (void)testClassicCoveringMatchesReference
+{
+    for (NSUInteger run = 0; run < 200; run++) {
+        NSUInteger section = arc4random_uniform(7);
+        CGFloat columnWidth = 40. + arc4random_uniform(3000) / 10.;
+        NSUInteger count = arc4random_uniform(run % 10 == 0 ? 400 : 40);
+
+        MGCTimedEventsLayoutParams params = { section * columnWidth, columnWidth, 15., [UIScreen mainScreen].scale, MGCEventCoveringClassic };
+
+        NSArray *rects = [self randomRectsWithCount:count];
+        NSArray *cells = [self cellsForRects:rects section:section columnWidth:columnWidth minimumVisibleHeight:params.minimumVisibleHeight];
+        NSArray *expected = [self classicLayoutForCells:cells inSection:section columnWidth:columnWidth minimumVisibleHeight:params.minimumVisibleHeight];
+
+        [self assertLayoutOfRects:rects withParams:params equalToCells:expected];
+    }
+}
+
+- (void)testComplexCoveringMatchesReference
+{
+    for (NSUInteger run = 0; run < 200; run++) {
+        NSUInteger section = arc4random_uniform(7);
+        CGFloat columnWidth = 40. + arc4random_uniform(3000) / 10.;
+        NSUInteger count = arc4random_uniform(run % 10 == 0 ? 400 : 40);
+
+        MGCTimedEventsLayoutParams params = { section * columnWidth, columnWidth, 15., [UIScreen mainScreen].scale, MGCEventCoveringComplex };
+
+        NSArray *rects = [self randomRectsWithCount:count];
+        NSArray *cells = [self cellsForRects:rects section:section columnWidth:columnWidth minimumVisibleHeight:params.minimumVisibleHeight];
+        NSArray *expected = [self complexLayoutForCells:cells columnWidth:columnWidth];
+
+        [self assertLayoutOfRects:rects withParams:params equalToCells:expected];
+    }
+}
+
+- (MGCTimedEventsViewLayout*)layoutWithDataSource:(MGCTestTimedEventsDataSource*)dataSource covering:(TimedEventCoveringType)covering
+{
+    MGCTimedEventsViewLayout *layout = [MGCTimedEventsViewLayout new];
+    layout.delegate = dataSource;
+    layout.coveringType = covering;
+    layout.dayColumnSize = CGSizeMake(100.3, 1200.);    // fractional width, so that cells are not aligned the same way in all columns
+    
+    UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:CGRectMake(0, 0, 700, 1200) collectionViewLayout:layout];
+    collectionView.dataSource = dataSource;
+    [layout prepareLayout];
+    return layout;
+}
+
+// days which are still loaded after recentering keep their layout, but it must be the same as a new layout of their new section
+- (void)testLayoutOfRecenteredDaysMatchesNewLayout
+{
+    for (NSNumber *covering in @[ @(TimedEventCoveringTypeClassic), @(TimedEventCoveringTypeComplex) ]) {
+        MGCTestTimedEventsDataSource *dataSource = [MGCTestTimedEventsDataSource new];
+        dataSource.numberOfDays = 7;
+        dataSource.rectsByDay = [NSMutableDictionary dictionary];
+        for (NSInteger day = 0; day < 10; day++) {
+            [dataSource.rectsByDay setObject:[self randomRectsWithCount:30] forKey:@(day)];
+        }
+        
+        MGCTimedEventsViewLayout *layout = [self layoutWithDataSource:dataSource covering:covering.unsignedIntegerValue];
+        for (NSUInteger section = 0; section < dataSource.numberOfDays; section++) {
+            for (NSUInteger item = 0; item < [dataSource rectsForSection:section].count; item++) {
+                [layout layoutAttributesForItemAtIndexPath:[NSIndexPath indexPathForItem:item inSection:section]];
+            }
+        }
+        
+        // recenter: days move 3 sections to the left (same sequence as -[MGCDayPlannerView recenterIfNeeded])
+        dataSource.firstDay = 3;
+        layout.ignoreNextInvalidation = YES;
+        [layout.collectionView reloadData];
+        MGCTimedEventsViewLayoutInvalidationContext *context = [MGCTimedEventsViewLayoutInvalidationContext new];
+        context.invalidateSectionDates = YES;
+        [layout invalidateLayoutWithContext:context];
+        [layout prepareLayout];
+        
+        MGCTimedEventsViewLayout *newLayout = [self layoutWithDataSource:dataSource covering:covering.unsignedIntegerValue];
+        
+        for (NSUInteger section = 0; section < dataSource.numberOfDays; section++) {
+            for (NSUInteger item = 0; item < [dataSource rectsForSection:section].count; item++) {
+                NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
+                MGCEventCellLayoutAttributes *attribs = [layout layoutAttributesForItemAtIndexPath:indexPath];
+                MGCEventCellLayoutAttributes *expected = [newLayout layoutAttributesForItemAtIndexPath:indexPath];
+                
+                XCTAssertEqualObjects(attribs.indexPath, expected.indexPath);
+                XCTAssertTrue(CGRectEqualToRect(attribs.frame, expected.frame), @"%@ != %@", NSStringFromCGRect(attribs.frame), NSStringFromCGRect(expected.frame));
+                XCTAssertEqual(attribs.visibleHeight, expected.visibleHeight);
+                XCTAssertEqual(attribs.zIndex, expected.zIndex);
+            }
+        }
+    }
+}
+
+// spans are only asked again to the delegate when the events may have changed, or when the columns height changed
+- (void)testEventSpansAreNotFetchedAgainOnPlainInvalidation
+{
+    MGCTestTimedEventsDataSource *dataSource = [MGCTestTimedEventsDataSource new];
+    dataSource.numberOfDays = 1;
+    dataSource.rectsByDay = [NSMutableDictionary dictionaryWithObject:[self randomRectsWithCount:20] forKey:@0];
+    
+    MGCTimedEventsViewLayout *layout = [self layoutWithDataSource:dataSource covering:TimedEventCoveringTypeClassic];
+    NSIndexPath *indexPath = [NSIndexPath indexPathForItem:0 inSection:0];
+    MGCEventCellLayoutAttributes *attribs = [layout layoutAttributesForItemAtIndexPath:indexPath];
+    XCTAssertEqual(dataSource.rectRequests, 20);
+    
+    [layout invalidateLayout];
+    [layout prepareLayout];
+    XCTAssertTrue(CGRectEqualToRect([layout layoutAttributesForItemAtIndexPath:indexPath].frame, attribs.frame));
+    XCTAssertEqual(dataSource.rectRequests, 20);
+    
+    MGCTimedEventsViewLayoutInvalidationContext *context = [MGCTimedEventsViewLayoutInvalidationContext new];
+    context.invalidatedSections = [NSMutableIndexSet indexSetWithIndex:0];
+    [layout invalidateLayoutWithContext:context];
+    [layout prepareLayout];
+    [layout layoutAttributesForItemAtIndexPath:indexPath];
+    XCTAssertEqual(dataSource.rectRequests, 40);
+    
+    layout.dayColumnSize = CGSizeMake(layout.dayColumnSize.width, 1000.);
+    [layout invalidateLayout];
+    [layout prepareLayout];
+    [layout layoutAttributesForItemAtIndexPath:indexPath];
+    XCTAssertEqual(dataSource.rectRequests, 60);
+}
+
+@end
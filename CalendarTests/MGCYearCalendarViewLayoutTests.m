@@ -0,0 +1,139 @@
+//
+//  MGCYearCalendarViewLayoutTests.m
+//  CalendarTests
+//
+//  Copyright (c) 2014-2016 Julien Martin. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "MGCYearCalendarViewLayout.h"
+
+
+// data source with a given number of months per year
+@interface MGCYearsDataSource : NSObject<UICollectionViewDataSource>
+
+@property (nonatomic) NSArray *numberOfMonths;
+
+@end
+
+
+@implementation MGCYearsDataSource
+
+- (NSInteger)numberOfSectionsInCollectionView:(UICollectionView*)collectionView
+{
+    return self.numberOfMonths.count;
+}
+
+- (NSInteger)collectionView:(UICollectionView*)collectionView numberOfItemsInSection:(NSInteger)section
+{
+    return [self.numberOfMonths[section] integerValue];
+}
+
+- (UICollectionViewCell*)collectionView:(UICollectionView*)collectionView cellForItemAtIndexPath:(NSIndexPath*)indexPath
+{
+    return nil;
+}
+
+@end
+
+
+@interface MGCYearCalendarViewLayoutTests : XCTestCase
+
+@property (nonatomic) MGCYearsDataSource *dataSource;
+@property (nonatomic) MGCYearCalendarViewLayout *layout;
+@property (nonatomic) UICollectionView *collectionView;
+
+@end
+
+
+@implementation MGCYearCalendarViewLayoutTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.dataSource = [MGCYearsDataSource new];
+    self.dataSource.numberOfMonths = @[ @12, @13, @12, @12, @13 ];
+
+    self.layout = [MGCYearCalendarViewLayout new];
+    self.layout.itemSize = CGSizeMake(100, 120);
+    self.layout.minimumInteritemSpacing = 20;
+    self.layout.minimumLineSpacing = 25;
+    self.layout.sectionInset = UIEdgeInsetsMake(10, 5, 50, 5);
+    self.layout.headerHeight = 60;
+
+    self.collectionView = [[UICollectionView alloc]initWithFrame:CGRectMake(0, 0, 480, 600) collectionViewLayout:self.layout];
+    self.collectionView.dataSource = self.dataSource;
+}
+
+- (void)testMonthsAreLaidOutInJustifiedRows
+{
+    // (470 + 20) / 120 -> 4 columns, with (470 - 400) / 3 points between them
+    XCTAssertEqual(self.layout.numberOfColumns, 4);
+
+    CGRect frame = [self.layout layoutAttributesForItemAtIndexPath:[NSIndexPath indexPathForItem:5 inSection:0]].frame;
+    XCTAssertEqualWithAccuracy(frame.origin.x, 5 + 100 + 70. / 3., 0.001);
+    XCTAssertEqualWithAccuracy(frame.origin.y, 60 + 10 + 120 + 25, 0.001);
+
+    // 13 months need 4 rows
+    CGRect year1 = [self.layout rectForYearAtIndex:1];
+    XCTAssertEqualWithAccuracy(year1.origin.y, 60 + 10 + 3 * 120 + 2 * 25 + 50, 0.001);
+    XCTAssertEqualWithAccuracy(year1.size.height, 60 + 10 + 4 * 120 + 3 * 25 + 50, 0.001);
+}
+
+- (void)testYearRectsMatchElements
+{
+    for (NSUInteger year = 0; year < self.dataSource.numberOfMonths.count; year++) {
+        NSIndexPath *first = [NSIndexPath indexPathForItem:0 inSection:year];
+        NSIndexPath *last = [NSIndexPath indexPathForItem:[self.dataSource.numberOfMonths[year] integerValue] - 1 inSection:year];
+
+        CGRect rect = [self.layout rectForYearAtIndex:year];
+        CGRect header = [self.layout layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionHeader atIndexPath:first].frame;
+        CGRect lastMonth = [self.layout layoutAttributesForItemAtIndexPath:last].frame;
+
+        XCTAssertEqual(CGRectGetMinY(rect), CGRectGetMinY(header));
+        XCTAssertEqualWithAccuracy(CGRectGetMaxY(rect), CGRectGetMaxY(lastMonth) + self.layout.sectionInset.bottom, 0.001);
+    }
+
+    CGRect lastYear = [self.layout rectForYearAtIndex:self.dataSource.numberOfMonths.count - 1];
+    XCTAssertEqualWithAccuracy(self.layout.collectionViewContentSize.height, CGRectGetMaxY(lastYear), 0.001);
+}
+
+- (void)testElementsInRectMatchAllElements
+{
+    NSMutableArray *allAttribs = [NSMutableArray array];
+    for (NSUInteger year = 0; year < self.dataSource.numberOfMonths.count; year++) {
+        [allAttribs addObject:[self.layout layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionHeader atIndexPath:[NSIndexPath indexPathForItem:0 inSection:year]]];
+        for (NSInteger month = 0; month < [self.dataSource.numberOfMonths[year] integerValue]; month++) {
+            [allAttribs addObject:[self.layout layoutAttributesForItemAtIndexPath:[NSIndexPath indexPathForItem:month inSection:year]]];
+        }
+    }
+
+    CGFloat contentHeight = self.layout.collectionViewContentSize.height;
+    for (NSUInteger run = 0; run < 200; run++) {
+        CGRect rect = CGRectMake(0, arc4random_uniform(contentHeight) - 100., 480, arc4random_uniform(800));
+
+        NSMutableSet *expected = [NSMutableSet set];
+        for (UICollectionViewLayoutAttributes *attribs in allAttribs) {
+            if (CGRectIntersectsRect(rect, attribs.frame)) {
+                [expected addObject:attribs];
+            }
+        }
+
+        NSSet *result = [NSSet setWithArray:[self.layout layoutAttributesForElementsInRect:rect]];
+        XCTAssertEqualObjects(result, expected, @"rect %@", NSStringFromCGRect(rect));
+    }
+}
+
+- (void)testOffsetsAreComputedAgainAfterInvalidation
+{
+    CGFloat height = [self.layout rectForYearAtIndex:0].size.height;
+
+    self.dataSource.numberOfMonths = @[ @13, @12 ];
+    XCTAssertEqual([self.layout rectForYearAtIndex:0].size.height, height);
+
+    [self.layout invalidateLayout];
+    XCTAssertGreaterThan([self.layout rectForYearAtIndex:0].size.height, height);
+}
+
+@end